@@ -26,7 +26,7 @@ extern int yylineno;
 int yyparse(CodeGen *codegen);
 void yyrestart(FILE *file);
 
-QHash<QByteArray, QList<QByteArray> > CodeGen::s_wrapperDefinitions;
+QHash<QByteArray, QList<CodeGen::QByteArrayPair> > CodeGen::s_wrapperDefinitions;
 
 int main(int argc, char *argv[])
 {
@@ -208,23 +208,22 @@ void CodeGen::printWrapperDefinition(QTextStream& outStream, const QByteArrayHas
     outStream << "  }" << endl;
     outStream << "} //namespace " << def["namespace"] << endl;
 
-    s_wrapperDefinitions[def["namespace"]].append(def["class"]);
+    s_wrapperDefinitions[def["namespace"]].append(qMakePair(def["class"], gTypeName(def)));
 }
 
 void CodeGen::printGlobalWrapperDefinitions(QTextStream & outStream)
 {
-    QHashIterator<QByteArray, QList<QByteArray> > it(s_wrapperDefinitions);
+    QHashIterator<QByteArray, QList<QByteArrayPair> > it(s_wrapperDefinitions);
     while (it.hasNext()) {
         it.next();
         outStream << "namespace " << it.key() << " {" << endl;
         outStream << "namespace Private {" << endl;
         outStream << "  void registerWrapperConstructors()" << endl;
         outStream << "  {" << endl;
-        outStream << "    QGlib::Quark q = g_quark_from_static_string(\"QGlib__wrapper_constructor\");" << endl;
-
-        Q_FOREACH(const QByteArray & classId, it.value()) {
-            outStream << "    QGlib::GetType<" << classId << ">()"
-                      << ".setQuarkData(q, reinterpret_cast<void*>(&" << classId << "_new));" << endl;
+        Q_FOREACH(const QByteArrayPair & wrapper, it.value()) {
+            outStream << "    QGlib::Private::registerWrapperConstructor(\"" << wrapper.second << "\", "
+                      << "&QGlib::GetType<" << wrapper.first << ">, "
+                      << "&" << wrapper.first << "_new);" << endl;
         }
         outStream << "  }" << endl;
         outStream << "} //namespace Private" << endl;
@@ -254,6 +253,16 @@ QByteArray CodeGen::namespaceToGstStyle(const QByteArray & ns)
     return ns == "QGst" ? "GST" : "G";
 }
 
+//the GType name is assumed to be the C name of the class, unless
+//the wrapper definition specifies a different one with GTypeName=
+QByteArray CodeGen::gTypeName(const QByteArrayHash & def)
+{
+    if (def.contains("GTypeName")) {
+        return def["GTypeName"];
+    }
+    return (def["namespace"] == "QGst" ? "Gst" : "G") + def["class"];
+}
+
 void CodeGen::addEnum(const QList<QByteArray> & values, const QByteArrayHash & options)
 {
     Enum e;
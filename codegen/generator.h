@@ -62,6 +62,7 @@ private:
 
     static QByteArray toGstStyle(const QByteArray & str);
     static QByteArray namespaceToGstStyle(const QByteArray & ns);
+    static QByteArray gTypeName(const QByteArrayHash & def);
 
     const QString m_fileName;
     QByteArray m_currentNamespace;
@@ -72,7 +73,8 @@ private:
     //< <namespace, class>, <prefix + options> >
     QHash<QByteArrayPair, QList<QByteArrayHash> > m_wrapperSubclasses;
 
-    static QHash<QByteArray, QList<QByteArray> > s_wrapperDefinitions; //<namespace, classes>
+    //< namespace, <class, GType name> >
+    static QHash<QByteArray, QList<QByteArrayPair> > s_wrapperDefinitions;
 };
 
 #endif // GENERATOR_H
@@ -17,7 +17,9 @@
 
 #include "basedelegate.h"
 
+#include <gst/base/gstbasesink.h>
 #include <QCoreApplication>
+#include <qmath.h>
 
 BaseDelegate::BaseDelegate(GstElement * sink, QObject * parent)
     : QObject(parent)
@@ -29,11 +31,33 @@ BaseDelegate::BaseDelegate(GstElement * sink, QObject * parent)
     , m_pixelAspectRatio(1, 1)
     , m_forceAspectRatioDirty(true)
     , m_forceAspectRatio(false)
+    , m_negotiateRenderSize(true)
     , m_formatDirty(true)
     , m_isActive(false)
     , m_buffer(NULL)
+    , m_bufferPainted(false)
+    , m_bufferPostTime(0)
+    , m_statsInterval(0)
+    , m_lastStatsTime(0)
+    , m_lastPaintTime(GST_CLOCK_TIME_NONE)
+    , m_lastPaintRunningTime(GST_CLOCK_TIME_NONE)
+    , m_proportion(1.0)
+    , m_qosEnabled(gst_base_sink_is_qos_enabled(GST_BASE_SINK(sink)))
     , m_sink(sink)
 {
+    //show_frame() returns before the frame is painted, so GstBaseSink's QoS
+    //would always say that frames are on time; framePainted() sends it instead
+    gst_base_sink_set_qos_enabled(GST_BASE_SINK(sink), FALSE);
+
+    m_stats.framesReceived = 0;
+    m_stats.framesPainted = 0;
+    m_stats.framesSuperseded = 0;
+    m_stats.latencyTotal = 0;
+    m_stats.latencyMax = 0;
+    m_stats.uploadCount = 0;
+    m_stats.uploadTotal = 0;
+    m_stats.uploadMax = 0;
+    m_stats.painter = "none";
 }
 
 BaseDelegate::~BaseDelegate()
@@ -147,6 +171,286 @@ void BaseDelegate::setForceAspectRatio(bool force)
 
 //-------------------------------------
 
+bool BaseDelegate::negotiateRenderSize() const
+{
+    QReadLocker l(&m_renderSizeLock);
+    return m_negotiateRenderSize;
+}
+
+void BaseDelegate::setNegotiateRenderSize(bool negotiate)
+{
+    QWriteLocker l(&m_renderSizeLock);
+    if (m_negotiateRenderSize == negotiate) {
+        return;
+    }
+
+    m_negotiateRenderSize = negotiate;
+    if (!negotiate && m_preferredSize.isValid()) {
+        m_preferredSize = QSize();
+        l.unlock();
+        reconfigureUpstream();
+    }
+}
+
+QSize BaseDelegate::preferredSize() const
+{
+    QReadLocker l(&m_renderSizeLock);
+    return m_preferredSize;
+}
+
+GstCaps *BaseDelegate::preferRenderSize(GstCaps *caps) const
+{
+    QSize size = preferredSize();
+    if (!size.isValid() || gst_caps_is_empty(caps) || gst_caps_is_any(caps)) {
+        return caps;
+    }
+
+    //ranges instead of fixed values, so that upstream never upscales
+    //and is still free to keep the display aspect ratio
+    GstCaps *preferred = gst_caps_copy(caps);
+    gst_caps_set_simple(preferred,
+                        "width", GST_TYPE_INT_RANGE, 1, size.width(),
+                        "height", GST_TYPE_INT_RANGE, 1, size.height(),
+                        NULL);
+    gst_caps_append(preferred, caps);
+    return preferred;
+}
+
+void BaseDelegate::setRenderSize(const QSizeF & size)
+{
+    //the thresholds below keep a window resize from renegotiating on every frame
+    static const int MinimumSize = 16;
+    static const qreal Headroom = 1.25;
+    static const qreal ShrinkThreshold = 2.0 / 3.0;
+
+    QSize renderSize = size.toSize();
+    if (renderSize.width() < MinimumSize || renderSize.height() < MinimumSize) {
+        //hidden or collapsed; not worth a renegotiation
+        return;
+    }
+
+    QWriteLocker l(&m_renderSizeLock);
+    if (!m_negotiateRenderSize) {
+        return;
+    }
+
+    bool grown = !m_preferredSize.isValid()
+            || renderSize.width() > m_preferredSize.width()
+            || renderSize.height() > m_preferredSize.height();
+    bool shrunk = m_preferredSize.isValid()
+            && renderSize.width() < m_preferredSize.width() * ShrinkThreshold
+            && renderSize.height() < m_preferredSize.height() * ShrinkThreshold;
+
+    if (grown || shrunk) {
+        m_preferredSize = QSize(qCeil(renderSize.width() * Headroom),
+                                qCeil(renderSize.height() * Headroom));
+        GST_DEBUG_OBJECT(m_sink, "Render size changed to " QSIZE_FORMAT
+                         ", preferring frames up to " QSIZE_FORMAT,
+                         QSIZE_FORMAT_ARGS(renderSize), QSIZE_FORMAT_ARGS(m_preferredSize));
+        l.unlock();
+        reconfigureUpstream();
+    }
+}
+
+void BaseDelegate::reconfigureUpstream()
+{
+    GstPad *pad = gst_element_get_static_pad(m_sink, "sink");
+    gst_pad_push_event(pad, gst_event_new_reconfigure());
+    gst_object_unref(pad);
+}
+
+//-------------------------------------
+
+GstStructure *BaseDelegate::stats() const
+{
+    QMutexLocker l(&m_statsMutex);
+
+    guint64 painted = qMax(m_stats.framesPainted, G_GUINT64_CONSTANT(1));
+    guint64 uploads = qMax(m_stats.uploadCount, G_GUINT64_CONSTANT(1));
+    GstVideoFormat format = m_stats.format.videoFormat();
+
+    return gst_structure_new("qt-video-sink-stats",
+            "frames-received", G_TYPE_UINT64, m_stats.framesReceived,
+            "frames-painted", G_TYPE_UINT64, m_stats.framesPainted,
+            "frames-superseded", G_TYPE_UINT64, m_stats.framesSuperseded,
+            "average-latency", G_TYPE_UINT64,
+                guint64(m_stats.latencyTotal / painted * GST_USECOND),
+            "maximum-latency", G_TYPE_UINT64, guint64(m_stats.latencyMax * GST_USECOND),
+            "average-upload-time", G_TYPE_UINT64,
+                guint64(m_stats.uploadTotal / uploads * GST_USECOND),
+            "maximum-upload-time", G_TYPE_UINT64, guint64(m_stats.uploadMax * GST_USECOND),
+            "painter", G_TYPE_STRING, m_stats.painter,
+            "format", G_TYPE_STRING,
+                format != GST_VIDEO_FORMAT_UNKNOWN ? gst_video_format_to_string(format) : "none",
+            "width", G_TYPE_INT, m_stats.format.frameSize().width(),
+            "height", G_TYPE_INT, m_stats.format.frameSize().height(),
+            NULL);
+}
+
+uint BaseDelegate::statsInterval() const
+{
+    QMutexLocker l(&m_statsMutex);
+    return m_statsInterval;
+}
+
+void BaseDelegate::setStatsInterval(uint msecs)
+{
+    QMutexLocker l(&m_statsMutex);
+    m_statsInterval = msecs;
+}
+
+bool BaseDelegate::qosEnabled() const
+{
+    QReadLocker l(&m_qosLock);
+    return m_qosEnabled;
+}
+
+void BaseDelegate::setQosEnabled(bool enabled)
+{
+    QWriteLocker l(&m_qosLock);
+    m_qosEnabled = enabled;
+}
+
+void BaseDelegate::setPainterName(const char *name)
+{
+    QMutexLocker l(&m_statsMutex);
+    m_stats.painter = name;
+}
+
+void BaseDelegate::addUploadTime(gint64 usecs)
+{
+    QMutexLocker l(&m_statsMutex);
+    m_stats.uploadCount++;
+    m_stats.uploadTotal += usecs;
+    m_stats.uploadMax = qMax(m_stats.uploadMax, usecs);
+}
+
+void BaseDelegate::postStatsMessage()
+{
+    m_statsMutex.lock();
+    gint64 now = g_get_monotonic_time();
+    bool due = m_statsInterval > 0 && now - m_lastStatsTime >= gint64(m_statsInterval) * 1000;
+    if (due) {
+        m_lastStatsTime = now;
+    }
+    m_statsMutex.unlock();
+
+    if (due) {
+        gst_element_post_message(m_sink, gst_message_new_element(GST_OBJECT(m_sink), stats()));
+    }
+}
+
+//-------------------------------------
+
+bool BaseDelegate::bufferLateness(GstBuffer *buffer, GstClockTime *runningTime,
+                                  GstClockTime *now, GstClockTimeDiff *jitter) const
+{
+    GstBaseSink *sink = GST_BASE_SINK(m_sink);
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) {
+        return false;
+    }
+
+    GST_OBJECT_LOCK(sink);
+    *runningTime = gst_segment_to_running_time(&sink->segment, GST_FORMAT_TIME, pts);
+    GstClock *clock = GST_ELEMENT_CLOCK(sink) ?
+            GST_CLOCK(gst_object_ref(GST_ELEMENT_CLOCK(sink))) : NULL;
+    GstClockTime baseTime = GST_ELEMENT_CAST(sink)->base_time;
+    GST_OBJECT_UNLOCK(sink);
+
+    if (!clock) {
+        return false;
+    }
+    *now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    if (!GST_CLOCK_TIME_IS_VALID(*runningTime)) {
+        return false;
+    }
+
+    //this is when GstBaseSink waited for, before calling show_frame
+    GstClockTime deadline = baseTime + *runningTime
+            + gst_base_sink_get_latency(sink) + gst_base_sink_get_render_delay(sink);
+    *jitter = GST_CLOCK_DIFF(deadline, *now);
+    return true;
+}
+
+void BaseDelegate::postQosMessage(GstBuffer *buffer, GstClockTime runningTime,
+                                  GstClockTimeDiff jitter)
+{
+    GstBaseSink *sink = GST_BASE_SINK(m_sink);
+
+    GST_OBJECT_LOCK(sink);
+    GstClockTime streamTime = gst_segment_to_stream_time(&sink->segment, GST_FORMAT_TIME,
+                                                         GST_BUFFER_PTS(buffer));
+    GST_OBJECT_UNLOCK(sink);
+
+    GstMessage *message = gst_message_new_qos(GST_OBJECT(m_sink), FALSE,
+            runningTime, streamTime, GST_BUFFER_PTS(buffer), GST_BUFFER_DURATION(buffer));
+    gst_message_set_qos_values(message, jitter, m_proportion, 1000000);
+    m_statsMutex.lock();
+    gst_message_set_qos_stats(message, GST_FORMAT_BUFFERS,
+                              m_stats.framesPainted + m_stats.framesSuperseded,
+                              m_stats.framesSuperseded);
+    m_statsMutex.unlock();
+    gst_element_post_message(m_sink, message);
+}
+
+void BaseDelegate::framePainted()
+{
+    if (!m_buffer || m_bufferPainted) {
+        return; //a repaint of a frame that has already been reported
+    }
+    m_bufferPainted = true;
+
+    gint64 latency = g_get_monotonic_time() - m_bufferPostTime;
+    m_statsMutex.lock();
+    m_stats.framesPainted++;
+    m_stats.latencyTotal += latency;
+    m_stats.latencyMax = qMax(m_stats.latencyMax, latency);
+    m_statsMutex.unlock();
+    postStatsMessage();
+
+    //GstBaseSink's own QoS is disabled (see the constructor); this reports
+    //the real lateness of the frame upstream instead
+    if (!qosEnabled()) {
+        return;
+    }
+
+    GstClockTime runningTime, now;
+    GstClockTimeDiff jitter;
+    if (!bufferLateness(m_buffer, &runningTime, &now, &jitter)) {
+        return;
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID(m_lastPaintTime) && runningTime > m_lastPaintRunningTime
+        && now > m_lastPaintTime)
+    {
+        gdouble rate = gdouble(now - m_lastPaintTime)
+                / gdouble(runningTime - m_lastPaintRunningTime);
+        //the same moving average that GstBaseSink uses
+        m_proportion = (7.0 * m_proportion + rate) / 8.0;
+    }
+    m_lastPaintTime = now;
+    m_lastPaintRunningTime = runningTime;
+
+    GST_LOG_OBJECT(m_sink, "Painted frame with running time %" GST_TIME_FORMAT
+                   ", jitter %" G_GINT64_FORMAT ", proportion %f",
+                   GST_TIME_ARGS(runningTime), jitter, m_proportion);
+
+    GstPad *pad = gst_element_get_static_pad(m_sink, "sink");
+    gst_pad_push_event(pad, gst_event_new_qos(
+            jitter > 0 ? GST_QOS_TYPE_UNDERFLOW : GST_QOS_TYPE_OVERFLOW,
+            m_proportion, jitter, runningTime));
+    gst_object_unref(pad);
+
+    if (jitter > 0) {
+        postQosMessage(m_buffer, runningTime, jitter);
+    }
+}
+
+//-------------------------------------
+
 bool BaseDelegate::event(QEvent *event)
 {
     switch((int) event->type()) {
@@ -158,7 +462,28 @@ bool BaseDelegate::event(QEvent *event)
         GST_TRACE_OBJECT(m_sink, "Received buffer %"GST_PTR_FORMAT, bufEvent->buffer);
 
         if (isActive()) {
+            if (m_buffer && !m_bufferPainted) {
+                //the GUI thread did not get to paint this one in time
+                m_statsMutex.lock();
+                m_stats.framesSuperseded++;
+                m_statsMutex.unlock();
+
+                GstClockTime runningTime, now;
+                GstClockTimeDiff jitter;
+                if (qosEnabled()
+                    && bufferLateness(m_buffer, &runningTime, &now, &jitter))
+                {
+                    postQosMessage(m_buffer, runningTime, jitter);
+                }
+            }
+
             gst_buffer_replace (&m_buffer, bufEvent->buffer);
+            m_bufferPainted = false;
+            m_bufferPostTime = bufEvent->postTime;
+
+            m_statsMutex.lock();
+            m_stats.framesReceived++;
+            m_statsMutex.unlock();
             update();
         }
 
@@ -175,6 +500,10 @@ bool BaseDelegate::event(QEvent *event)
         m_formatDirty = true;
         m_bufferFormat = bufFmtEvent->format;
 
+        m_statsMutex.lock();
+        m_stats.format = bufFmtEvent->format;
+        m_statsMutex.unlock();
+
         return true;
     }
     case DeactivateEventType:
@@ -182,6 +511,9 @@ bool BaseDelegate::event(QEvent *event)
         GST_LOG_OBJECT(m_sink, "Received deactivate event");
 
         gst_buffer_replace (&m_buffer, NULL);
+        m_lastPaintTime = GST_CLOCK_TIME_NONE;
+        m_lastPaintRunningTime = GST_CLOCK_TIME_NONE;
+        m_proportion = 1.0;
         update();
 
         return true;
@@ -26,6 +26,7 @@
 
 #include <QObject>
 #include <QEvent>
+#include <QMutex>
 #include <QReadWriteLock>
 
 class BaseDelegate : public QObject
@@ -45,7 +46,8 @@ public:
     public:
         inline BufferEvent(GstBuffer *buf)
             : QEvent(static_cast<QEvent::Type>(BufferEventType)),
-              buffer(gst_buffer_ref(buf))
+              buffer(gst_buffer_ref(buf)),
+              postTime(g_get_monotonic_time())
         {}
 
         virtual ~BufferEvent() {
@@ -53,6 +55,8 @@ public:
         }
 
         GstBuffer *buffer;
+        // when show_frame() posted the buffer, in microseconds
+        gint64 postTime;
     };
 
     class BufferFormatEvent : public QEvent
@@ -105,6 +109,29 @@ public:
     bool forceAspectRatio() const;
     void setForceAspectRatio(bool force);
 
+    // negotiate-render-size property
+    bool negotiateRenderSize() const;
+    void setNegotiateRenderSize(bool negotiate);
+
+    // the largest frame size that is worth receiving, or an invalid size if there is no limit
+    QSize preferredSize() const;
+
+    // prepends a copy of caps that is limited to preferredSize(), so that
+    // upstream elements that can scale choose it first; takes ownership of caps
+    GstCaps *preferRenderSize(GstCaps *caps) const;
+
+    // stats property
+    GstStructure *stats() const;
+
+    // stats-interval property, in milliseconds; 0 disables the stats messages
+    uint statsInterval() const;
+    void setStatsInterval(uint msecs);
+
+    // qos property; overrides GstBaseSink's, whose own QoS is kept disabled
+    // because it is sent before the frame is painted
+    bool qosEnabled() const;
+    void setQosEnabled(bool enabled);
+
 protected:
     // internal event handling
     virtual bool event(QEvent *event);
@@ -112,6 +139,29 @@ protected:
     // tells the surface to repaint itself
     virtual void update();
 
+    // to be called with the size of the area that the video is painted on,
+    // whenever it changes; asks upstream to renegotiate if it changed enough
+    void setRenderSize(const QSizeF & size);
+
+    // sends a reconfigure event upstream, which makes it query our caps again
+    void reconfigureUpstream();
+
+    // to be called right after m_buffer has been painted; measures how late
+    // the paint was, reports it upstream as QoS and updates the stats
+    void framePainted();
+
+    // stats that only the subclasses know about
+    void setPainterName(const char *name);
+    void addUploadTime(gint64 usecs);
+
+private:
+    // computes the running time of buffer and how late it is now, compared to
+    // the time at which the sink was supposed to render it
+    bool bufferLateness(GstBuffer *buffer, GstClockTime *runningTime,
+                        GstClockTime *now, GstClockTimeDiff *jitter) const;
+    void postQosMessage(GstBuffer *buffer, GstClockTime runningTime, GstClockTimeDiff jitter);
+    void postStatsMessage();
+
 protected:
     // colorbalance interface properties
     mutable QReadWriteLock m_colorsLock;
@@ -130,6 +180,11 @@ protected:
     bool m_forceAspectRatioDirty;
     bool m_forceAspectRatio;
 
+    // negotiate-render-size property and the size that was last requested upstream
+    mutable QReadWriteLock m_renderSizeLock;
+    bool m_negotiateRenderSize;
+    QSize m_preferredSize;
+
     // format caching
     bool m_formatDirty;
     BufferFormat m_bufferFormat;
@@ -141,6 +196,37 @@ protected:
 
     // the buffer to be drawn next
     GstBuffer *m_buffer;
+    bool m_bufferPainted;
+
+    gint64 m_bufferPostTime;
+
+    // stats property; times are in microseconds
+    mutable QMutex m_statsMutex;
+    struct RenderStats
+    {
+        guint64 framesReceived;
+        guint64 framesPainted;
+        guint64 framesSuperseded;
+        gint64 latencyTotal;
+        gint64 latencyMax;
+        guint64 uploadCount;
+        gint64 uploadTotal;
+        gint64 uploadMax;
+        const char *painter;
+        BufferFormat format;
+    } m_stats;
+    uint m_statsInterval;
+    gint64 m_lastStatsTime;
+
+    // render-time QoS state; the proportion is an average of the
+    // painting rate over the rate of the running time
+    GstClockTime m_lastPaintTime;
+    GstClockTime m_lastPaintRunningTime;
+    gdouble m_proportion;
+
+    // qos property
+    mutable QReadWriteLock m_qosLock;
+    bool m_qosEnabled;
 
     // the video sink element
     GstElement * const m_sink;
@@ -21,12 +21,12 @@
 QtQuick2VideoSinkDelegate::QtQuick2VideoSinkDelegate(GstElement *sink, QObject *parent)
     : BaseDelegate(sink, parent)
 {
+    setPainterName("SceneGraph");
 }
 
 QSGNode* QtQuick2VideoSinkDelegate::updateNode(QSGNode *node, const QRectF & targetArea)
 {
     GST_TRACE_OBJECT(m_sink, "updateNode called");
-    bool sgnodeFormatChanged = false;
 
     VideoNode *vnode = dynamic_cast<VideoNode*>(node);
     if (!vnode) {
@@ -34,35 +34,36 @@ QSGNode* QtQuick2VideoSinkDelegate::updateNode(QSGNode *node, const QRectF & tar
         vnode = new VideoNode;
     }
 
+    //every node of every item gets updated with the same delegate state,
+    //so nothing here may be reset after the first node has seen it
     if (!m_buffer) {
         if (vnode->materialType() != VideoNode::MaterialTypeSolidBlack) {
             vnode->setMaterialTypeSolidBlack();
-            sgnodeFormatChanged = true;
-        }
-        if (sgnodeFormatChanged || targetArea != m_areas.targetArea) {
-            m_areas.targetArea = targetArea;
-            vnode->updateGeometry(m_areas);
         }
+        PaintAreas areas;
+        areas.targetArea = areas.videoArea = targetArea;
+        vnode->updateGeometry(areas);
     } else {
         //change format before geometry, so that we change QSGGeometry as well
-        if (m_formatDirty) {
-            vnode->changeFormat(m_bufferFormat);
-            sgnodeFormatChanged = true;
+        if (vnode->materialType() != VideoNode::MaterialTypeVideo
+                || vnode->format() != m_bufferFormat) {
+            vnode->changeFormat(m_bufferFormat, this);
         }
 
-        //recalculate the video area if needed
+        //the areas are cheap to calculate, the node only takes
+        //the new geometry if they actually changed
+        PaintAreas areas;
         QReadLocker forceAspectRatioLocker(&m_forceAspectRatioLock);
-        if (sgnodeFormatChanged || targetArea != m_areas.targetArea || m_forceAspectRatioDirty) {
-            m_forceAspectRatioDirty = false;
-
-            QReadLocker pixelAspectRatioLocker(&m_pixelAspectRatioLock);
-            Qt::AspectRatioMode aspectRatioMode = m_forceAspectRatio ?
-                    Qt::KeepAspectRatio : Qt::IgnoreAspectRatio;
-            m_areas.calculate(targetArea, m_bufferFormat.frameSize(),
-                    m_bufferFormat.pixelAspectRatio(), m_pixelAspectRatio,
-                    aspectRatioMode);
-            pixelAspectRatioLocker.unlock();
+        QReadLocker pixelAspectRatioLocker(&m_pixelAspectRatioLock);
+        Qt::AspectRatioMode aspectRatioMode = m_forceAspectRatio ?
+                Qt::KeepAspectRatio : Qt::IgnoreAspectRatio;
+        areas.calculate(targetArea, m_bufferFormat.frameSize(),
+                m_bufferFormat.pixelAspectRatio(), m_pixelAspectRatio,
+                aspectRatioMode);
+        pixelAspectRatioLocker.unlock();
+        forceAspectRatioLocker.unlock();
 
+        if (vnode->updateGeometry(areas)) {
             GST_LOG_OBJECT(m_sink,
                 "Recalculated paint areas: "
                 "Frame size: " QSIZE_FORMAT ", "
@@ -71,31 +72,38 @@ QSGNode* QtQuick2VideoSinkDelegate::updateNode(QSGNode *node, const QRectF & tar
                 "black1: " QRECTF_FORMAT ", "
                 "black2: " QRECTF_FORMAT,
                 QSIZE_FORMAT_ARGS(m_bufferFormat.frameSize()),
-                QRECTF_FORMAT_ARGS(m_areas.targetArea),
-                QRECTF_FORMAT_ARGS(m_areas.videoArea),
-                QRECTF_FORMAT_ARGS(m_areas.blackArea1),
-                QRECTF_FORMAT_ARGS(m_areas.blackArea2)
+                QRECTF_FORMAT_ARGS(areas.targetArea),
+                QRECTF_FORMAT_ARGS(areas.videoArea),
+                QRECTF_FORMAT_ARGS(areas.blackArea1),
+                QRECTF_FORMAT_ARGS(areas.blackArea2)
             );
-
-            vnode->updateGeometry(m_areas);
         }
-        forceAspectRatioLocker.unlock();
 
-        if (m_formatDirty) {
-            m_formatDirty = false;
-
-            //make sure to update the colors after changing material
-            m_colorsDirty = true;
+        //negotiate for the largest item, once per frame, so that items
+        //of different sizes do not make the size flip back and forth
+        if (!m_bufferPainted) {
+            if (!m_largestVideoArea.isEmpty()) {
+                setRenderSize(m_largestVideoArea);
+            }
+            m_largestVideoArea = QSizeF();
         }
+        m_largestVideoArea = m_largestVideoArea.expandedTo(areas.videoArea.size());
 
+        //the material compares the values, so this is a no-op
+        //for all but the first node after a change
         QReadLocker colorsLocker(&m_colorsLock);
-        if (m_colorsDirty) {
-            vnode->updateColors(m_brightness, m_contrast, m_hue, m_saturation);
-            m_colorsDirty = false;
-        }
+        vnode->updateColors(m_brightness, m_contrast, m_hue, m_saturation);
         colorsLocker.unlock();
 
+        //the previous frame was uploaded when the scene graph rendered it
+        gint64 uploadTime = vnode->takeUploadTime();
+        if (uploadTime >= 0) {
+            addUploadTime(uploadTime);
+        }
+
+        //the shared material ignores the frame if it already has it
         vnode->setCurrentFrame(m_buffer);
+        framePainted();
     }
 
     return vnode;
@@ -26,7 +26,13 @@ class QtQuick2VideoSinkDelegate : public BaseDelegate
 public:
     explicit QtQuick2VideoSinkDelegate(GstElement * sink, QObject * parent = 0);
 
+    // Called once per frame for every VideoItem that shows this sink; the
+    // nodes share the uploaded frame and only keep their own geometry.
     QSGNode *updateNode(QSGNode *node, const QRectF & targetArea);
+
+private:
+    // the largest video area of all the nodes that displayed the current frame
+    QSizeF m_largestVideoArea;
 };
 
 #endif // QTQUICK2VIDEOSINKDELEGATE_H
@@ -82,6 +82,8 @@ void QtVideoSinkDelegate::paint(QPainter *painter, const QRectF & targetArea)
                 QRECTF_FORMAT_ARGS(m_areas.blackArea1),
                 QRECTF_FORMAT_ARGS(m_areas.blackArea2)
             );
+
+            setRenderSize(m_areas.videoArea.size());
         }
         forceAspectRatioLocker.unlock();
 
@@ -107,8 +109,13 @@ void QtVideoSinkDelegate::paint(QPainter *painter, const QRectF & targetArea)
 
             GstMapInfo mem_info;
             if (gst_buffer_map(m_buffer, &mem_info, GST_MAP_READ)) {
+                //this includes the texture upload for the GL painters
+                gint64 start = g_get_monotonic_time();
                 m_painter->paint(mem_info.data, m_bufferFormat, painter, m_areas);
+                addUploadTime(g_get_monotonic_time() - start);
+
                 gst_buffer_unmap(m_buffer, &mem_info);
+                framePainted();
             }
         }
     }
@@ -186,17 +193,20 @@ void QtVideoSinkDelegate::changePainter(const BufferFormat & format)
             case Glsl:
                 GST_LOG_OBJECT(m_sink, "Creating GLSL painter");
                 m_painter = new GlslSurfacePainter;
+                setPainterName("Glsl");
                 break;
 # ifndef QT_OPENGL_ES
             case ArbFp:
                 GST_LOG_OBJECT(m_sink, "Creating ARB Fragment Shader painter");
                 m_painter = new ArbFpSurfacePainter;
+                setPainterName("ArbFp");
                 break;
 # endif
 #endif
             case Generic:
                 GST_LOG_OBJECT(m_sink, "Creating Generic painter");
                 m_painter = new GenericSurfacePainter;
+                setPainterName("Generic");
                 break;
             default:
                 Q_ASSERT(false);
@@ -224,6 +234,7 @@ void QtVideoSinkDelegate::destroyPainter()
 
     delete m_painter;
     m_painter = 0;
+    setPainterName("none");
 }
 
 bool QtVideoSinkDelegate::event(QEvent *event)
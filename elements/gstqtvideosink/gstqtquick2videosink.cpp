@@ -52,6 +52,10 @@ enum {
     PROP_BRIGHTNESS,
     PROP_HUE,
     PROP_SATURATION,
+    PROP_NEGOTIATE_RENDER_SIZE,
+    PROP_STATS,
+    PROP_STATS_INTERVAL,
+    PROP_QOS,
 };
 
 enum {
@@ -156,6 +160,15 @@ gst_qt_quick2_video_sink_set_property (GObject *object,
     case PROP_SATURATION:
         self->priv->delegate->setSaturation(g_value_get_int(value));
         break;
+    case PROP_NEGOTIATE_RENDER_SIZE:
+        self->priv->delegate->setNegotiateRenderSize(g_value_get_boolean(value));
+        break;
+    case PROP_STATS_INTERVAL:
+        self->priv->delegate->setStatsInterval(g_value_get_uint(value));
+        break;
+    case PROP_QOS:
+        self->priv->delegate->setQosEnabled(g_value_get_boolean(value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
         break;
@@ -197,6 +210,18 @@ gst_qt_quick2_video_sink_get_property (GObject *object,
     case PROP_SATURATION:
         g_value_set_int(value, self->priv->delegate->saturation());
         break;
+    case PROP_NEGOTIATE_RENDER_SIZE:
+        g_value_set_boolean(value, self->priv->delegate->negotiateRenderSize());
+        break;
+    case PROP_STATS:
+        g_value_take_boxed(value, self->priv->delegate->stats());
+        break;
+    case PROP_STATS_INTERVAL:
+        g_value_set_uint(value, self->priv->delegate->statsInterval());
+        break;
+    case PROP_QOS:
+        g_value_set_boolean(value, self->priv->delegate->qosEnabled());
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
         break;
@@ -223,6 +248,23 @@ gst_qt_quick2_video_sink_change_state(GstElement *element,
     return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 }
 
+static GstCaps *
+gst_qt_quick2_video_sink_get_caps(GstBaseSink *sink, GstCaps *filter)
+{
+    GstQtQuick2VideoSink *self = GST_QT_QUICK2_VIDEO_SINK (sink);
+
+    GstCaps *caps = self->priv->delegate->preferRenderSize(
+            gst_pad_get_pad_template_caps(GST_BASE_SINK_PAD(sink)));
+
+    if (filter) {
+        GstCaps *intersection = gst_caps_intersect_full(filter, caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(caps);
+        caps = intersection;
+    }
+
+    return caps;
+}
+
 static gboolean
 gst_qt_quick2_video_sink_set_caps(GstBaseSink *sink, GstCaps *caps)
 {
@@ -344,6 +386,7 @@ gst_qt_quick2_video_sink_class_init (GstQtQuick2VideoSinkClass *klass)
     element_class->change_state = gst_qt_quick2_video_sink_change_state;
 
     GstBaseSinkClass *base_sink_class = GST_BASE_SINK_CLASS(klass);
+    base_sink_class->get_caps = gst_qt_quick2_video_sink_get_caps;
     base_sink_class->set_caps = gst_qt_quick2_video_sink_set_caps;
 
     GstVideoSinkClass *video_sink_class = GST_VIDEO_SINK_CLASS(klass);
@@ -374,6 +417,53 @@ gst_qt_quick2_video_sink_class_init (GstQtQuick2VideoSinkClass *klass)
                              "When enabled, scaling will respect original aspect ratio",
                              FALSE, static_cast<GParamFlags>(G_PARAM_READWRITE)));
 
+    /**
+     * GstQtQuick2VideoSink::negotiate-render-size
+     *
+     * If set to TRUE, the sink will ask upstream elements to scale the video down
+     * to the size of the item that it is painted on, whenever that size changes
+     * significantly. Elements that cannot scale are not affected.
+     **/
+    g_object_class_install_property(gobject_class, PROP_NEGOTIATE_RENDER_SIZE,
+        g_param_spec_boolean("negotiate-render-size", "Negotiate render size",
+                             "When enabled, upstream is asked for frames no larger than the painted area",
+                             TRUE, static_cast<GParamFlags>(G_PARAM_READWRITE)));
+
+    /**
+     * GstQtQuick2VideoSink::stats
+     *
+     * A GstStructure with rendering statistics: the number of frames that were
+     * received, painted and superseded before they could be painted, the average
+     * and maximum time between show_frame and the paint, the average and maximum
+     * time spent uploading/drawing a frame, the painter in use and the negotiated
+     * video format and size. Times are in nanoseconds.
+     **/
+    g_object_class_install_property(gobject_class, PROP_STATS,
+        g_param_spec_boxed("stats", "Statistics", "Rendering statistics",
+                           GST_TYPE_STRUCTURE, static_cast<GParamFlags>(G_PARAM_READABLE)));
+
+    /**
+     * GstQtQuick2VideoSink::stats-interval
+     *
+     * If not zero, the sink posts an element message with the same structure
+     * as the stats property at most every stats-interval milliseconds, while
+     * it is painting.
+     **/
+    g_object_class_install_property(gobject_class, PROP_STATS_INTERVAL,
+        g_param_spec_uint("stats-interval", "Statistics interval",
+                          "Milliseconds between stats element messages, 0 to disable",
+                          0, G_MAXUINT, 0, static_cast<GParamFlags>(G_PARAM_READWRITE)));
+
+    /**
+     * GstQtQuick2VideoSink::qos
+     *
+     * Overrides GstBaseSink's qos property. GstBaseSink would send QoS events
+     * when a frame is handed to the GUI thread, before it is painted, so its own
+     * QoS is kept disabled and the sink reports the lateness of each painted
+     * frame instead, if this is enabled.
+     **/
+    g_object_class_override_property(gobject_class, PROP_QOS, "qos");
+
     g_object_class_install_property(gobject_class, PROP_CONTRAST,
         g_param_spec_int("contrast", "Contrast", "The contrast of the video",
                          -100, 100, 0, static_cast<GParamFlags>(G_PARAM_READWRITE)));
@@ -61,6 +61,7 @@ void GstQtVideoSinkBase::class_init(gpointer g_class, gpointer class_data)
     element_class->change_state = GstQtVideoSinkBase::change_state;
 
     GstBaseSinkClass *base_sink_class = GST_BASE_SINK_CLASS(g_class);
+    base_sink_class->get_caps = GstQtVideoSinkBase::get_caps;
     base_sink_class->set_caps = GstQtVideoSinkBase::set_caps;
 
     GstVideoSinkClass *video_sink_class = GST_VIDEO_SINK_CLASS(g_class);
@@ -88,6 +89,52 @@ void GstQtVideoSinkBase::class_init(gpointer g_class, gpointer class_data)
                              "When enabled, scaling will respect original aspect ratio",
                              FALSE, static_cast<GParamFlags>(G_PARAM_READWRITE)));
 
+    /**
+     * GstQtVideoSinkBase::negotiate-render-size
+     *
+     * If set to TRUE, the sink will ask upstream elements to scale the video down
+     * to the size of the area that it is painted on, whenever that area changes
+     * significantly. Elements that cannot scale are not affected.
+     **/
+    g_object_class_install_property(object_class, PROP_NEGOTIATE_RENDER_SIZE,
+        g_param_spec_boolean("negotiate-render-size", "Negotiate render size",
+                             "When enabled, upstream is asked for frames no larger than the painted area",
+                             TRUE, static_cast<GParamFlags>(G_PARAM_READWRITE)));
+
+    /**
+     * GstQtVideoSinkBase::stats
+     *
+     * A GstStructure with rendering statistics: the number of frames that were
+     * received, painted and superseded before they could be painted, the average
+     * and maximum time between show_frame and the paint, the average and maximum
+     * time spent uploading/drawing a frame, the painter in use and the negotiated
+     * video format and size. Times are in nanoseconds.
+     **/
+    g_object_class_install_property(object_class, PROP_STATS,
+        g_param_spec_boxed("stats", "Statistics", "Rendering statistics",
+                           GST_TYPE_STRUCTURE, static_cast<GParamFlags>(G_PARAM_READABLE)));
+
+    /**
+     * GstQtVideoSinkBase::stats-interval
+     *
+     * If not zero, the sink posts an element message with the same structure
+     * as the stats property at most every stats-interval milliseconds, while
+     * it is painting.
+     **/
+    g_object_class_install_property(object_class, PROP_STATS_INTERVAL,
+        g_param_spec_uint("stats-interval", "Statistics interval",
+                          "Milliseconds between stats element messages, 0 to disable",
+                          0, G_MAXUINT, 0, static_cast<GParamFlags>(G_PARAM_READWRITE)));
+
+    /**
+     * GstQtVideoSinkBase::qos
+     *
+     * Overrides GstBaseSink's qos property. GstBaseSink would send QoS events
+     * when a frame is handed to the GUI thread, before it is painted, so its own
+     * QoS is kept disabled and the sink reports the lateness of each painted
+     * frame instead, if this is enabled.
+     **/
+    g_object_class_override_property(object_class, PROP_QOS, "qos");
 }
 
 void GstQtVideoSinkBase::init(GTypeInstance *instance, gpointer g_class)
@@ -132,6 +179,15 @@ void GstQtVideoSinkBase::set_property(GObject *object, guint prop_id,
     case PROP_FORCE_ASPECT_RATIO:
         sink->delegate->setForceAspectRatio(g_value_get_boolean(value));
         break;
+    case PROP_NEGOTIATE_RENDER_SIZE:
+        sink->delegate->setNegotiateRenderSize(g_value_get_boolean(value));
+        break;
+    case PROP_STATS_INTERVAL:
+        sink->delegate->setStatsInterval(g_value_get_uint(value));
+        break;
+    case PROP_QOS:
+        sink->delegate->setQosEnabled(g_value_get_boolean(value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -158,6 +214,18 @@ void GstQtVideoSinkBase::get_property(GObject *object, guint prop_id,
     case PROP_FORCE_ASPECT_RATIO:
         g_value_set_boolean(value, sink->delegate->forceAspectRatio());
         break;
+    case PROP_NEGOTIATE_RENDER_SIZE:
+        g_value_set_boolean(value, sink->delegate->negotiateRenderSize());
+        break;
+    case PROP_STATS:
+        g_value_take_boxed(value, sink->delegate->stats());
+        break;
+    case PROP_STATS_INTERVAL:
+        g_value_set_uint(value, sink->delegate->statsInterval());
+        break;
+    case PROP_QOS:
+        g_value_set_boolean(value, sink->delegate->qosEnabled());
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -186,6 +254,22 @@ GstStateChangeReturn GstQtVideoSinkBase::change_state(GstElement *element, GstSt
 
 //------------------------------
 
+GstCaps *GstQtVideoSinkBase::get_caps(GstBaseSink *base, GstCaps *filter)
+{
+    GstQtVideoSinkBase *sink = GST_QT_VIDEO_SINK_BASE(base);
+
+    GstCaps *caps = sink->delegate->preferRenderSize(
+            gst_pad_get_pad_template_caps(GST_BASE_SINK_PAD(base)));
+
+    if (filter) {
+        GstCaps *intersection = gst_caps_intersect_full(filter, caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(caps);
+        caps = intersection;
+    }
+
+    return caps;
+}
+
 gboolean GstQtVideoSinkBase::set_caps(GstBaseSink *base, GstCaps *caps)
 {
     GstQtVideoSinkBase *sink = GST_QT_VIDEO_SINK_BASE(base);
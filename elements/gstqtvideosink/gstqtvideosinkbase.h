@@ -44,6 +44,10 @@ private:
         PROP_0,
         PROP_PIXEL_ASPECT_RATIO,
         PROP_FORCE_ASPECT_RATIO,
+        PROP_NEGOTIATE_RENDER_SIZE,
+        PROP_STATS,
+        PROP_STATS_INTERVAL,
+        PROP_QOS,
     };
 
     static void base_init(gpointer g_class);
@@ -58,6 +62,7 @@ private:
 
     static GstStateChangeReturn change_state(GstElement *element, GstStateChange transition);
 
+    static GstCaps *get_caps(GstBaseSink *sink, GstCaps *filter);
     static gboolean set_caps(GstBaseSink *sink, GstCaps *caps);
 
     static GstFlowReturn show_frame(GstVideoSink *sink, GstBuffer *buffer);
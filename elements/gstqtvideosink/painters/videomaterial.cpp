@@ -19,6 +19,8 @@
 #include "videomaterial.h"
 
 #include <qmath.h>
+#include <QHash>
+#include <QPair>
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
 #include <QtQuick/QSGMaterialShader>
@@ -235,22 +237,77 @@ VideoMaterial *VideoMaterial::create(const BufferFormat & format)
     return material;
 }
 
+typedef QPair<const void*, QOpenGLContext*> SharedMaterialKey;
+typedef QHash<SharedMaterialKey, VideoMaterial*> SharedMaterialHash;
+
+// materials are shared between the render threads of different windows
+Q_GLOBAL_STATIC(QMutex, s_sharedMaterialsMutex)
+Q_GLOBAL_STATIC(SharedMaterialHash, s_sharedMaterials)
+
+VideoMaterial *VideoMaterial::acquire(const void *owner, const BufferFormat & format)
+{
+    // textures can only be shared within the context that created them
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    SharedMaterialKey key(owner, context);
+
+    QMutexLocker lock(s_sharedMaterialsMutex());
+    VideoMaterial *material = s_sharedMaterials()->value(key);
+
+    if (material && material->m_bufferFormat == format) {
+        material->m_refCount++;
+    } else {
+        // a material with the old format stays alive until the
+        // nodes that still use it switch to the new one
+        material = create(format);
+        material->m_owner = owner;
+        material->m_context = context;
+        material->m_refCount = 1;
+        material->m_bufferFormat = format;
+        s_sharedMaterials()->insert(key, material);
+    }
+
+    return material;
+}
+
+void VideoMaterial::release(VideoMaterial *material)
+{
+    QMutexLocker lock(s_sharedMaterialsMutex());
+    if (--material->m_refCount > 0) {
+        return;
+    }
+
+    SharedMaterialKey key(material->m_owner, material->m_context);
+    if (s_sharedMaterials()->value(key) == material) {
+        s_sharedMaterials()->remove(key);
+    }
+    lock.unlock();
+
+    delete material;
+}
+
 VideoMaterial::VideoMaterial() :
     m_frame(0),
+    m_frameUploaded(false),
+    m_uploadTime(-1),
+    m_owner(0),
+    m_context(0),
+    m_refCount(0),
     m_textureCount(0),
     m_format(GST_VIDEO_FORMAT_UNKNOWN),
     m_textureFormat(0),
     m_textureInternalFormat(0),
     m_textureType(0),
-    m_colorMatrixType(GST_VIDEO_COLOR_MATRIX_UNKNOWN)
+    m_colorMatrixType(GST_VIDEO_COLOR_MATRIX_UNKNOWN),
+    m_colorsValid(false)
 {
     memset(m_textureIds, 0, sizeof(m_textureIds));
+    memset(m_colors, 0, sizeof(m_colors));
     setFlag(Blending, false);
 }
 
 VideoMaterial::~VideoMaterial()
 {
-    if (!m_textureSize.isEmpty())
+    if (m_textureCount > 0)
         glDeleteTextures(m_textureCount, m_textureIds);
     gst_buffer_replace(&m_frame, NULL);
 }
@@ -326,11 +383,23 @@ void VideoMaterial::init(GstVideoColorMatrix colorMatrixType)
 void VideoMaterial::setCurrentFrame(GstBuffer *buffer)
 {
     QMutexLocker lock(&m_frameMutex);
-    gst_buffer_replace(&m_frame, buffer);
+    // every node that shares this material sets the same frame,
+    // but it only needs to be uploaded once
+    if (buffer != m_frame) {
+        gst_buffer_replace(&m_frame, buffer);
+        m_frameUploaded = false;
+    }
 }
 
-void VideoMaterial::updateColors(int brightness, int contrast, int hue, int saturation)
+bool VideoMaterial::updateColors(int brightness, int contrast, int hue, int saturation)
 {
+    const int colors[4] = { brightness, contrast, hue, saturation };
+    if (m_colorsValid && memcmp(colors, m_colors, sizeof(m_colors)) == 0) {
+        return false;
+    }
+    memcpy(m_colors, colors, sizeof(m_colors));
+    m_colorsValid = true;
+
     const qreal b = brightness / 200.0;
     const qreal c = contrast / 100.0 + 1.0;
     const qreal h = hue / 100.0;
@@ -399,6 +468,8 @@ void VideoMaterial::updateColors(int brightness, int contrast, int hue, int satu
     default:
         break;
     }
+
+    return true;
 }
 
 void VideoMaterial::bind()
@@ -406,12 +477,17 @@ void VideoMaterial::bind()
     QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
     GstBuffer *frame = NULL;
 
+    // the textures keep their contents between renders, so only upload
+    // a frame the first time it gets drawn
     m_frameMutex.lock();
-    if (m_frame)
+    if (m_frame && !m_frameUploaded) {
       frame = gst_buffer_ref(m_frame);
+      m_frameUploaded = true;
+    }
     m_frameMutex.unlock();
 
     if (frame) {
+        gint64 start = g_get_monotonic_time();
         GstMapInfo info;
         gst_buffer_map(frame, &info, GST_MAP_READ);
         functions->glActiveTexture(GL_TEXTURE1);
@@ -422,6 +498,9 @@ void VideoMaterial::bind()
         bindTexture(0, info.data);
         gst_buffer_unmap(frame, &info);
         gst_buffer_unref(frame);
+
+        //this only measures the time to submit the data to the driver
+        m_uploadTime = g_get_monotonic_time() - start;
     } else {
         functions->glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, m_textureIds[1]);
@@ -432,6 +511,13 @@ void VideoMaterial::bind()
     }
 }
 
+gint64 VideoMaterial::takeUploadTime()
+{
+    gint64 uploadTime = m_uploadTime;
+    m_uploadTime = -1;
+    return uploadTime;
+}
+
 void VideoMaterial::bindTexture(int i, const quint8 *data)
 {
     glBindTexture(GL_TEXTURE_2D, m_textureIds[i]);
@@ -26,6 +26,7 @@
 
 #include <QtQuick/QSGMaterial>
 
+class QOpenGLContext;
 class VideoMaterialShader;
 
 class VideoMaterial : public QSGMaterial
@@ -33,15 +34,28 @@ class VideoMaterial : public QSGMaterial
 public:
     static VideoMaterial *create(const BufferFormat & format);
 
+    // Returns a referenced material that is shared by all the callers that
+    // pass the same owner and format from the same GL context, so that the
+    // textures are uploaded once per frame no matter how many nodes draw them.
+    // Every call must be balanced with release().
+    static VideoMaterial *acquire(const void *owner, const BufferFormat & format);
+    static void release(VideoMaterial *material);
+
+    const BufferFormat & bufferFormat() const { return m_bufferFormat; }
+
     virtual ~VideoMaterial();
 
     virtual int compare(const QSGMaterial *other) const;
 
     void setCurrentFrame(GstBuffer *buffer);
-    void updateColors(int brightness, int contrast, int hue, int saturation);
+    // returns false if the colors were already set to these values
+    bool updateColors(int brightness, int contrast, int hue, int saturation);
 
     void bind();
 
+    // see VideoNode::takeUploadTime()
+    gint64 takeUploadTime();
+
 protected:
     VideoMaterial();
     void initRgbTextureInfo(GLenum internalFormat, GLuint format,
@@ -54,7 +68,15 @@ private:
 
 
     GstBuffer *m_frame;
+    bool m_frameUploaded;
     QMutex m_frameMutex;
+    gint64 m_uploadTime;
+
+    // sharing, see acquire()
+    const void *m_owner;
+    QOpenGLContext *m_context;
+    int m_refCount;
+    BufferFormat m_bufferFormat;
 
     static const int Num_Texture_IDs = 3;
     int m_textureCount;
@@ -71,6 +93,8 @@ private:
 
     QMatrix4x4 m_colorMatrix;
     GstVideoColorMatrix m_colorMatrixType;
+    bool m_colorsValid;
+    int m_colors[4];
 
     friend class VideoMaterialShader;
 };
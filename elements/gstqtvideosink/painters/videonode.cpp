@@ -23,25 +23,52 @@
 
 VideoNode::VideoNode()
   : QSGGeometryNode()
+  , m_materialType(MaterialTypeSolidBlack)
 {
     setFlags(OwnsGeometry | OwnsMaterial, true);
     setMaterialTypeSolidBlack();
 }
 
-void VideoNode::changeFormat(const BufferFormat & format)
+VideoNode::~VideoNode()
 {
-    setMaterial(VideoMaterial::create(format));
+    releaseVideoMaterial();
+}
+
+void VideoNode::changeFormat(const BufferFormat & format, const void *owner)
+{
+    VideoMaterial *m = VideoMaterial::acquire(owner, format);
+
+    // the flat color material is ours and gets deleted by setMaterial(),
+    // the shared video material is reference counted instead
+    releaseVideoMaterial();
+    setMaterial(m);
+    setFlag(OwnsMaterial, false);
     setGeometry(0);
     m_materialType = MaterialTypeVideo;
+    m_format = format;
+    m_videoArea = m_sourceRect = QRectF();
 }
 
 void VideoNode::setMaterialTypeSolidBlack()
 {
     QSGFlatColorMaterial *m = new QSGFlatColorMaterial;
     m->setColor(Qt::black);
+    releaseVideoMaterial();
     setMaterial(m);
+    setFlag(OwnsMaterial, true);
     setGeometry(0);
     m_materialType = MaterialTypeSolidBlack;
+    m_format = BufferFormat();
+    m_videoArea = m_sourceRect = QRectF();
+}
+
+void VideoNode::releaseVideoMaterial()
+{
+    if (m_materialType == MaterialTypeVideo && material()) {
+        VideoMaterial *m = static_cast<VideoMaterial*>(material());
+        setMaterial(0);
+        VideoMaterial::release(m);
+    }
 }
 
 void VideoNode::setCurrentFrame(GstBuffer* buffer)
@@ -51,11 +78,19 @@ void VideoNode::setCurrentFrame(GstBuffer* buffer)
     markDirty(DirtyMaterial);
 }
 
+gint64 VideoNode::takeUploadTime()
+{
+    if (m_materialType != MaterialTypeVideo) {
+        return -1;
+    }
+    return static_cast<VideoMaterial*>(material())->takeUploadTime();
+}
+
 void VideoNode::updateColors(int brightness, int contrast, int hue, int saturation)
 {
     Q_ASSERT (m_materialType == MaterialTypeVideo);
-    static_cast<VideoMaterial*>(material())->updateColors(brightness, contrast, hue, saturation);
-    markDirty(DirtyMaterial);
+    if (static_cast<VideoMaterial*>(material())->updateColors(brightness, contrast, hue, saturation))
+        markDirty(DirtyMaterial);
 }
 
 /* Helpers */
@@ -72,10 +107,15 @@ static inline void setTex(QSGGeometry::TexturedPoint2D *v, const QPointF &p)
     v->ty = p.y();
 }
 
-void VideoNode::updateGeometry(const PaintAreas & areas)
+bool VideoNode::updateGeometry(const PaintAreas & areas)
 {
     QSGGeometry *g = geometry();
 
+    if (g && areas.videoArea == m_videoArea && areas.sourceRect == m_sourceRect)
+        return false;
+    m_videoArea = areas.videoArea;
+    m_sourceRect = areas.sourceRect;
+
     if (m_materialType == MaterialTypeVideo) {
         if (!g)
             g = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4);
@@ -109,4 +149,5 @@ void VideoNode::updateGeometry(const PaintAreas & areas)
         setGeometry(g);
 
     markDirty(DirtyGeometry);
+    return true;
 }
@@ -27,6 +27,7 @@ class VideoNode : public QSGGeometryNode
 {
 public:
     VideoNode();
+    virtual ~VideoNode();
 
     enum MaterialType {
         MaterialTypeVideo,
@@ -35,16 +36,30 @@ public:
 
     MaterialType materialType() const { return m_materialType; }
 
-    void changeFormat(const BufferFormat &format);
+    // switches to the video material that all the nodes of the same owner
+    // share in the current GL context, see VideoMaterial::acquire()
+    void changeFormat(const BufferFormat &format, const void *owner);
+    const BufferFormat & format() const { return m_format; }
     void setMaterialTypeSolidBlack();
 
     void setCurrentFrame(GstBuffer *buffer);
+
+    // the time spent uploading the last frame in microseconds, or -1 if
+    // no frame has been uploaded since the last call
+    gint64 takeUploadTime();
     void updateColors(int brightness, int contrast, int hue, int saturation);
 
-    void updateGeometry(const PaintAreas & areas);
+    // returns false if the geometry was already set to these areas
+    bool updateGeometry(const PaintAreas & areas);
+    const QRectF & videoArea() const { return m_videoArea; }
 
 private:
+    void releaseVideoMaterial();
+
     MaterialType m_materialType;
+    BufferFormat m_format;
+    QRectF m_videoArea;
+    QRectF m_sourceRect;
 };
 
 #endif // VIDEONODE_H
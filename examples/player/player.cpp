@@ -41,6 +41,7 @@ Player::Player(QWidget *parent)
 Player::~Player()
 {
     if (m_pipeline) {
+        m_positionTracker.setPipeline(QGst::PipelinePtr());
         m_pipeline->setState(QGst::StateNull);
         stopPipelineWatch();
     }
@@ -65,6 +66,10 @@ void Player::setUri(const QString & uri)
             QGst::BusPtr bus = m_pipeline->bus();
             bus->addSignalWatch();
             QGlib::connect(bus, "message", this, &Player::onBusMessage);
+
+            //follow the pipeline's clock to know the position, instead of
+            //querying the pipeline on every tick of the position timer
+            m_positionTracker.setPipeline(m_pipeline);
         } else {
             qCritical() << "Failed to create the pipeline";
         }
@@ -77,12 +82,10 @@ void Player::setUri(const QString & uri)
 
 QTime Player::position() const
 {
-    if (m_pipeline) {
-        //here we query the pipeline about its position
-        //and we request that the result is returned in time format
-        QGst::PositionQueryPtr query = QGst::PositionQuery::create(QGst::FormatTime);
-        m_pipeline->query(query);
-        return QGst::ClockTime(query->position()).toTime();
+    if (m_positionTracker.isValid()) {
+        //the tracker extrapolates the position from the pipeline's clock,
+        //so this does not need to send a query through the pipeline
+        return m_positionTracker.position().toTime();
     } else {
         return QTime(0,0);
     }
@@ -23,6 +23,7 @@
 #include <QTime>
 #include <QGst/Pipeline>
 #include <QGst/Ui/VideoWidget>
+#include <QGst/Utils/PositionTracker>
 
 class Player : public QGst::Ui::VideoWidget
 {
@@ -56,6 +57,7 @@ private:
 
     QGst::PipelinePtr m_pipeline;
     QTimer m_positionTimer;
+    QGst::Utils::PositionTracker m_positionTracker;
 };
 
 #endif
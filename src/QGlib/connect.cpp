@@ -18,12 +18,15 @@
 */
 #include "connect.h"
 #include <glib-object.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
 #include <QtCore/QHash>
 #include <QtCore/QMutex>
+#include <QtCore/QThread>
 #include <boost/multi_index_container.hpp>
 #ifndef Q_MOC_RUN  // See: https://bugreports.qt-project.org/browse/QTBUG-22829
 #include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #endif
 #include <boost/multi_index/member.hpp>
 
@@ -32,20 +35,21 @@ namespace Private {
 
 //BEGIN ******** Closure internals ********
 
-static void c_marshaller(GClosure *closure, GValue *returnValue, uint paramValuesCount,
-                         const GValue *paramValues, void *hint, void *data)
+static QList<Value> collectParams(ClosureDataBase *cdata, uint paramValuesCount,
+                                  const GValue *paramValues)
 {
-    Q_UNUSED(data);
-
-    ClosureDataBase *cdata = static_cast<ClosureDataBase*>(closure->data);
-
     QList<Value> params;
     //the signal sender is always the first argument. if we are instructed not to pass it
     //as an argument to the slot, begin converting from paramValues[1]
     for(uint i = cdata->passSender ? 0 : 1; i<paramValuesCount; ++i) {
         params.append(Value(&paramValues[i]));
     }
+    return params;
+}
 
+static void invokeClosure(ClosureDataBase *cdata, GValue *returnValue,
+                          const QList<Value> & params, const GSignalInvocationHint *hint)
+{
     try {
         Value result(returnValue);
         cdata->marshaller(result, params);
@@ -56,7 +60,7 @@ static void c_marshaller(GClosure *closure, GValue *returnValue, uint paramValue
     } catch (const std::exception & e) {
         QString signalName;
         if (hint != NULL) {
-            GSignalInvocationHint *ihint = static_cast<GSignalInvocationHint*>(hint);
+            const GSignalInvocationHint *ihint = hint;
 
             GSignalQuery query;
             g_signal_query(ihint->signal_id, &query);
@@ -102,6 +106,16 @@ static void c_marshaller(GClosure *closure, GValue *returnValue, uint paramValue
     }
 }
 
+static void c_marshaller(GClosure *closure, GValue *returnValue, uint paramValuesCount,
+                         const GValue *paramValues, void *hint, void *data)
+{
+    Q_UNUSED(data);
+
+    ClosureDataBase *cdata = static_cast<ClosureDataBase*>(closure->data);
+    invokeClosure(cdata, returnValue, collectParams(cdata, paramValuesCount, paramValues),
+                  static_cast<GSignalInvocationHint*>(hint));
+}
+
 static void closureDestroyNotify(void *data, GClosure *closure)
 {
     Q_UNUSED(data);
@@ -119,6 +133,176 @@ static inline GClosure *createCppClosure(ClosureDataBase *closureData)
 }
 
 //END ******** Closure internals ********
+//BEGIN ******** Queued closure internals ********
+
+/* The state that a queued closure shares with the QueuedInvoker that receives its events.
+ * The mutex protects all the members. */
+struct QueueState
+{
+    inline QueueState() : invoker(NULL), posted(false) {}
+
+    QMutex mutex;
+    QObject *invoker; //NULL after the invoker has been destroyed
+    bool posted; //whether a coalesced call is waiting in the event queue
+    QList<Value> pending; //the arguments of that call
+};
+
+typedef QSharedPointer<QueueState> QueueStatePtr;
+
+struct QueuedClosureData
+{
+    ClosureDataBase *cdata;
+    bool coalesce;
+    QueueStatePtr state;
+};
+
+static QEvent::Type queuedCallEventType()
+{
+    static const int type = QEvent::registerEventType();
+    return static_cast<QEvent::Type>(type);
+}
+
+/* Carries one emission to the receiver's thread. It holds a reference on the closure,
+ * so that the slot can still be looked up if the signal is disconnected meanwhile. */
+class QueuedCallEvent : public QEvent
+{
+public:
+    inline QueuedCallEvent(GClosure *closure, const QList<Value> & params,
+                           const GSignalInvocationHint *hint)
+        : QEvent(queuedCallEventType()), m_closure(closure), m_params(params),
+          m_hasHint(hint != NULL)
+    {
+        g_closure_ref(m_closure);
+        if (hint) {
+            m_hint = *hint;
+        }
+    }
+
+    virtual ~QueuedCallEvent()
+    {
+        g_closure_unref(m_closure);
+    }
+
+    void deliver()
+    {
+        //the handler was disconnected after this event was posted
+        if (m_closure->is_invalid) {
+            return;
+        }
+
+        QueuedClosureData *qdata = static_cast<QueuedClosureData*>(m_closure->data);
+        if (qdata->coalesce) {
+            QMutexLocker l(&qdata->state->mutex);
+            m_params = qdata->state->pending;
+            qdata->state->pending.clear();
+            qdata->state->posted = false;
+        }
+
+        invokeClosure(qdata->cdata, NULL, m_params, m_hasHint ? &m_hint : NULL);
+    }
+
+private:
+    GClosure *m_closure;
+    QList<Value> m_params;
+    bool m_hasHint;
+    GSignalInvocationHint m_hint;
+};
+
+/* Lives in the receiver's thread, as a child of the receiver,
+ * and invokes the slot when a QueuedCallEvent reaches it. */
+class QueuedInvoker : public QObject
+{
+public:
+    QueuedInvoker(QObject *receiver, const QueueStatePtr & state)
+        : QObject(), m_state(state)
+    {
+        moveToThread(receiver->thread());
+        setParent(receiver);
+        m_state->invoker = this;
+    }
+
+    virtual ~QueuedInvoker()
+    {
+        QMutexLocker l(&m_state->mutex);
+        m_state->invoker = NULL;
+    }
+
+protected:
+    virtual bool event(QEvent *event)
+    {
+        if (event->type() == queuedCallEventType()) {
+            static_cast<QueuedCallEvent*>(event)->deliver();
+            return true;
+        }
+        return QObject::event(event);
+    }
+
+private:
+    QueueStatePtr m_state;
+};
+
+static void c_queuedMarshaller(GClosure *closure, GValue *returnValue, uint paramValuesCount,
+                               const GValue *paramValues, void *hint, void *data)
+{
+    Q_UNUSED(returnValue);
+    Q_UNUSED(data);
+
+    QueuedClosureData *qdata = static_cast<QueuedClosureData*>(closure->data);
+    QList<Value> params = collectParams(qdata->cdata, paramValuesCount, paramValues);
+    GSignalInvocationHint *ihint = static_cast<GSignalInvocationHint*>(hint);
+
+    QMutexLocker l(&qdata->state->mutex);
+    if (!qdata->state->invoker) {
+        return; //the receiver is being destroyed
+    }
+
+    if (!qdata->coalesce) {
+        QCoreApplication::postEvent(qdata->state->invoker,
+                                    new QueuedCallEvent(closure, params, ihint));
+    } else {
+        //replace the arguments of the call that is already queued, if there is one
+        qdata->state->pending = params;
+        if (!qdata->state->posted) {
+            qdata->state->posted = true;
+            QCoreApplication::postEvent(qdata->state->invoker,
+                                        new QueuedCallEvent(closure, QList<Value>(), ihint));
+        }
+    }
+}
+
+static void queuedClosureDestroyNotify(void *data, GClosure *closure)
+{
+    Q_UNUSED(data);
+    QueuedClosureData *qdata = static_cast<QueuedClosureData*>(closure->data);
+
+    qdata->state->mutex.lock();
+    if (qdata->state->invoker) {
+        qdata->state->invoker->deleteLater();
+    }
+    qdata->state->mutex.unlock();
+
+    delete qdata->cdata;
+    delete qdata;
+}
+
+static inline GClosure *createQueuedClosure(ClosureDataBase *closureData,
+                                            QObject *receiver, bool coalesce)
+{
+    QueuedClosureData *qdata = new QueuedClosureData;
+    qdata->cdata = closureData;
+    qdata->coalesce = coalesce;
+    qdata->state = QueueStatePtr(new QueueState);
+    new QueuedInvoker(receiver, qdata->state);
+
+    GClosure *closure = g_closure_new_simple(sizeof(GClosure), qdata);
+    g_closure_set_marshal(closure, &c_queuedMarshaller);
+    g_closure_add_finalize_notifier(closure, NULL, &queuedClosureDestroyNotify);
+    g_closure_ref(closure);
+    g_closure_sink(closure);
+    return closure;
+}
+
+//END ******** Queued closure internals ********
 //BEGIN ******** QObjectDestroyNotifier ********
 
 Q_GLOBAL_STATIC(QWeakPointer<DestroyNotifierIface>, s_qobjDestroyNotifier)
@@ -152,11 +336,24 @@ bool QObjectDestroyNotifier::disconnect(void* receiver, QObject *notificationRec
 //END ******** QObjectDestroyNotifier ********
 //BEGIN ******** ConnectionsStore ********
 
+/* The connections are kept per sender instance, in containers that are indexed with
+ * hash tables, so that connecting and disconnecting a handler costs the same no matter
+ * how many connections exist. The senders and the receivers are spread over a number of
+ * shards, each with its own lock, so that threads that connect to or disconnect from
+ * different objects do not wait for each other. When a sender shard lock and a receiver
+ * shard lock are both needed, the sender one is always taken first.
+ *
+ * Handlers are disconnected from GObject while the lock of the sender's shard is held, so
+ * that a sender that is being finalized in another thread, which needs that lock to report
+ * its destroyed closures, cannot be freed in the middle of the disconnection. Disconnecting
+ * finalizes the closures, which calls back into onClosureDestroyedAction() from the same
+ * thread; the per-thread s_instanceInRemoval marker makes it return without locking again.
+ */
 class ConnectionsStore : public QObject
 {
     Q_OBJECT
 public:
-    inline ConnectionsStore() : QObject(), m_handlerIdInRemoval(0) {}
+    inline ConnectionsStore() : QObject() {}
 
     ulong connect(void *instance, uint signal, Quark detail,
                   void *receiver, const DestroyNotifierIfacePtr & notifier,
@@ -185,24 +382,6 @@ private:
         ulong handlerId;
     };
 
-    bool lookupAndExec(void *instance, uint signal, Quark detail, void *receiver, uint slotHash,
-                       ulong handlerId, void (ConnectionsStore::*func)(void*, const Connection &));
-
-    void disconnectHandler(void *instance, const Connection & c);
-    void disconnectAndDestroyRcvrWatch(void *instance, const Connection & c);
-
-    void setupClosureWatch(void *instance, ulong handlerId, GClosure *closure);
-    void onClosureDestroyedAction(void *instance, ulong handlerId);
-    static void onClosureDestroyed(void *data, GClosure *closure);
-
-    void setupReceiverWatch(void *instance, void *receiver, const DestroyNotifierIfacePtr & notifier);
-    void destroyReceiverWatch(void *instance, const Connection & c);
-
-private Q_SLOTS:
-    void onReceiverDestroyed(void *receiver);
-    void onReceiverDestroyed(QObject *receiver);
-
-private:
     //tags
     struct sequential {};
     struct by_handlerId {};
@@ -215,15 +394,15 @@ private:
             boost::multi_index::sequenced<
                 boost::multi_index::tag<sequential>
             >,
-            boost::multi_index::ordered_non_unique<
+            boost::multi_index::hashed_non_unique<
                 boost::multi_index::tag<by_signal>,
                 boost::multi_index::member<Connection, uint, &Connection::signal>
             >,
-            boost::multi_index::ordered_non_unique<
+            boost::multi_index::hashed_non_unique<
                 boost::multi_index::tag<by_receiver>,
                 boost::multi_index::member<Connection, void*, &Connection::receiver>
             >,
-            boost::multi_index::ordered_unique<
+            boost::multi_index::hashed_unique<
                 boost::multi_index::tag<by_handlerId>,
                 boost::multi_index::member<Connection, ulong, &Connection::handlerId>
             >
@@ -243,28 +422,84 @@ private:
         QHash<void*, int> senders; //<sender, refcount>
     };
 
-    QMutex m_mutex;
-    QHash<void*, ConnectionsContainer> m_connections; // <sender, connections>
-    QHash<void*, ReceiverData> m_receivers; // <receiver, data>
+    struct SenderShard
+    {
+        QMutex mutex;
+        QHash<void*, ConnectionsContainer> connections; // <sender, connections>
+    };
+
+    struct ReceiverShard
+    {
+        QMutex mutex;
+        QHash<void*, ReceiverData> receivers; // <receiver, data>
+    };
+
+    enum { ShardCount = 16 };
 
-    QMutex m_handlerIdInRemovalMutex;
-    ulong m_handlerIdInRemoval;
+    static inline uint shardIndex(void *ptr)
+    {
+        //the low bits of heap pointers are mostly zero
+        quintptr value = reinterpret_cast<quintptr>(ptr);
+        return uint((value >> 4) ^ (value >> 12)) % ShardCount;
+    }
+
+    inline SenderShard & senderShard(void *instance)
+    { return m_senderShards[shardIndex(instance)]; }
+
+    inline ReceiverShard & receiverShard(void *receiver)
+    { return m_receiverShards[shardIndex(receiver)]; }
+
+    //must be called with the lock of the sender's shard held
+    QList<Connection> takeConnections(SenderShard & shard, void *instance, uint signal,
+                                      Quark detail, void *receiver, uint slotHash,
+                                      ulong handlerId, bool destroyReceiverWatches);
+
+    bool removeConnections(void *instance, uint signal, Quark detail,
+                           void *receiver, uint slotHash, ulong handlerId,
+                           bool destroyReceiverWatches);
+
+    void setupClosureWatch(void *instance, ulong handlerId, GClosure *closure);
+    void onClosureDestroyedAction(void *instance, ulong handlerId);
+    static void onClosureDestroyed(void *data, GClosure *closure);
+
+    void setupReceiverWatch(void *instance, void *receiver, const DestroyNotifierIfacePtr & notifier);
+    void destroyReceiverWatch(void *instance, void *receiver);
+
+private Q_SLOTS:
+    void onReceiverDestroyed(void *receiver);
+    void onReceiverDestroyed(QObject *receiver);
+
+private:
+    SenderShard m_senderShards[ShardCount];
+    ReceiverShard m_receiverShards[ShardCount];
 };
 
 Q_GLOBAL_STATIC(ConnectionsStore, s_connectionsStore)
 
+/* The sender whose handlers the current thread is disconnecting in removeConnections() */
+static GPrivate s_instanceInRemoval = G_PRIVATE_INIT(NULL);
+
 ulong ConnectionsStore::connect(void *instance, uint signal, Quark detail,
                                 void *receiver, const DestroyNotifierIfacePtr & notifier,
                                 uint slotHash, ClosureDataBase *closureData, ConnectFlags flags)
 {
-    QMutexLocker l(&m_mutex);
-    GClosure *closure = createCppClosure(closureData);
+    GClosure *closure;
+    if (flags & (QueuedConnection | CoalescedConnection)) {
+        //the receiver is a QObject, as GetDestroyNotifier requires
+        closure = createQueuedClosure(closureData, reinterpret_cast<QObject*>(receiver),
+                                      flags & CoalescedConnection);
+    } else {
+        closure = createCppClosure(closureData);
+    }
+
+    SenderShard & shard = senderShard(instance);
+    QMutexLocker l(&shard.mutex);
 
     ulong handlerId = g_signal_connect_closure_by_id(instance, signal, detail, closure,
                                                      (flags & ConnectAfter) ? TRUE : FALSE);
 
     if (handlerId) {
-        m_connections[instance].get<sequential>().push_back(
+        shard.connections[instance].get<sequential>().push_back(
             Connection(signal, detail, receiver, slotHash, handlerId)
         );
 
@@ -272,6 +507,7 @@ ulong ConnectionsStore::connect(void *instance, uint signal, Quark detail,
         setupReceiverWatch(instance, receiver, notifier);
     }
 
+    l.unlock();
     g_closure_unref(closure);
     return handlerId;
 }
@@ -279,100 +515,103 @@ ulong ConnectionsStore::connect(void *instance, uint signal, Quark detail,
 bool ConnectionsStore::disconnect(void *instance, uint signal, Quark detail,
                                   void *receiver, uint slotHash, ulong handlerId)
 {
-    QMutexLocker l(&m_mutex);
-    return lookupAndExec(instance, signal, detail, receiver, slotHash, handlerId,
-                         &ConnectionsStore::disconnectAndDestroyRcvrWatch);
+    return removeConnections(instance, signal, detail, receiver, slotHash, handlerId, true);
 }
 
-bool ConnectionsStore::lookupAndExec(void *instance, uint signal, Quark detail,
-                                     void *receiver, uint slotHash, ulong handlerId,
-                                     void (ConnectionsStore::*func)(void*, const Connection &))
+bool ConnectionsStore::removeConnections(void *instance, uint signal, Quark detail,
+                                         void *receiver, uint slotHash, ulong handlerId,
+                                         bool destroyReceiverWatches)
 {
-    bool executed = false;
+    SenderShard & shard = senderShard(instance);
+    QMutexLocker l(&shard.mutex);
+
+    QList<Connection> removed = takeConnections(shard, instance, signal, detail, receiver,
+                                                slotHash, handlerId, destroyReceiverWatches);
+
+    /* This will unref the closures and cause onClosureDestroyed to be invoked
+     * from this thread, which must not take the lock again. */
+    void *previous = g_private_get(&s_instanceInRemoval);
+    g_private_set(&s_instanceInRemoval, instance);
+    Q_FOREACH(const Connection & c, removed) {
+        g_signal_handler_disconnect(instance, c.handlerId);
+    }
+    g_private_set(&s_instanceInRemoval, previous);
 
-    if (m_connections.contains(instance)) {
-        ConnectionsContainer & container = m_connections[instance];
+    return !removed.isEmpty();
+}
 
-        if (handlerId) {
-            ByHandlerIterator it = container.get<by_handlerId>().find(handlerId);
+QList<ConnectionsStore::Connection>
+ConnectionsStore::takeConnections(SenderShard & shard, void *instance, uint signal,
+                                  Quark detail, void *receiver, uint slotHash,
+                                  ulong handlerId, bool destroyReceiverWatches)
+{
+    QList<Connection> removed;
 
-            if (it != container.get<by_handlerId>().end()) {
-                (this->*func)(instance, *it);
-                executed = true;
+    QHash<void*, ConnectionsContainer>::iterator containerIt = shard.connections.find(instance);
+    if (containerIt == shard.connections.end()) {
+        return removed;
+    }
 
-                container.get<by_handlerId>().erase(it);
-            }
-        } else if (signal) {
-            BySignalIterators iterators = container.get<by_signal>().equal_range(signal);
-
-            while (iterators.first != iterators.second) {
-                if (!detail ||
-                        (detail == iterators.first->detail &&
-                            (!receiver ||
-                                (receiver == iterators.first->receiver &&
-                                    (!slotHash || slotHash == iterators.first->slotHash)
-                                )
-                            )
-                        )
-                   )
-                {
-                    (this->*func)(instance, *iterators.first);
-                    executed = true;
+    ConnectionsContainer & container = containerIt.value();
 
-                    iterators.first = container.get<by_signal>().erase(iterators.first);
-                } else {
-                    ++iterators.first;
-                }
-            }
-        } else if (receiver) {
-            ByReceiverIterators iterators = container.get<by_receiver>().equal_range(receiver);
-
-            while (iterators.first != iterators.second) {
-                if (!slotHash || slotHash == iterators.first->slotHash) {
-                    (this->*func)(instance, *iterators.first);
-                    executed = true;
+    if (handlerId) {
+        ByHandlerIterator it = container.get<by_handlerId>().find(handlerId);
 
-                    iterators.first = container.get<by_receiver>().erase(iterators.first);
-                } else {
-                    ++iterators.first;
-                }
-            }
-        } else {
-            for (SequentialIterator it = container.get<sequential>().begin();
-                 it != container.get<sequential>().end(); ++it)
+        if (it != container.get<by_handlerId>().end()) {
+            removed.append(*it);
+            container.get<by_handlerId>().erase(it);
+        }
+    } else if (signal) {
+        BySignalIterators iterators = container.get<by_signal>().equal_range(signal);
+
+        while (iterators.first != iterators.second) {
+            if (!detail ||
+                    (detail == iterators.first->detail &&
+                        (!receiver ||
+                            (receiver == iterators.first->receiver &&
+                                (!slotHash || slotHash == iterators.first->slotHash)
+                            )
+                        )
+                    )
+               )
             {
-                (this->*func)(instance, *it);
-                executed = true;
+                removed.append(*iterators.first);
+                iterators.first = container.get<by_signal>().erase(iterators.first);
+            } else {
+                ++iterators.first;
             }
-            container.get<sequential>().clear();
         }
-
-        if (container.get<sequential>().empty()) {
-            m_connections.remove(instance);
+    } else if (receiver) {
+        ByReceiverIterators iterators = container.get<by_receiver>().equal_range(receiver);
+
+        while (iterators.first != iterators.second) {
+            if (!slotHash || slotHash == iterators.first->slotHash) {
+                removed.append(*iterators.first);
+                iterators.first = container.get<by_receiver>().erase(iterators.first);
+            } else {
+                ++iterators.first;
+            }
+        }
+    } else {
+        for (SequentialIterator it = container.get<sequential>().begin();
+             it != container.get<sequential>().end(); ++it)
+        {
+            removed.append(*it);
         }
+        container.get<sequential>().clear();
     }
 
-    return executed;
-}
-
-void ConnectionsStore::disconnectHandler(void *instance, const Connection & c)
-{
-    m_handlerIdInRemovalMutex.lock();
-    m_handlerIdInRemoval = c.handlerId;
-    m_handlerIdInRemovalMutex.unlock();
-
-    /* This will unref the closure and cause onClosureDestroyed to be invoked. */
-    g_signal_handler_disconnect(instance, c.handlerId);
+    if (destroyReceiverWatches) {
+        Q_FOREACH(const Connection & c, removed) {
+            destroyReceiverWatch(instance, c.receiver);
+        }
+    }
 
-    m_handlerIdInRemovalMutex.lock();
-    m_handlerIdInRemoval = 0;
-    m_handlerIdInRemovalMutex.unlock();
-}
+    if (container.get<sequential>().empty()) {
+        shard.connections.erase(containerIt);
+    }
 
-void ConnectionsStore::disconnectAndDestroyRcvrWatch(void *instance, const Connection & c)
-{
-    disconnectHandler(instance, c);
-    destroyReceiverWatch(instance, c);
+    return removed;
 }
 
 void ConnectionsStore::setupClosureWatch(void *instance, ulong handlerId, GClosure *closure)
@@ -392,52 +631,71 @@ void ConnectionsStore::onClosureDestroyed(void *data, GClosure *closure)
 
 void ConnectionsStore::onClosureDestroyedAction(void *instance, ulong handlerId)
 {
-    /* Do not do any action if we are being invoked from disconnectHandler() */
-    m_handlerIdInRemovalMutex.lock();
-    register bool ok = (m_handlerIdInRemoval != handlerId);
-    m_handlerIdInRemovalMutex.unlock();
-
-    if (ok) {
-        QMutexLocker l(&m_mutex);
-        lookupAndExec(instance, 0, Quark(), 0, 0, handlerId, &ConnectionsStore::destroyReceiverWatch);
+    /* Do not do any action if we are being invoked from removeConnections(),
+     * which holds the lock and has already removed the connection. Otherwise
+     * the sender is being destroyed. */
+    if (g_private_get(&s_instanceInRemoval) == instance) {
+        return;
     }
+
+    SenderShard & shard = senderShard(instance);
+    QMutexLocker l(&shard.mutex);
+    takeConnections(shard, instance, 0, Quark(), 0, 0, handlerId, true);
 }
 
 void ConnectionsStore::setupReceiverWatch(void *instance, void *receiver,
                                           const DestroyNotifierIfacePtr & notifier)
 {
-    if (!m_receivers.contains(receiver)) {
+    ReceiverShard & shard = receiverShard(receiver);
+    QMutexLocker l(&shard.mutex);
+
+    QHash<void*, ReceiverData>::iterator it = shard.receivers.find(receiver);
+    if (it == shard.receivers.end()) {
         ReceiverData data;
         data.notifier = notifier;
         if (!notifier->connect(receiver, this, SLOT(onReceiverDestroyed(QObject*)))) {
             notifier->connect(receiver, this, SLOT(onReceiverDestroyed(void*)));
         }
-        m_receivers.insert(receiver, data);
+        it = shard.receivers.insert(receiver, data);
     }
 
-    m_receivers[receiver].senders[instance]++;
+    it.value().senders[instance]++;
 }
 
-void ConnectionsStore::destroyReceiverWatch(void *instance, const Connection & c)
+void ConnectionsStore::destroyReceiverWatch(void *instance, void *receiver)
 {
-    if (--m_receivers[c.receiver].senders[instance] == 0) {
-        m_receivers[c.receiver].senders.remove(instance);
-        if (m_receivers[c.receiver].senders.isEmpty()) {
-            m_receivers[c.receiver].notifier->disconnect(c.receiver, this);
-            m_receivers.remove(c.receiver);
+    ReceiverShard & shard = receiverShard(receiver);
+    QMutexLocker l(&shard.mutex);
+
+    //the receiver may be in the middle of onReceiverDestroyed()
+    QHash<void*, ReceiverData>::iterator it = shard.receivers.find(receiver);
+    if (it == shard.receivers.end()) {
+        return;
+    }
+
+    ReceiverData & data = it.value();
+    if (--data.senders[instance] == 0) {
+        data.senders.remove(instance);
+        if (data.senders.isEmpty()) {
+            data.notifier->disconnect(receiver, this);
+            shard.receivers.erase(it);
         }
     }
 }
 
 void ConnectionsStore::onReceiverDestroyed(void *receiver)
 {
-    QMutexLocker l(&m_mutex);
-    QHashIterator<void*, int> it(m_receivers[receiver].senders);
-    while (it.hasNext()) {
-        it.next();
-        lookupAndExec(it.key(), 0, Quark(), receiver, 0, 0, &ConnectionsStore::disconnectHandler);
+    QList<void*> senders;
+    {
+        ReceiverShard & shard = receiverShard(receiver);
+        QMutexLocker l(&shard.mutex);
+        senders = shard.receivers.value(receiver).senders.keys();
+        shard.receivers.remove(receiver);
+    }
+
+    Q_FOREACH(void *instance, senders) {
+        removeConnections(instance, 0, Quark(), receiver, 0, 0, false);
     }
-    m_receivers.remove(receiver);
 }
 
 //optimization hack, to avoid making QObjectDestroyNotifier inherit
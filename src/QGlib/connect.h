@@ -47,7 +47,28 @@ enum ConnectFlag { //codegen: skip=true
      * void mySlot(const QGlib::ObjectPtr & sender, const Foo & firstArgument, ...);
      * \endcode
      */
-    PassSender = 2
+    PassSender = 2,
+    /*! If QueuedConnection is specified, the slot is not invoked from the thread
+     * that emits the signal. The arguments are copied and the slot is invoked later
+     * from the event loop of the thread that the receiver lives in, like a
+     * Qt::QueuedConnection. This is useful for signals that are emitted from
+     * GStreamer's streaming threads, since the emitter never waits for the receiver.
+     *
+     * The value returned by the slot is ignored and the signal receives the default
+     * value of its return type, so the slot should return void. Arguments are copied
+     * with their GValue copy function, so pointers that are only valid during the
+     * emission (for example plain gpointer arguments) must not be used.
+     * If the signal is disconnected, calls that are still queued are discarded.
+     */
+    QueuedConnection = 4,
+    /*! Like QueuedConnection, but at most one call is waiting in the receiver's event
+     * queue at any time. If the signal is emitted again before the slot has run, the
+     * queued call is kept and its arguments are replaced with those of the latest
+     * emission. Use this for signals that are emitted at a high rate, such as
+     * position or level updates, so that they cannot flood the event queue of the
+     * GUI thread. This flag implies QueuedConnection.
+     */
+    CoalescedConnection = 8
 };
 Q_DECLARE_FLAGS(ConnectFlags, ConnectFlag);
 Q_DECLARE_OPERATORS_FOR_FLAGS(ConnectFlags)
@@ -126,7 +147,9 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(ConnectFlags)
  * references). If your compiler does not support them, a hacky implementation using boost's
  * preprocessor, function and bind libraries will be compiled instead. That version has a
  * limit of 9 slot arguments.
- * \li This function is thread-safe.
+ * \li This function is thread-safe. With QueuedConnection or CoalescedConnection, it
+ * should be called from the thread of the \a receiver, since an object that receives the
+ * queued calls is created as its child.
  *
  * \returns whether the connection was successfully made or not
  * \sa disconnect(), ConnectFlag, \ref connect_design
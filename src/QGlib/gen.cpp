@@ -143,10 +143,9 @@ namespace QGlib {
 namespace Private {
   void registerWrapperConstructors()
   {
-    QGlib::Quark q = g_quark_from_static_string("QGlib__wrapper_constructor");
-    QGlib::GetType<ParamSpec>().setQuarkData(q, reinterpret_cast<void*>(&ParamSpec_new));
-    QGlib::GetType<Object>().setQuarkData(q, reinterpret_cast<void*>(&Object_new));
-    QGlib::GetType<Interface>().setQuarkData(q, reinterpret_cast<void*>(&Interface_new));
+    QGlib::Private::registerWrapperConstructor("GParam", &QGlib::GetType<ParamSpec>, &ParamSpec_new);
+    QGlib::Private::registerWrapperConstructor("GObject", &QGlib::GetType<Object>, &Object_new);
+    QGlib::Private::registerWrapperConstructor("GInterface", &QGlib::GetType<Interface>, &Interface_new);
   }
 } //namespace Private
 } //namespace QGlib
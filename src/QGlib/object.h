@@ -98,7 +98,7 @@ class QTGLIB_EXPORT Object : virtual public ObjectBase
  */
 class QTGLIB_EXPORT Interface : virtual public ObjectBase
 {
-    QGLIB_WRAPPER_DIFFERENT_C_CLASS(Interface, Object)
+    QGLIB_WRAPPER_DIFFERENT_C_CLASS(Interface, Object) //codegen: GTypeName=GInterface
 };
 
 
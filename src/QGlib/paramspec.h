@@ -33,7 +33,7 @@ namespace QGlib {
  */
 class QTGLIB_EXPORT ParamSpec : public RefCountedObject
 {
-    QGLIB_WRAPPER(ParamSpec)
+    QGLIB_WRAPPER(ParamSpec) //codegen: GTypeName=GParam
 public:
     enum ParamFlag { //codegen: prefix=G_PARAM_, ReadWrite=READWRITE
         Readable = 1<<0,
@@ -27,6 +27,12 @@ Quark Quark::fromString(const char *str)
     return g_quark_from_string(str);
 }
 
+//static
+Quark Quark::fromStaticString(const char *str)
+{
+    return g_quark_from_static_string(str);
+}
+
 //static
 Quark Quark::tryString(const char *str)
 {
@@ -38,4 +44,9 @@ QString Quark::toString() const
     return QString::fromUtf8(g_quark_to_string(m_quark));
 }
 
+const char *Quark::toCString() const
+{
+    return g_quark_to_string(m_quark);
+}
+
 } //namespace QGlib
@@ -48,6 +48,11 @@ public:
     static Quark fromString(const char *str);
     static inline Quark fromString(const QString & str); ///< \overload
 
+    /*! Creates a new Quark given a static string \a str. The string is not copied,
+     * so it must remain valid for the lifetime of the program (i.e. a string literal).
+     * Use this to pre-intern field or structure names that are looked up on hot paths. */
+    static Quark fromStaticString(const char *str);
+
     /*! Finds an existing Quark that corresponds to the given string \a str.
      * If the Quark is not found, an invalid quark (equal to 0) is returned. */
     static Quark tryString(const char *str);
@@ -56,6 +61,10 @@ public:
     /*! Retrieves the string that corresponds to this Quark. */
     QString toString() const;
 
+    /*! Retrieves the string that corresponds to this Quark without copying it.
+     * The returned string is owned by GLib and remains valid for the lifetime of the program. */
+    const char *toCString() const;
+
     inline operator quint32() const { return m_quark; }
 
 private:
@@ -379,4 +379,50 @@ QDebug operator<<(QDebug debug, const Value & value)
     }
 }
 
+// -- ValueView --
+
+bool ValueView::isValid() const
+{
+    return m_value && G_IS_VALUE(m_value);
+}
+
+Type ValueView::type() const
+{
+    return isValid() ? G_VALUE_TYPE(m_value) : Type::Invalid;
+}
+
+#define VALUEVIEW_GET_SPECIALIZATION(T, NICK, GTYPE) \
+    template <> \
+    T ValueView::get<T>(bool *ok) const \
+    { \
+        if (isValid() && G_VALUE_TYPE(m_value) == GTYPE) { \
+            if (ok) { \
+                *ok = true; \
+            } \
+            return g_value_get_##NICK(m_value); \
+        } \
+        return toValue().get<T>(ok); \
+    }
+
+VALUEVIEW_GET_SPECIALIZATION(bool, boolean, G_TYPE_BOOLEAN)
+VALUEVIEW_GET_SPECIALIZATION(int, int, G_TYPE_INT)
+VALUEVIEW_GET_SPECIALIZATION(uint, uint, G_TYPE_UINT)
+VALUEVIEW_GET_SPECIALIZATION(qint64, int64, G_TYPE_INT64)
+VALUEVIEW_GET_SPECIALIZATION(quint64, uint64, G_TYPE_UINT64)
+VALUEVIEW_GET_SPECIALIZATION(float, float, G_TYPE_FLOAT)
+VALUEVIEW_GET_SPECIALIZATION(double, double, G_TYPE_DOUBLE)
+
+#undef VALUEVIEW_GET_SPECIALIZATION
+
+template <>
+const char *ValueView::get<const char*>(bool *ok) const
+{
+    //there is no conversion path that could keep the string alive, so no fallback here
+    bool holdsString = isValid() && G_VALUE_HOLDS_STRING(m_value);
+    if (ok) {
+        *ok = holdsString;
+    }
+    return holdsString ? g_value_get_string(m_value) : NULL;
+}
+
 } //namespace QGlib
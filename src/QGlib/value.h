@@ -532,6 +532,52 @@ public:
 /*! \relates QGlib::Value */
 QTGLIB_EXPORT QDebug operator<<(QDebug debug, const Value & value);
 
+
+/*! \headerfile value.h <QGlib/Value>
+ * \brief Non-owning, read-only view of a GValue
+ *
+ * Unlike Value, which always holds its own copy of the GValue, a ValueView only points
+ * to a GValue that is owned by someone else (usually a GstStructure, see QGst::StructureView).
+ * It is valid only for as long as the owner of the GValue is alive and unmodified.
+ *
+ * Retrieving bool, int, uint, qint64, quint64, float, double and const char* data with get()
+ * does not allocate any memory when the held type matches exactly. Any other combination falls
+ * back to copying the data into a temporary Value and calling Value::get() on it.
+ */
+class QTGLIB_EXPORT ValueView
+{
+public:
+    inline ValueView(const GValue *gvalue = NULL) : m_value(gvalue) {}
+
+    bool isValid() const;
+    Type type() const;
+
+    template <typename T> T get(bool *ok = NULL) const;
+
+    /*! \returns a Value that holds a copy of the viewed data */
+    inline Value toValue() const { return Value(m_value); }
+
+    inline operator const GValue*() const { return m_value; }
+
+private:
+    const GValue *m_value;
+};
+
+template <typename T>
+T ValueView::get(bool *ok) const
+{
+    return toValue().get<T>(ok);
+}
+
+template <> bool ValueView::get<bool>(bool *ok) const;
+template <> int ValueView::get<int>(bool *ok) const;
+template <> uint ValueView::get<uint>(bool *ok) const;
+template <> qint64 ValueView::get<qint64>(bool *ok) const;
+template <> quint64 ValueView::get<quint64>(bool *ok) const;
+template <> float ValueView::get<float>(bool *ok) const;
+template <> double ValueView::get<double>(bool *ok) const;
+template <> const char *ValueView::get<const char*>(bool *ok) const;
+
 } //namespace QGlib
 
 QGLIB_REGISTER_TYPE(QGlib::Value)
@@ -17,26 +17,154 @@
 */
 #include "refpointer.h"
 #include "quark.h"
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDebug>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
 #include <glib-object.h>
 
 namespace QGlib {
 
-RefCountedObject *constructWrapper(Type instanceType, void *instance)
+namespace {
+
+struct PendingConstructor
+{
+    Private::TypeGetter getType;
+    Private::WrapperConstructor constructor;
+};
+
+struct PendingConstructors
+{
+    QMutex mutex;
+    QHash<GQuark, PendingConstructor> byTypeName; //keyed by the quark of the GType name
+};
+
+} //anonymous namespace
+
+Q_GLOBAL_STATIC(PendingConstructors, s_pendingConstructors)
+
+/* Number of registered constructors whose type has not been resolved yet. */
+static QAtomicInt s_pendingCount;
+
+static bool hasPendingConstructors()
+{
+#if QT_VERSION >= 0x050000
+    return s_pendingCount.loadAcquire() != 0;
+#else
+    return s_pendingCount.fetchAndAddAcquire(0) != 0;
+#endif
+}
+
+static bool traceEnabled()
+{
+    static const bool trace = !qgetenv("QTGSTREAMER_TRACE_INIT").isEmpty();
+    return trace;
+}
+
+static inline Quark constructorQuark()
 {
-    Quark q = g_quark_from_static_string("QGlib__wrapper_constructor");
-    RefCountedObject *cppClass = NULL;
+    return g_quark_from_static_string("QGlib__wrapper_constructor");
+}
 
-    for(Type t = instanceType; t.isValid(); t = t.parent()) {
+/* Stored as the constructor of a type that has been checked against the pending
+ * registrations and has none, so that the next wraps walk past it without a lookup. */
+static RefCountedObject *noWrapperConstructor(void *)
+{
+    return NULL;
+}
+
+static void setConstructor(Type type, Private::WrapperConstructor constructor)
+{
+    type.setQuarkData(constructorQuark(), reinterpret_cast<void*>(constructor));
+}
+
+/* Walks the hierarchy of \a instanceType and calls the constructor of the most
+ * derived type that has one. Returns false, without constructing anything, if it
+ * meets a type that may still have a pending registration before it finds one. */
+static bool findAndConstructWrapper(Type instanceType, void *instance, RefCountedObject **cppClass)
+{
+    const Quark q = constructorQuark();
+    const bool pending = hasPendingConstructors();
+    *cppClass = NULL;
+
+    for (Type t = instanceType; t.isValid(); t = t.parent()) {
         void *funcPtr = t.quarkData(q);
-        if (funcPtr) {
-            cppClass = (reinterpret_cast<RefCountedObject *(*)(void*)>(funcPtr))(instance);
-            Q_ASSERT_X(cppClass, "QGlib::constructWrapper",
+        if (!funcPtr) {
+            if (pending) {
+                return false;
+            }
+        } else if (funcPtr != reinterpret_cast<void*>(&noWrapperConstructor)) {
+            *cppClass = (reinterpret_cast<RefCountedObject *(*)(void*)>(funcPtr))(instance);
+            Q_ASSERT_X(*cppClass, "QGlib::constructWrapper",
                        "Failed to wrap instance. This is a bug in the bindings library.");
-            return cppClass;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+/* Resolves the pending constructors registered for \a instanceType and its ancestors
+ * and marks the rest of the hierarchy as checked. Registrations for types outside
+ * this hierarchy are left pending. If the hierarchy has no constructor at all, which
+ * means that the GType name given at registration did not match the one of the type
+ * that the getter returns, every pending constructor is resolved, so that such a
+ * constructor is not lost. */
+static void resolvePendingConstructors(Type instanceType)
+{
+    PendingConstructors *pending = s_pendingConstructors();
+    QMutexLocker locker(&pending->mutex);
+
+    const gint64 start = traceEnabled() ? g_get_monotonic_time() : 0;
+    const Quark q = constructorQuark();
+    int count = 0;
+    bool found = false;
+
+    for (Type t = instanceType; t.isValid(); t = t.parent()) {
+        void *funcPtr = t.quarkData(q);
+        if (funcPtr) {
+            found = found || funcPtr != reinterpret_cast<void*>(&noWrapperConstructor);
+            continue;
+        }
+
+        QHash<GQuark, PendingConstructor>::iterator it =
+            pending->byTypeName.find(g_quark_try_string(g_type_name(t)));
+        if (it != pending->byTypeName.end()) {
+            setConstructor(it->getType(), it->constructor);
+            pending->byTypeName.erase(it);
+            ++count;
+            found = true;
+        } else {
+            setConstructor(t, &noWrapperConstructor);
+        }
+    }
+
+    if (!found) {
+        QHash<GQuark, PendingConstructor>::const_iterator it;
+        for (it = pending->byTypeName.constBegin(); it != pending->byTypeName.constEnd(); ++it) {
+            setConstructor(it->getType(), it->constructor);
+            ++count;
         }
+        pending->byTypeName.clear();
+    }
+
+    s_pendingCount.fetchAndStoreRelease(pending->byTypeName.size());
+    if (traceEnabled() && count > 0) {
+        qDebug() << "QtGStreamer: resolved" << count << "wrapper constructors in"
+                 << (g_get_monotonic_time() - start) << "us,"
+                 << pending->byTypeName.size() << "still pending";
     }
+}
 
-    Q_ASSERT_X(false, "QGlib::constructWrapper",
+RefCountedObject *constructWrapper(Type instanceType, void *instance)
+{
+    RefCountedObject *cppClass;
+    if (!findAndConstructWrapper(instanceType, instance, &cppClass)) {
+        resolvePendingConstructors(instanceType);
+        findAndConstructWrapper(instanceType, instance, &cppClass);
+    }
+
+    Q_ASSERT_X(cppClass, "QGlib::constructWrapper",
                QString(QLatin1String("No wrapper constructor found for this type (") +
                        instanceType.name() + QLatin1String("). Did you forget to call init()?.")).toUtf8());
     return cppClass;
@@ -44,6 +172,24 @@ RefCountedObject *constructWrapper(Type instanceType, void *instance)
 
 namespace Private {
 
+void registerWrapperConstructor(const char *typeName, TypeGetter getType,
+                                WrapperConstructor constructor)
+{
+    PendingConstructors *pending = s_pendingConstructors();
+    QMutexLocker locker(&pending->mutex);
+
+    //a type that already exists may have been marked as having no constructor
+    //by an earlier wrap, so it is resolved right away; this does not register it
+    if (g_type_from_name(typeName)) {
+        setConstructor(getType(), constructor);
+        return;
+    }
+
+    PendingConstructor c = { getType, constructor };
+    pending->byTypeName.insert(g_quark_from_static_string(typeName), c);
+    s_pendingCount.fetchAndStoreRelease(pending->byTypeName.size());
+}
+
 static void qdataDestroyNotify(void *cppInstance)
 {
     delete static_cast<RefCountedObject*>(cppInstance);
@@ -65,6 +65,18 @@ struct WrapImpl {};
 
 namespace Private {
 
+typedef RefCountedObject *(*WrapperConstructor)(void *instance);
+typedef Type (*TypeGetter)();
+
+/* Registers \a constructor as the wrapper constructor for the type returned
+ * by \a getType, whose GType name is \a typeName (a static string). Unless that
+ * type is already registered, the type getter is not called here; the registration
+ * is resolved the first time constructWrapper() runs for that type or one of its
+ * subtypes, so that init() does not force the registration of every wrapped GType.
+ * This is called by the generated code. */
+QTGLIB_EXPORT void registerWrapperConstructor(const char *typeName, TypeGetter getType,
+                                              WrapperConstructor constructor);
+
 QTGLIB_EXPORT RefCountedObject *wrapObject(void *gobject);
 QTGLIB_EXPORT RefCountedObject *wrapParamSpec(void *param);
 QTGLIB_EXPORT RefCountedObject *wrapInterface(Type interfaceType, void *gobject);
@@ -0,0 +1,412 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "asyncstatechange.h"
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+struct QTGSTREAMERUTILS_NO_EXPORT AsyncStateChange::Priv
+{
+    /* The state change of one element. It is referenced by the Priv, by the
+     * worker and by the bus and clock callbacks, which may outlive the Priv. */
+    struct Transition
+    {
+        Transition(Priv *d, int index, const ElementPtr & element, State state)
+            : d(d), index(index), element(element), state(state),
+              start(g_get_monotonic_time()), bus(NULL), handlerId(0), timeoutId(NULL),
+              done(0), refCount(1) {}
+
+        void ref() { refCount.ref(); }
+
+        void unref()
+        {
+            if (!refCount.deref()) {
+                delete this;
+            }
+        }
+
+        /* Only the caller that gets true may complete the transition */
+        bool tryFinish() { return done.testAndSetOrdered(0, 1); }
+
+        Priv *const d;
+        const int index;
+        const ElementPtr element;
+        const State state;
+        const gint64 start;
+
+        //protected by Priv::mutex
+        GstBus *bus;
+        gulong handlerId;
+        GstClockID timeoutId;
+
+        QAtomicInt done;
+        QAtomicInt refCount;
+    };
+
+    /* Calls setState() on QThreadPool::globalInstance() */
+    struct Worker : public QRunnable
+    {
+        Worker(Transition *t) : t(t) { t->ref(); }
+        virtual ~Worker() { t->unref(); }
+        virtual void run();
+        Transition *const t;
+    };
+
+    Priv(AsyncStateChange *q) : q(q), timeout(ClockTime::None), busy(false), pending(0) {}
+
+    void watch(Transition *t);
+    void complete(Transition *t, Status status, const QGlib::Error & error = QGlib::Error());
+
+    static void syncMessage(GstBus *bus, GstMessage *message, gpointer data);
+    static gboolean timeoutCallback(GstClock *clock, GstClockTime time, GstClockID id, gpointer data);
+    static void unrefTransition(gpointer data);
+    static void unrefTransitionClosure(gpointer data, GClosure *closure);
+
+    AsyncStateChange *const q;
+    mutable QMutex mutex;
+    mutable QWaitCondition condition;
+    ClockTime timeout;
+    bool busy;
+    int pending;
+    QList<Transition*> transitions;
+    QList<Report> reports;
+};
+
+void AsyncStateChange::Priv::Worker::run()
+{
+    switch (t->element->setState(t->state)) {
+    case StateChangeSuccess:
+    case StateChangeNoPreroll:
+        if (t->tryFinish()) {
+            t->d->complete(t, Succeeded);
+        }
+        break;
+    case StateChangeFailure:
+        if (t->tryFinish()) {
+            t->d->complete(t, Failed);
+        }
+        break;
+    default:
+        //StateChangeAsync; the bus tells when it completes
+        break;
+    }
+}
+
+void AsyncStateChange::Priv::watch(Transition *t)
+{
+    //called with the mutex held, before setState()
+
+    //the messages of an element inside a bin only reach the bus of the top-level bin
+    GstObject *top = GST_OBJECT(gst_object_ref(static_cast<GstElement*>(t->element)));
+    while (GstObject *parent = gst_object_get_parent(top)) {
+        gst_object_unref(top);
+        top = parent;
+    }
+    if (GST_IS_ELEMENT(top)) {
+        t->bus = gst_element_get_bus(GST_ELEMENT(top));
+    }
+    gst_object_unref(top);
+
+    if (t->bus) {
+        gst_bus_enable_sync_message_emission(t->bus);
+        t->ref();
+        t->handlerId = g_signal_connect_data(t->bus, "sync-message", G_CALLBACK(&Priv::syncMessage),
+                                             t, &Priv::unrefTransitionClosure, GConnectFlags(0));
+    }
+
+    if (timeout.isValid()) {
+        GstClock *clock = gst_system_clock_obtain();
+        t->timeoutId = gst_clock_new_single_shot_id(clock, gst_clock_get_time(clock) + timeout);
+        t->ref();
+        gst_clock_id_wait_async(t->timeoutId, &Priv::timeoutCallback, t, &Priv::unrefTransition);
+        gst_object_unref(clock);
+    }
+}
+
+void AsyncStateChange::Priv::complete(Transition *t, Status status, const QGlib::Error & error)
+{
+    //called once per transition, by the caller that won tryFinish()
+    QMutexLocker locker(&mutex);
+    GstBus *bus = t->bus;
+    gulong handlerId = t->handlerId;
+    GstClockID timeoutId = t->timeoutId;
+    t->bus = NULL;
+    t->timeoutId = NULL;
+
+    Report & stored = reports[t->index];
+    stored.status = status;
+    stored.elapsed = ClockTime::fromUSecs(g_get_monotonic_time() - t->start);
+    stored.error = error;
+    Report report = stored;
+    locker.unlock();
+
+    if (bus) {
+        g_signal_handler_disconnect(bus, handlerId);
+        gst_bus_disable_sync_message_emission(bus);
+        gst_object_unref(bus);
+    }
+    if (timeoutId) {
+        gst_clock_id_unschedule(timeoutId);
+        gst_clock_id_unref(timeoutId);
+    }
+
+    q->elementFinished(report);
+
+    locker.relock();
+    bool last = --pending == 0;
+    locker.unlock();
+
+    if (last) {
+        q->finished();
+
+        locker.relock();
+        busy = false;
+        condition.wakeAll();
+    }
+}
+
+//static
+void AsyncStateChange::Priv::syncMessage(GstBus *bus, GstMessage *message, gpointer data)
+{
+    Q_UNUSED(bus);
+    Transition *t = static_cast<Transition*>(data);
+    GstObject *element = GST_OBJECT(static_cast<GstElement*>(t->element));
+    GstObject *source = GST_MESSAGE_SRC(message);
+
+    switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_STATE_CHANGED:
+        if (source == element) {
+            GstState newState, pendingState;
+            gst_message_parse_state_changed(message, NULL, &newState, &pendingState);
+            if (newState == static_cast<GstState>(t->state)
+                    && pendingState == GST_STATE_VOID_PENDING && t->tryFinish()) {
+                t->d->complete(t, Succeeded);
+            }
+        }
+        break;
+    case GST_MESSAGE_ERROR:
+        if (source && (source == element || gst_object_has_ancestor(source, element))
+                && t->tryFinish()) {
+            GError *error = NULL;
+            gst_message_parse_error(message, &error, NULL);
+            t->d->complete(t, Failed, QGlib::Error(error));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+//static
+gboolean AsyncStateChange::Priv::timeoutCallback(GstClock *clock, GstClockTime time,
+                                                 GstClockID id, gpointer data)
+{
+    Q_UNUSED(clock);
+    Q_UNUSED(time);
+    Q_UNUSED(id);
+    Transition *t = static_cast<Transition*>(data);
+    if (t->tryFinish()) {
+        t->d->complete(t, TimedOut);
+    }
+    return TRUE;
+}
+
+//static
+void AsyncStateChange::Priv::unrefTransition(gpointer data)
+{
+    static_cast<Transition*>(data)->unref();
+}
+
+//static
+void AsyncStateChange::Priv::unrefTransitionClosure(gpointer data, GClosure *closure)
+{
+    Q_UNUSED(closure);
+    static_cast<Transition*>(data)->unref();
+}
+
+#endif //DOXYGEN_RUN
+
+
+AsyncStateChange::AsyncStateChange()
+    : d(new Priv(this))
+{
+}
+
+AsyncStateChange::~AsyncStateChange()
+{
+    cancel();
+    waitForFinished();
+    Q_FOREACH(Priv::Transition *t, d->transitions) {
+        t->unref();
+    }
+    delete d;
+}
+
+ClockTime AsyncStateChange::timeout() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->timeout;
+}
+
+void AsyncStateChange::setTimeout(ClockTime timeout)
+{
+    QMutexLocker locker(&d->mutex);
+    d->timeout = timeout;
+}
+
+bool AsyncStateChange::start(const ElementPtr & element, State state)
+{
+    return start(QList<ElementPtr>() << element, state);
+}
+
+bool AsyncStateChange::start(const QList<ElementPtr> & elements, State state)
+{
+    if (elements.isEmpty()) {
+        return false;
+    }
+    Q_FOREACH(const ElementPtr & element, elements) {
+        if (!element) {
+            return false;
+        }
+    }
+
+    QMutexLocker locker(&d->mutex);
+    if (d->busy) {
+        return false;
+    }
+
+    Q_FOREACH(Priv::Transition *t, d->transitions) {
+        t->unref();
+    }
+    d->transitions.clear();
+    d->reports.clear();
+    d->busy = true;
+    d->pending = elements.size();
+
+    for (int i = 0; i < elements.size(); ++i) {
+        Report report;
+        report.element = elements.at(i);
+        report.state = state;
+        report.status = Pending;
+        report.elapsed = ClockTime::None;
+        d->reports.append(report);
+
+        Priv::Transition *t = new Priv::Transition(d, i, elements.at(i), state);
+        d->transitions.append(t);
+        d->watch(t);
+    }
+
+    //the workers may complete the transitions, which takes the mutex
+    QList<Priv::Transition*> transitions = d->transitions;
+    locker.unlock();
+
+    Q_FOREACH(Priv::Transition *t, transitions) {
+        QThreadPool::globalInstance()->start(new Priv::Worker(t));
+    }
+    return true;
+}
+
+void AsyncStateChange::cancel()
+{
+    QMutexLocker locker(&d->mutex);
+    QList<Priv::Transition*> transitions = d->transitions;
+    Q_FOREACH(Priv::Transition *t, transitions) {
+        t->ref();
+    }
+    locker.unlock();
+
+    Q_FOREACH(Priv::Transition *t, transitions) {
+        if (t->tryFinish()) {
+            d->complete(t, Cancelled);
+        }
+        t->unref();
+    }
+}
+
+bool AsyncStateChange::isBusy() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->busy;
+}
+
+bool AsyncStateChange::waitForFinished(ClockTime timeout) const
+{
+    QMutexLocker locker(&d->mutex);
+    if (!timeout.isValid()) {
+        while (d->busy) {
+            d->condition.wait(&d->mutex);
+        }
+        return true;
+    }
+
+    const gint64 deadline = g_get_monotonic_time() + gint64(timeout / 1000);
+    while (d->busy) {
+        gint64 remaining = deadline - g_get_monotonic_time();
+        if (remaining <= 0) {
+            return false;
+        }
+        d->condition.wait(&d->mutex, static_cast<unsigned long>((remaining + 999) / 1000));
+    }
+    return true;
+}
+
+AsyncStateChange::Status AsyncStateChange::status() const
+{
+    //busy is only cleared after finished() returns, but the
+    //result is already final when it is called
+    QMutexLocker locker(&d->mutex);
+    if (d->pending > 0) {
+        return Pending;
+    }
+
+    Status result = Succeeded;
+    Q_FOREACH(const Report & report, d->reports) {
+        if (report.status == Failed) {
+            return Failed;
+        } else if (report.status == TimedOut) {
+            result = TimedOut;
+        } else if (report.status == Cancelled && result != TimedOut) {
+            result = Cancelled;
+        }
+    }
+    return result;
+}
+
+QList<AsyncStateChange::Report> AsyncStateChange::reports() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->reports;
+}
+
+void AsyncStateChange::elementFinished(const Report & report)
+{
+    Q_UNUSED(report);
+}
+
+void AsyncStateChange::finished()
+{
+}
+
+} //namespace Utils
+} //namespace QGst
@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_ASYNCSTATECHANGE_H
+#define QGST_UTILS_ASYNCSTATECHANGE_H
+
+#include "global.h"
+#include "../element.h"
+#include "../clocktime.h"
+#include "../../QGlib/error.h"
+#include <QtCore/QList>
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile asyncstatechange.h <QGst/Utils/AsyncStateChange>
+ * \brief Helper class for changing the state of elements without blocking
+ *
+ * Element::setState() returns StateChangeAsync for most transitions of a pipeline,
+ * and the transition only completes once the sinks have prerolled. Waiting for it
+ * with Element::getState() blocks the calling thread, which is not acceptable in a
+ * GUI thread, where a network source can take a long time to preroll. Some elements
+ * even block in setState() itself, while they open a device or a connection.
+ *
+ * AsyncStateChange calls setState() on a thread of QThreadPool::globalInstance()
+ * and reports when each element has reached the requested state, when its state
+ * change has failed (because setState() returned StateChangeFailure or because
+ * the element or one of its children posted an error message), or when timeout()
+ * has elapsed. The functions that start a state change return immediately.
+ *
+ * A batch of elements, for example several pipelines that should start together,
+ * may be given to start(). Their state changes run concurrently and finished() is
+ * called once all of them are complete.
+ *
+ * elementFinished() and finished() are called from the thread that completed the
+ * state change: a thread of the pool, a streaming thread that posted the message,
+ * a clock thread for timeouts, or the thread that called cancel(). To be notified
+ * in a Qt thread, forward the notification with a queued invocation:
+ *
+ * \code
+ * class PlayerStarter : public QGst::Utils::AsyncStateChange
+ * {
+ * public:
+ *     explicit PlayerStarter(Player *player) : m_player(player) {}
+ *     virtual ~PlayerStarter() { cancel(); }
+ *
+ * protected:
+ *     virtual void finished()
+ *     {
+ *         QMetaObject::invokeMethod(m_player, "onStarted", Qt::QueuedConnection,
+ *                                   Q_ARG(bool, status() == Succeeded));
+ *     }
+ *
+ * private:
+ *     Player *m_player;
+ * };
+ *
+ * m_starter->setTimeout(QGst::ClockTime::fromSeconds(5));
+ * m_starter->start(m_pipeline, QGst::StatePlaying);
+ * \endcode
+ *
+ * \note Completion is detected through the sync messages of the element's bus, as
+ * with TaskPool. An element that is not in a bin and has no bus of its own can only
+ * complete through the return value of setState() or the timeout. A timeout or
+ * cancel() does not abort the state change of the element; it may still reach the
+ * requested state later.
+ * \note A subclass that reimplements the notification functions must call cancel()
+ * in its destructor, since they may otherwise be called while it is being destroyed.
+ */
+class QTGSTREAMERUTILS_EXPORT AsyncStateChange
+{
+public:
+    /*! The outcome of the state change of an element */
+    enum Status {
+        /*! The state change is still in progress */
+        Pending,
+        /*! The element has reached the requested state */
+        Succeeded,
+        /*! setState() returned StateChangeFailure or an error message was posted */
+        Failed,
+        /*! The element did not reach the requested state within timeout() */
+        TimedOut,
+        /*! cancel() was called before the element reached the requested state */
+        Cancelled
+    };
+
+    struct Report
+    {
+        ElementPtr element;
+        /*! The requested state */
+        State state;
+        Status status;
+        /*! The time from start() until the state change completed */
+        ClockTime elapsed;
+        /*! The error of the error message that made the state change fail, if any */
+        QGlib::Error error;
+    };
+
+    AsyncStateChange();
+    /*! Cancels the state changes that are in progress */
+    virtual ~AsyncStateChange();
+
+    /*! \returns how long to wait for each element to reach the requested state.
+     * The default is ClockTime::None, which waits forever. */
+    ClockTime timeout() const;
+    /*! Sets the timeout of the state changes started after this call */
+    void setTimeout(ClockTime timeout);
+
+    /*! Sets \a element to \a state without blocking.
+     * \returns false if a state change is already in progress */
+    bool start(const ElementPtr & element, State state);
+
+    /*! Sets all the \a elements to \a state concurrently, without blocking.
+     * \returns false if a state change is already in progress or \a elements is empty */
+    bool start(const QList<ElementPtr> & elements, State state);
+
+    /*! Stops waiting for the elements that have not reached their state yet and
+     * reports them as Cancelled */
+    void cancel();
+
+    /*! \returns whether a state change is in progress */
+    bool isBusy() const;
+
+    /*! Blocks until all the state changes have completed or \a timeout has elapsed.
+     * \returns whether no state change is in progress */
+    bool waitForFinished(ClockTime timeout = ClockTime::None) const;
+
+    /*! \returns Pending while a state change is in progress. Afterwards, returns
+     * Succeeded if all the elements have reached their state, otherwise Failed,
+     * TimedOut or Cancelled, in this order of precedence. */
+    Status status() const;
+
+    /*! \returns the reports of the elements of the last call to start(), in the
+     * order in which they were given. The status of the elements that are still
+     * changing state is Pending. */
+    QList<Report> reports() const;
+
+protected:
+    /*! Called when the state change of an element has completed, in any way.
+     * The default implementation does nothing. */
+    virtual void elementFinished(const Report & report);
+
+    /*! Called once the state changes of all the elements have completed, after the
+     * last call to elementFinished(). status() and reports() already return the final
+     * results, while isBusy() still returns true until this function has returned.
+     * The default implementation does nothing. */
+    virtual void finished();
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(AsyncStateChange)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_ASYNCSTATECHANGE_H
@@ -0,0 +1,355 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "audiosink.h"
+#include "../caps.h"
+#include <QtCore/QMutex>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+#include <gst/gst.h>
+#include <cstring>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+# define QGST_AUDIO_NE(f) #f "LE"
+#else
+# define QGST_AUDIO_NE(f) #f "BE"
+#endif
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+enum SampleFormat {
+    FormatUnknown,
+    FormatS16,
+    FormatS32,
+    FormatF32
+};
+
+/* Converts count interleaved samples to float. These loops are the hot path,
+ * so they convert eight samples per iteration where SSE2 is available. */
+void convertS16(const qint16 *src, float *dst, int count)
+{
+    const float scale = 1.0f / 32768.0f;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        //duplicate each sample into a 32-bit lane and shift it back down to sign-extend it
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+void convertS32(const qint32 *src, float *dst, int count)
+{
+    const float scale = 1.0f / 2147483648.0f;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(s0), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(s1), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+/* Copies frames interleaved frames from src to the planes, starting at offset. */
+void deinterleave(const float *src, float * const *planes, int channels, int offset, int frames)
+{
+    if (channels == 1) {
+        std::memcpy(planes[0] + offset, src, frames * sizeof(float));
+        return;
+    }
+
+    int i = 0;
+#ifdef __SSE2__
+    if (channels == 2) {
+        float *left = planes[0] + offset;
+        float *right = planes[1] + offset;
+        for (; i + 4 <= frames; i += 4) {
+            __m128 a = _mm_loadu_ps(src + 2 * i);     //l0 r0 l1 r1
+            __m128 b = _mm_loadu_ps(src + 2 * i + 4); //l2 r2 l3 r3
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    }
+#endif
+    for (int c = 0; c < channels; c++) {
+        float *dst = planes[c] + offset;
+        for (int j = i; j < frames; j++) {
+            dst[j] = src[j * channels + c];
+        }
+    }
+}
+
+} //anonymous namespace
+
+struct QTGSTREAMERUTILS_NO_EXPORT AudioSink::Priv
+{
+public:
+    Priv()
+        : blockSize(1024), format(FormatUnknown), channels(0), rate(0), filled(0),
+          blockTimestamp(GST_CLOCK_TIME_NONE) {}
+
+    bool setCaps(GstCaps *caps);
+    void reset();
+    void updatePlanes();
+    FlowReturn process(AudioSink *self, GstBuffer *buffer, QMutexLocker *locker);
+    FlowReturn deliver(AudioSink *self, int samples, QMutexLocker *locker);
+
+    mutable QMutex mutex;
+    int blockSize;
+    SampleFormat format;
+    int channels;
+    int rate;
+
+    QVector<float> block;   //planar, channels * blockSize
+    QVector<float> scratch; //interleaved, channels * blockSize
+    QVarLengthArray<float*, 8> planes;
+    QVector<float> delivered; //the complete block while newBlock() runs
+    QVarLengthArray<const float*, 8> deliveredPlanes;
+    int filled;
+    GstClockTime blockTimestamp;
+};
+
+bool AudioSink::Priv::setCaps(GstCaps *caps)
+{
+    GstStructure *s = caps ? gst_caps_get_structure(caps, 0) : NULL;
+    if (!s) {
+        return false;
+    }
+
+    const gchar *formatName = gst_structure_get_string(s, "format");
+    SampleFormat newFormat = FormatUnknown;
+    if (formatName) {
+        if (std::strcmp(formatName, QGST_AUDIO_NE(S16)) == 0) {
+            newFormat = FormatS16;
+        } else if (std::strcmp(formatName, QGST_AUDIO_NE(S32)) == 0) {
+            newFormat = FormatS32;
+        } else if (std::strcmp(formatName, QGST_AUDIO_NE(F32)) == 0) {
+            newFormat = FormatF32;
+        }
+    }
+
+    int newChannels = 0, newRate = 0;
+    if (newFormat == FormatUnknown
+        || !gst_structure_get_int(s, "channels", &newChannels) || newChannels < 1
+        || !gst_structure_get_int(s, "rate", &newRate) || newRate < 1) {
+        return false;
+    }
+
+    if (newFormat != format || newChannels != channels || newRate != rate) {
+        format = newFormat;
+        channels = newChannels;
+        rate = newRate;
+        reset();
+    }
+    return true;
+}
+
+void AudioSink::Priv::reset()
+{
+    block.resize(channels * blockSize);
+    scratch.resize(channels * blockSize);
+    updatePlanes();
+    filled = 0;
+}
+
+void AudioSink::Priv::updatePlanes()
+{
+    planes.resize(channels);
+    for (int c = 0; c < channels; c++) {
+        planes[c] = block.data() + c * blockSize;
+    }
+}
+
+FlowReturn AudioSink::Priv::process(AudioSink *self, GstBuffer *buffer, QMutexLocker *locker)
+{
+    GstMapInfo info;
+    if (!gst_buffer_map(buffer, &info, GST_MAP_READ)) {
+        return FlowError;
+    }
+
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT)) {
+        filled = 0;
+    }
+
+    const int sampleBytes = (format == FormatS16) ? 2 : 4;
+    const int frameBytes = sampleBytes * channels;
+    const int frames = static_cast<int>(info.size / frameBytes);
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    FlowReturn flow = FlowOk;
+
+    for (int offset = 0; offset < frames && flow == FlowOk; ) {
+        if (filled == 0) {
+            blockTimestamp = GST_CLOCK_TIME_IS_VALID(pts) ?
+                pts + gst_util_uint64_scale_int(offset, GST_SECOND, rate) : GST_CLOCK_TIME_NONE;
+        }
+
+        const int n = qMin(frames - offset, blockSize - filled);
+        const guint8 *src = info.data + offset * frameBytes;
+        const float *interleaved = scratch.constData();
+
+        switch (format) {
+        case FormatS16:
+            convertS16(reinterpret_cast<const qint16*>(src), scratch.data(), n * channels);
+            break;
+        case FormatS32:
+            convertS32(reinterpret_cast<const qint32*>(src), scratch.data(), n * channels);
+            break;
+        default:
+            interleaved = reinterpret_cast<const float*>(src);
+            break;
+        }
+        deinterleave(interleaved, planes.data(), channels, filled, n);
+
+        filled += n;
+        offset += n;
+        if (filled == blockSize) {
+            flow = deliver(self, blockSize, locker);
+        }
+    }
+
+    gst_buffer_unmap(buffer, &info);
+    return flow;
+}
+
+FlowReturn AudioSink::Priv::deliver(AudioSink *self, int samples, QMutexLocker *locker)
+{
+    //move the complete block out, so that newBlock() runs without the lock and
+    //may call blockSize(), channels(), rate() or even setBlockSize()
+    qSwap(block, delivered);
+    const int blockChannels = channels;
+    const GstClockTime timestamp = blockTimestamp;
+    deliveredPlanes.resize(blockChannels);
+    for (int c = 0; c < blockChannels; c++) {
+        deliveredPlanes[c] = delivered.constData() + c * blockSize;
+    }
+    block.resize(delivered.size());
+    updatePlanes();
+    filled = 0;
+
+    locker->unlock();
+    FlowReturn flow = self->newBlock(deliveredPlanes.constData(), blockChannels, samples, timestamp);
+    locker->relock();
+    return flow;
+}
+
+#endif //DOXYGEN_RUN
+
+
+AudioSink::AudioSink()
+    : ApplicationSink(), d(new Priv)
+{
+    setCaps(Caps::fromString("audio/x-raw, "
+        "format = (string) { " QGST_AUDIO_NE(F32) ", " QGST_AUDIO_NE(S32) ", "
+                                QGST_AUDIO_NE(S16) " }, "
+        "layout = (string) interleaved"));
+}
+
+AudioSink::~AudioSink()
+{
+    delete d;
+}
+
+int AudioSink::blockSize() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->blockSize;
+}
+
+void AudioSink::setBlockSize(int samples)
+{
+    QMutexLocker lock(&d->mutex);
+    if (samples > 0 && samples != d->blockSize) {
+        d->blockSize = samples;
+        d->reset();
+    }
+}
+
+int AudioSink::channels() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->channels;
+}
+
+int AudioSink::rate() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->rate;
+}
+
+FlowReturn AudioSink::newBlock(const float * const *data, int channels, int samples,
+                               ClockTime timestamp)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(channels);
+    Q_UNUSED(samples);
+    Q_UNUSED(timestamp);
+    return FlowOk;
+}
+
+void AudioSink::eos()
+{
+    QMutexLocker lock(&d->mutex);
+    if (d->filled > 0) {
+        const int samples = d->filled;
+        for (int c = 0; c < d->channels; c++) {
+            std::memset(d->planes[c] + samples, 0, (d->blockSize - samples) * sizeof(float));
+        }
+        d->deliver(this, samples, &lock);
+    }
+}
+
+FlowReturn AudioSink::newSample()
+{
+    SamplePtr sample = pullSample();
+    if (!sample) {
+        return FlowFlushing;
+    }
+
+    GstSample *s = sample;
+    QMutexLocker lock(&d->mutex);
+    if (!d->setCaps(gst_sample_get_caps(s))) {
+        return FlowNotNegotiated;
+    }
+
+    GstBuffer *buffer = gst_sample_get_buffer(s);
+    return buffer ? d->process(this, buffer, &lock) : FlowOk;
+}
+
+} //namespace Utils
+} //namespace QGst
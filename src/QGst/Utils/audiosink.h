@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_AUDIOSINK_H
+#define QGST_UTILS_AUDIOSINK_H
+
+#include "applicationsink.h"
+#include "../clocktime.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile audiosink.h <QGst/Utils/AudioSink>
+ * \brief Helper class for analysing raw audio in fixed-size blocks
+ *
+ * AudioSink is an ApplicationSink that accepts interleaved S16, S32 and F32 audio in the
+ * native byte order and hands it to the application in blocks of blockSize() samples per
+ * channel, converted to planar 32-bit float in the range [-1.0, 1.0]. This is the layout
+ * that most analysis code (FFTs, level meters, feature extractors) expects.
+ *
+ * Block boundaries do not depend on the size of the buffers that arrive from upstream;
+ * samples that do not fill a whole block are carried over to the next buffer. Each block
+ * is timestamped with the time of its first sample, extrapolated from the timestamp of the
+ * buffer it started in. Buffers that are marked as discontinuous, for example after a
+ * seek, and format changes discard the samples that were carried over.
+ *
+ * The integer to float conversion and the deinterleaving use SSE when the library is
+ * built for a CPU that supports it.
+ *
+ * The appsink that is created by default is set up to accept these formats. An appsink
+ * that is passed to setElement() must be restricted to them, for example with setCaps().
+ *
+ * Reimplement newBlock() to receive the blocks. It is called from the streaming thread.
+ * \note Subclasses that reimplement eos() must call AudioSink::eos(), which delivers the
+ * last, incomplete block.
+ */
+class QTGSTREAMERUTILS_EXPORT AudioSink : public ApplicationSink
+{
+public:
+    AudioSink();
+    virtual ~AudioSink();
+
+    /*! \returns the number of samples per channel in each block. The default is 1024. */
+    int blockSize() const;
+
+    /*! Sets the number of samples per channel in each block. Samples that have been
+     * carried over with the old block size are discarded. */
+    void setBlockSize(int samples);
+
+    /*! \returns the number of channels of the current stream, or 0 if it is not known yet */
+    int channels() const;
+
+    /*! \returns the sample rate of the current stream, or 0 if it is not known yet */
+    int rate() const;
+
+protected:
+    /*! Called for every complete block. \a data holds one array of blockSize() samples for
+     * each of the \a channels channels. \a samples is the number of valid samples in each
+     * array, which is equal to blockSize() except for the last block before end-of-stream,
+     * where the remaining samples are zero. \a timestamp is the time of the first sample,
+     * or ClockTime::None if upstream did not timestamp its buffers.
+     *
+     * The arrays are only valid until this function returns. Returning anything other than
+     * FlowOk stops the stream with that flow return.
+     * \note This function is called from the steaming thread. */
+    virtual FlowReturn newBlock(const float * const *data, int channels, int samples,
+                                ClockTime timestamp);
+
+    virtual void eos();
+    virtual FlowReturn newSample();
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(AudioSink)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_AUDIOSINK_H
@@ -0,0 +1,397 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "framegrabber.h"
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+//the byte order of QImage::Format_RGB32
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+# define FRAMEGRABBER_FORMAT "BGRx"
+#else
+# define FRAMEGRABBER_FORMAT "xRGB"
+#endif
+
+//GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_NATIVE_VIDEO from playbin;
+//we do our own scaling and conversion and we do not need audio
+static const guint PLAYBIN_FLAGS = 0x01 | 0x40;
+
+struct QTGSTREAMERUTILS_NO_EXPORT FrameGrabber::Priv
+{
+    struct DecodePipeline
+    {
+        GstElement *playbin;
+        GstElement *capsfilter;
+        GstElement *appsink;
+        int width;
+    };
+
+    struct Job : public QRunnable
+    {
+        Job(FrameGrabber *self, const QString & uri, int count, QAtomicInt *total)
+            : self(self), uri(uri), count(count), total(total) {}
+        virtual void run();
+
+        FrameGrabber *self;
+        QString uri;
+        int count;
+        QAtomicInt *total;
+    };
+
+    Priv();
+
+    QMutex mutex;
+    QWaitCondition pipelineReleased;
+    QList<DecodePipeline*> idle;
+    int liveCount;
+    int createdCount;
+    int maximumPipelines;
+    int width;
+    int timeout;
+
+    DecodePipeline *acquire();
+    void release(DecodePipeline *pipeline);
+    DecodePipeline *createPipeline();
+    void destroyPipeline(DecodePipeline *pipeline);
+    void setWidth(DecodePipeline *pipeline, int width);
+
+    bool waitForPreroll(DecodePipeline *pipeline);
+    bool open(DecodePipeline *pipeline, const QString & uri);
+    void close(DecodePipeline *pipeline);
+    QList<SamplePtr> grab(const QString & uri, const QList<ClockTime> *positions, int count);
+};
+
+FrameGrabber::Priv::Priv()
+    : liveCount(0), createdCount(0), maximumPipelines(QThread::idealThreadCount()),
+      width(160), timeout(5000)
+{
+    if (maximumPipelines < 1) {
+        maximumPipelines = 1;
+    }
+}
+
+FrameGrabber::Priv::DecodePipeline *FrameGrabber::Priv::acquire()
+{
+    QMutexLocker lock(&mutex);
+    while (idle.isEmpty() && liveCount >= maximumPipelines) {
+        pipelineReleased.wait(&mutex);
+    }
+
+    if (!idle.isEmpty()) {
+        return idle.takeLast();
+    }
+
+    liveCount++;
+    lock.unlock();
+
+    DecodePipeline *pipeline = createPipeline();
+    if (!pipeline) {
+        lock.relock();
+        liveCount--;
+        pipelineReleased.wakeOne();
+    }
+    return pipeline;
+}
+
+void FrameGrabber::Priv::release(DecodePipeline *pipeline)
+{
+    QMutexLocker lock(&mutex);
+    if (liveCount > maximumPipelines) {
+        liveCount--;
+        lock.unlock();
+        destroyPipeline(pipeline);
+        return;
+    }
+
+    idle.append(pipeline);
+    pipelineReleased.wakeOne();
+}
+
+FrameGrabber::Priv::DecodePipeline *FrameGrabber::Priv::createPipeline()
+{
+    GstElement *playbin = gst_element_factory_make("playbin", NULL);
+    GstElement *videoscale = gst_element_factory_make("videoscale", NULL);
+    GstElement *capsfilter = gst_element_factory_make("capsfilter", NULL);
+    GstElement *videoconvert = gst_element_factory_make("videoconvert", NULL);
+    GstElement *appsink = gst_element_factory_make("appsink", NULL);
+
+    if (!playbin || !videoscale || !capsfilter || !videoconvert || !appsink) {
+        qWarning() << "FrameGrabber: Failed to create the pipeline elements";
+        GstElement *elements[] = { playbin, videoscale, capsfilter, videoconvert, appsink };
+        for (uint i = 0; i < sizeof(elements) / sizeof(GstElement*); ++i) {
+            if (elements[i]) {
+                gst_object_unref(gst_object_ref_sink(elements[i]));
+            }
+        }
+        return NULL;
+    }
+
+    //scale before converting, so that the conversion works on the small frame
+    GstElement *bin = gst_bin_new(NULL);
+    gst_bin_add_many(GST_BIN(bin), videoscale, capsfilter, videoconvert, appsink, NULL);
+    gst_element_link_many(videoscale, capsfilter, videoconvert, appsink, NULL);
+
+    GstPad *pad = gst_element_get_static_pad(videoscale, "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+
+    GstCaps *caps = gst_caps_new_simple("video/x-raw",
+                                        "format", G_TYPE_STRING, FRAMEGRABBER_FORMAT,
+                                        NULL);
+    g_object_set(appsink, "caps", caps, "sync", FALSE, "max-buffers", 1,
+                 "enable-last-sample", FALSE, NULL);
+    gst_caps_unref(caps);
+
+    g_object_set(playbin, "video-sink", bin, "flags", PLAYBIN_FLAGS, NULL);
+
+    DecodePipeline *pipeline = new DecodePipeline;
+    pipeline->playbin = GST_ELEMENT(gst_object_ref_sink(playbin));
+    pipeline->capsfilter = capsfilter;
+    pipeline->appsink = appsink;
+    pipeline->width = 0;
+
+    QMutexLocker lock(&mutex);
+    createdCount++;
+    return pipeline;
+}
+
+void FrameGrabber::Priv::destroyPipeline(DecodePipeline *pipeline)
+{
+    gst_element_set_state(pipeline->playbin, GST_STATE_NULL);
+    gst_object_unref(pipeline->playbin);
+    delete pipeline;
+}
+
+void FrameGrabber::Priv::setWidth(DecodePipeline *pipeline, int width)
+{
+    if (pipeline->width == width) {
+        return;
+    }
+
+    //only the width is fixed; videoscale picks the height that keeps the display aspect ratio
+    GstCaps *caps = gst_caps_new_simple("video/x-raw",
+                                        "width", G_TYPE_INT, width,
+                                        "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+                                        NULL);
+    g_object_set(pipeline->capsfilter, "caps", caps, NULL);
+    gst_caps_unref(caps);
+    pipeline->width = width;
+}
+
+bool FrameGrabber::Priv::waitForPreroll(DecodePipeline *pipeline)
+{
+    GstBus *bus = gst_element_get_bus(pipeline->playbin);
+    GstMessage *message = gst_bus_timed_pop_filtered(bus, timeout * GST_MSECOND,
+            GstMessageType(GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR));
+    gst_object_unref(bus);
+
+    bool prerolled = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_ASYNC_DONE;
+    if (message) {
+        gst_message_unref(message);
+    }
+    return prerolled;
+}
+
+bool FrameGrabber::Priv::open(DecodePipeline *pipeline, const QString & uri)
+{
+    g_object_set(pipeline->playbin, "uri", uri.toUtf8().constData(), NULL);
+
+    switch (gst_element_set_state(pipeline->playbin, GST_STATE_PAUSED)) {
+    case GST_STATE_CHANGE_FAILURE:
+        return false;
+    case GST_STATE_CHANGE_ASYNC:
+        return waitForPreroll(pipeline);
+    default:
+        return true;
+    }
+}
+
+void FrameGrabber::Priv::close(DecodePipeline *pipeline)
+{
+    //READY keeps the elements of the pipeline, but releases the file
+    gst_element_set_state(pipeline->playbin, GST_STATE_READY);
+
+    //drop the messages of this file, so that they are not mistaken for the next one's
+    GstBus *bus = gst_element_get_bus(pipeline->playbin);
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+}
+
+QList<SamplePtr> FrameGrabber::Priv::grab(const QString & uri,
+                                          const QList<ClockTime> *positions, int count)
+{
+    QList<SamplePtr> frames;
+
+    DecodePipeline *pipeline = acquire();
+    if (!pipeline) {
+        return frames;
+    }
+
+    mutex.lock();
+    int currentWidth = width;
+    mutex.unlock();
+    setWidth(pipeline, currentWidth);
+
+    if (open(pipeline, uri)) {
+        QList<ClockTime> evenlySpaced;
+        if (!positions) {
+            //pick the middle of 'count' equal parts, which avoids the usual black first frame
+            gint64 duration;
+            if (gst_element_query_duration(pipeline->playbin, GST_FORMAT_TIME, &duration)
+                && duration > 0)
+            {
+                for (int i = 0; i < count; ++i) {
+                    evenlySpaced.append(ClockTime(duration * (2 * i + 1) / (2 * count)));
+                }
+            } else if (count > 0) {
+                evenlySpaced.append(ClockTime(0));
+            }
+            positions = &evenlySpaced;
+        }
+
+        const GstSeekFlags flags = GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT
+                                                | GST_SEEK_FLAG_SNAP_NEAREST);
+        Q_FOREACH(const ClockTime & position, *positions) {
+            if (!gst_element_seek_simple(pipeline->playbin, GST_FORMAT_TIME, flags, position)
+                || !waitForPreroll(pipeline))
+            {
+                continue;
+            }
+
+            GstSample *sample = gst_app_sink_pull_preroll(GST_APP_SINK(pipeline->appsink));
+            if (sample) {
+                frames.append(SamplePtr::wrap(sample, false));
+            }
+        }
+    }
+
+    close(pipeline);
+    release(pipeline);
+    return frames;
+}
+
+void FrameGrabber::Priv::Job::run()
+{
+    QList<SamplePtr> frames = self->d->grab(uri, NULL, count);
+    for (int i = 0; i < frames.size(); ++i) {
+        self->frameGrabbed(uri, i, frames.at(i));
+    }
+    total->fetchAndAddOrdered(frames.size());
+}
+
+#endif //DOXYGEN_RUN
+
+
+FrameGrabber::FrameGrabber()
+    : d(new Priv)
+{
+}
+
+FrameGrabber::~FrameGrabber()
+{
+    Q_ASSERT(d->idle.size() == d->liveCount);
+    Q_FOREACH(Priv::DecodePipeline *pipeline, d->idle) {
+        d->destroyPipeline(pipeline);
+    }
+    delete d;
+}
+
+int FrameGrabber::width() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->width;
+}
+
+void FrameGrabber::setWidth(int width)
+{
+    QMutexLocker lock(&d->mutex);
+    d->width = width;
+}
+
+int FrameGrabber::maximumPipelines() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->maximumPipelines;
+}
+
+void FrameGrabber::setMaximumPipelines(int count)
+{
+    QMutexLocker lock(&d->mutex);
+    d->maximumPipelines = qMax(count, 1);
+    d->pipelineReleased.wakeAll();
+}
+
+int FrameGrabber::timeout() const
+{
+    return d->timeout;
+}
+
+void FrameGrabber::setTimeout(int msecs)
+{
+    d->timeout = msecs;
+}
+
+QList<SamplePtr> FrameGrabber::grab(const QString & uri, const QList<ClockTime> & positions)
+{
+    return d->grab(uri, &positions, positions.size());
+}
+
+QList<SamplePtr> FrameGrabber::grab(const QString & uri, int count)
+{
+    return d->grab(uri, NULL, count);
+}
+
+int FrameGrabber::grabAll(const QStringList & uris, int count)
+{
+    QAtomicInt total(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(maximumPipelines());
+
+    Q_FOREACH(const QString & uri, uris) {
+        pool.start(new Priv::Job(this, uri, count, &total));
+    }
+    pool.waitForDone();
+
+    return total.fetchAndAddOrdered(0);
+}
+
+int FrameGrabber::pipelinesCreated() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->createdCount;
+}
+
+void FrameGrabber::frameGrabbed(const QString & uri, int index, const SamplePtr & sample)
+{
+    Q_UNUSED(uri);
+    Q_UNUSED(index);
+    Q_UNUSED(sample);
+}
+
+} //namespace Utils
+} //namespace QGst
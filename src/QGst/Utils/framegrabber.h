@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_FRAMEGRABBER_H
+#define QGST_UTILS_FRAMEGRABBER_H
+
+#include "global.h"
+#include "../sample.h"
+#include "../clocktime.h"
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile framegrabber.h <QGst/Utils/FrameGrabber>
+ * \brief Helper class for extracting still frames from many files quickly
+ *
+ * Building a pipeline, loading its plugins and negotiating it usually costs more than
+ * decoding the few frames that are needed for a thumbnail. FrameGrabber keeps a pool of
+ * decoding pipelines around and only swaps the URI of an idle pipeline when a new file
+ * has to be processed.
+ *
+ * Frames are extracted with flushing seeks that snap to the nearest keyframe, so that
+ * only one frame needs to be decoded for each requested position. The decoded frames are
+ * scaled down to width() in their native format, before they are converted to the output
+ * format, so that the conversion only touches the pixels that are kept. The returned
+ * samples carry caps with the actual size and a format that can be wrapped in a QImage
+ * with QImage::Format_RGB32.
+ *
+ * grab() is thread-safe and blocks the calling thread until the frames of one file have
+ * been extracted. grabAll() processes a list of files in parallel, using up to
+ * maximumPipelines() pipelines, which defaults to the number of CPU cores.
+ */
+class QTGSTREAMERUTILS_EXPORT FrameGrabber
+{
+public:
+    FrameGrabber();
+    virtual ~FrameGrabber();
+
+    /*! \returns the width of the extracted frames; the height follows the display aspect ratio */
+    int width() const;
+    void setWidth(int width);
+
+    /*! \returns the maximum number of decoding pipelines that are kept */
+    int maximumPipelines() const;
+    void setMaximumPipelines(int count);
+
+    /*! \returns the time, in milliseconds, that a single file or seek may take before giving up */
+    int timeout() const;
+    void setTimeout(int msecs);
+
+    /*! Extracts the frames closest to \a positions from the file at \a uri. Positions for
+     * which no frame could be extracted are skipped. */
+    QList<SamplePtr> grab(const QString & uri, const QList<ClockTime> & positions);
+
+    /*! Extracts \a count frames that are evenly spaced over the duration of \a uri. */
+    QList<SamplePtr> grab(const QString & uri, int count);
+
+    /*! Extracts \a count frames from each of \a uris, in parallel. The frames are
+     * delivered through frameGrabbed(). \returns the total number of extracted frames */
+    int grabAll(const QStringList & uris, int count);
+
+    /*! \returns the number of pipelines that have been created so far */
+    int pipelinesCreated() const;
+
+protected:
+    /*! Called by grabAll() for every extracted frame, from one of the worker threads.
+     * \a index is the index of the frame within the file. The default implementation
+     * does nothing. */
+    virtual void frameGrabbed(const QString & uri, int index, const SamplePtr & sample);
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(FrameGrabber)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_FRAMEGRABBER_H
@@ -0,0 +1,477 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "latencytracer.h"
+#include "../meta.h"
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* The meta attached by the source probes. Each source writes its own slot,
+ * so that a buffer can be traced from several sources along its path. */
+struct LatencyStamp
+{
+    LatencyStamp() : mask(0) {}
+
+    gint64 times[LatencyTracer::MaxSources];
+    quint32 mask;
+};
+
+inline int loadAcquire(const QAtomicInt & value)
+{
+    QAtomicInt & v = const_cast<QAtomicInt&>(value);
+#if QT_VERSION >= 0x050000
+    return v.loadAcquire();
+#else
+    return v.fetchAndAddAcquire(0);
+#endif
+}
+
+/* A log-linear histogram of latencies in microseconds. Values below 16 have a
+ * bucket each; above that, every power of two is split in 16 buckets. */
+struct Histogram
+{
+    enum { SubBuckets = 16, BucketCount = 29 * SubBuckets };
+
+    Histogram() : max(0) {}
+
+    static int bucketIndex(quint32 value)
+    {
+        if (value < SubBuckets) {
+            return value;
+        }
+#if defined(Q_CC_GNU)
+        int e = 31 - __builtin_clz(value);
+#else
+        int e = 4;
+        while (value >> (e + 1)) {
+            ++e;
+        }
+#endif
+        return (e - 3) * SubBuckets + ((value >> (e - 4)) & (SubBuckets - 1));
+    }
+
+    //the largest value that falls in the bucket
+    static quint64 bucketValue(int index)
+    {
+        if (index < SubBuckets) {
+            return index;
+        }
+        int e = index / SubBuckets + 3;
+        quint64 lower = quint64(SubBuckets + index % SubBuckets) << (e - 4);
+        return lower + (quint64(1) << (e - 4)) - 1;
+    }
+
+    void record(quint32 value)
+    {
+        buckets[bucketIndex(value)].fetchAndAddRelaxed(1);
+
+        int current = loadAcquire(max);
+        while (int(value) > current && !max.testAndSetOrdered(current, value)) {
+            current = loadAcquire(max);
+        }
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < BucketCount; ++i) {
+            buckets[i].fetchAndStoreRelaxed(0);
+        }
+        max.fetchAndStoreRelaxed(0);
+    }
+
+    QAtomicInt buckets[BucketCount];
+    QAtomicInt max;
+};
+
+} //anonymous namespace
+
+/* Shared between the tracer and its probes. The probes hold a reference, released
+ * by their destroy notify, which GStreamer calls only once the probe is no longer
+ * running, so that the tracer can be destroyed while the pipeline is streaming. */
+struct QTGSTREAMERUTILS_NO_EXPORT LatencyTracer::Priv
+{
+    struct Source
+    {
+        GstPad *pad;
+        gulong probeId;
+    };
+
+    struct Sink
+    {
+        Sink() : pad(NULL), probeId(0), unstamped(0) {}
+        ~Sink()
+        {
+            for (int i = 0; i < MaxSources; ++i) {
+                delete histograms[i].fetchAndStoreRelaxed(NULL);
+            }
+        }
+
+        GstPad *pad;
+        gulong probeId;
+        QAtomicPointer<Histogram> histograms[MaxSources];
+        QAtomicInt unstamped;
+    };
+
+    struct ProbeContext
+    {
+        Priv *priv;
+        int source;
+        Sink *sink;
+    };
+
+    Priv() : refCount(1) {}
+    ~Priv();
+
+    void ref() { refCount.ref(); }
+    void unref() { if (!refCount.deref()) delete this; }
+
+    static Histogram *histogram(Sink *sink, int source, bool create);
+    static QString padName(GstPad *pad);
+
+    static GstPadProbeReturn sourceProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn sinkProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static gboolean stampListItem(GstBuffer **buffer, guint index, gpointer user_data);
+    static gboolean measureListItem(GstBuffer **buffer, guint index, gpointer user_data);
+    static void destroyContext(gpointer user_data);
+
+    QAtomicInt refCount;
+
+    //only modified by the tracer's thread; the probes use their context
+    mutable QMutex mutex;
+    QVector<Source> sources;
+    QVector<Sink*> sinks;
+};
+
+LatencyTracer::Priv::~Priv()
+{
+    qDeleteAll(sinks);
+}
+
+//static
+void LatencyTracer::Priv::destroyContext(gpointer user_data)
+{
+    ProbeContext *context = static_cast<ProbeContext*>(user_data);
+    context->priv->unref();
+    delete context;
+}
+
+//static
+Histogram *LatencyTracer::Priv::histogram(Sink *sink, int source, bool create)
+{
+    QAtomicPointer<Histogram> & slot = sink->histograms[source];
+#if QT_VERSION >= 0x050000
+    Histogram *h = slot.loadAcquire();
+#else
+    Histogram *h = slot.fetchAndAddAcquire(0);
+#endif
+    if (h || !create) {
+        return h;
+    }
+
+    //first measurement of this path; another streaming thread may race us
+    h = new Histogram;
+    if (!slot.testAndSetOrdered(NULL, h)) {
+        delete h;
+#if QT_VERSION >= 0x050000
+        h = slot.loadAcquire();
+#else
+        h = slot.fetchAndAddAcquire(0);
+#endif
+    }
+    return h;
+}
+
+//static
+QString LatencyTracer::Priv::padName(GstPad *pad)
+{
+    gchar *name = gst_pad_get_name(pad);
+    GstElement *parent = gst_pad_get_parent_element(pad);
+    QString result = QString::fromUtf8(name);
+    if (parent) {
+        gchar *parentName = gst_element_get_name(parent);
+        result = QString::fromUtf8(parentName) + QLatin1Char(':') + result;
+        g_free(parentName);
+        gst_object_unref(parent);
+    }
+    g_free(name);
+    return result;
+}
+
+//static
+gboolean LatencyTracer::Priv::stampListItem(GstBuffer **buffer, guint index, gpointer user_data)
+{
+    Q_UNUSED(index);
+    const ProbeContext *context = static_cast<const ProbeContext*>(user_data);
+
+    //use the meta functions directly, constructing a Buffer wrapper for
+    //every buffer would cost more than the stamp itself
+    const QGst::Private::CustomMetaInfo *info = CustomMeta<LatencyStamp>::info();
+    *buffer = gst_buffer_make_writable(*buffer);
+    LatencyStamp *stamp = static_cast<LatencyStamp*>(QGst::Private::getCustomMeta(*buffer, info));
+    if (!stamp) {
+        stamp = static_cast<LatencyStamp*>(QGst::Private::addCustomMeta(*buffer, info));
+        if (!stamp) {
+            return TRUE;
+        }
+    }
+    stamp->times[context->source] = g_get_monotonic_time();
+    stamp->mask |= 1u << context->source;
+    return TRUE;
+}
+
+//static
+GstPadProbeReturn LatencyTracer::Priv::sourceProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                   gpointer user_data)
+{
+    Q_UNUSED(pad);
+
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        stampListItem(&buffer, 0, user_data);
+        GST_PAD_PROBE_INFO_DATA(info) = buffer;
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList *list = gst_buffer_list_make_writable(GST_PAD_PROBE_INFO_BUFFER_LIST(info));
+        gst_buffer_list_foreach(list, &Priv::stampListItem, user_data);
+        GST_PAD_PROBE_INFO_DATA(info) = list;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+//static
+gboolean LatencyTracer::Priv::measureListItem(GstBuffer **buffer, guint index, gpointer user_data)
+{
+    Q_UNUSED(index);
+    const ProbeContext *context = static_cast<const ProbeContext*>(user_data);
+    const gint64 now = g_get_monotonic_time();
+
+    const LatencyStamp *stamp = static_cast<const LatencyStamp*>(
+            QGst::Private::getCustomMeta(*buffer, CustomMeta<LatencyStamp>::info()));
+    if (!stamp || !stamp->mask) {
+        context->sink->unstamped.ref();
+        return TRUE;
+    }
+
+    for (int source = 0; source < MaxSources; ++source) {
+        if (stamp->mask & (1u << source)) {
+            gint64 latency = qBound(gint64(0), now - stamp->times[source], gint64(G_MAXINT32));
+            histogram(context->sink, source, true)->record(quint32(latency));
+        }
+    }
+    return TRUE;
+}
+
+//static
+GstPadProbeReturn LatencyTracer::Priv::sinkProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                 gpointer user_data)
+{
+    Q_UNUSED(pad);
+
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        measureListItem(&buffer, 0, user_data);
+    } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        gst_buffer_list_foreach(GST_PAD_PROBE_INFO_BUFFER_LIST(info),
+                                &Priv::measureListItem, user_data);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+#endif //DOXYGEN_RUN
+
+
+LatencyTracer::LatencyTracer()
+    : d(new Priv)
+{
+    CustomMeta<LatencyStamp>::registerMeta("QGstUtilsLatencyStampMeta",
+            Meta::CopyOnCopy | Meta::CopyOnRegionCopy | Meta::CopyOnTransform);
+}
+
+LatencyTracer::~LatencyTracer()
+{
+    QMutexLocker locker(&d->mutex);
+    Q_FOREACH(const Priv::Source & source, d->sources) {
+        gst_pad_remove_probe(source.pad, source.probeId);
+        gst_object_unref(source.pad);
+    }
+    Q_FOREACH(Priv::Sink *sink, d->sinks) {
+        gst_pad_remove_probe(sink->pad, sink->probeId);
+        gst_object_unref(sink->pad);
+    }
+    locker.unlock();
+    d->unref();
+}
+
+int LatencyTracer::addSource(const PadPtr & pad)
+{
+    QMutexLocker locker(&d->mutex);
+    if (!pad || d->sources.size() >= MaxSources) {
+        return -1;
+    }
+
+    Priv::ProbeContext *context = new Priv::ProbeContext;
+    context->priv = d;
+    context->source = d->sources.size();
+    context->sink = NULL;
+    d->ref();
+
+    Priv::Source source;
+    source.pad = GST_PAD(gst_object_ref(static_cast<GstPad*>(pad)));
+    source.probeId = gst_pad_add_probe(source.pad,
+            GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+            &Priv::sourceProbe, context, &Priv::destroyContext);
+    d->sources.append(source);
+    return context->source;
+}
+
+int LatencyTracer::addSink(const PadPtr & pad)
+{
+    QMutexLocker locker(&d->mutex);
+    if (!pad) {
+        return -1;
+    }
+
+    Priv::Sink *sink = new Priv::Sink;
+    sink->pad = GST_PAD(gst_object_ref(static_cast<GstPad*>(pad)));
+
+    Priv::ProbeContext *context = new Priv::ProbeContext;
+    context->priv = d;
+    context->source = -1;
+    context->sink = sink;
+    d->ref();
+
+    sink->probeId = gst_pad_add_probe(sink->pad,
+            GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+            &Priv::sinkProbe, context, &Priv::destroyContext);
+    d->sinks.append(sink);
+    return d->sinks.size() - 1;
+}
+
+int LatencyTracer::sourceCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.size();
+}
+
+int LatencyTracer::sinkCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sinks.size();
+}
+
+LatencyTracer::Statistics LatencyTracer::statistics(int source, int sink) const
+{
+    Statistics result;
+    result.count = 0;
+    result.p50 = result.p95 = result.p99 = result.max = 0;
+
+    QMutexLocker locker(&d->mutex);
+    if (source < 0 || source >= d->sources.size() || sink < 0 || sink >= d->sinks.size()) {
+        return result;
+    }
+
+    const Histogram *h = Priv::histogram(d->sinks.at(sink), source, false);
+    if (!h) {
+        return result;
+    }
+
+    //snapshot the buckets, since they keep changing while we walk them
+    QVector<int> counts(Histogram::BucketCount);
+    for (int i = 0; i < Histogram::BucketCount; ++i) {
+        counts[i] = loadAcquire(h->buckets[i]);
+        result.count += counts[i];
+    }
+    if (!result.count) {
+        return result;
+    }
+
+    const quint64 maxValue = quint64(loadAcquire(h->max));
+    const double percentiles[] = { 0.50, 0.95, 0.99 };
+    ClockTime *values[] = { &result.p50, &result.p95, &result.p99 };
+
+    for (int p = 0; p < 3; ++p) {
+        quint64 rank = qMax(quint64(1), quint64(percentiles[p] * result.count + 0.5));
+        quint64 seen = 0;
+        for (int i = 0; i < Histogram::BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                *values[p] = ClockTime::fromUSecs(qMin(Histogram::bucketValue(i), maxValue));
+                break;
+            }
+        }
+    }
+    result.max = ClockTime::fromUSecs(maxValue);
+    return result;
+}
+
+quint64 LatencyTracer::unstampedCount(int sink) const
+{
+    QMutexLocker locker(&d->mutex);
+    if (sink < 0 || sink >= d->sinks.size()) {
+        return 0;
+    }
+    return quint64(quint32(loadAcquire(d->sinks.at(sink)->unstamped)));
+}
+
+void LatencyTracer::reset()
+{
+    QMutexLocker locker(&d->mutex);
+    Q_FOREACH(Priv::Sink *sink, d->sinks) {
+        for (int source = 0; source < MaxSources; ++source) {
+            if (Histogram *h = Priv::histogram(sink, source, false)) {
+                h->reset();
+            }
+        }
+        sink->unstamped.fetchAndStoreRelaxed(0);
+    }
+}
+
+QString LatencyTracer::report() const
+{
+    QStringList lines;
+    const int sources = sourceCount();
+    const int sinks = sinkCount();
+
+    for (int sink = 0; sink < sinks; ++sink) {
+        for (int source = 0; source < sources; ++source) {
+            Statistics s = statistics(source, sink);
+            if (!s.count) {
+                continue;
+            }
+
+            QMutexLocker locker(&d->mutex);
+            lines.append(QString::fromLatin1("%1 -> %2: %3 buffers, p50 %4 us, p95 %5 us, "
+                                             "p99 %6 us, max %7 us")
+                         .arg(Priv::padName(d->sources.at(source).pad))
+                         .arg(Priv::padName(d->sinks.at(sink)->pad))
+                         .arg(s.count)
+                         .arg(quint64(s.p50) / 1000).arg(quint64(s.p95) / 1000)
+                         .arg(quint64(s.p99) / 1000).arg(quint64(s.max) / 1000));
+        }
+    }
+    return lines.join(QLatin1String("\n"));
+}
+
+} //namespace Utils
+} //namespace QGst
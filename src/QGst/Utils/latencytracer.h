@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_LATENCYTRACER_H
+#define QGST_UTILS_LATENCYTRACER_H
+
+#include "global.h"
+#include "../pad.h"
+#include "../clocktime.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile latencytracer.h <QGst/Utils/LatencyTracer>
+ * \brief Helper class for measuring the latency between pads of a running pipeline
+ *
+ * LatencyTracer stamps every buffer that leaves a source pad with the monotonic
+ * clock, and reads the stamp back when the buffer reaches a sink pad. The difference
+ * is recorded in a histogram for each (source, sink) path, from which statistics()
+ * computes percentiles.
+ *
+ * The stamp is carried in a CustomMeta that is copied along with the buffer, both
+ * on plain copies and on transformations, so it survives elements that copy or
+ * modify the buffers in place. Elements that produce new buffers (encoders, decoders)
+ * only preserve it if they copy the metas of their input, as the GStreamer base
+ * classes do for metas without tags. Buffers that reach a sink without a stamp are
+ * counted by unstampedCount().
+ *
+ * \code
+ * m_tracer = new QGst::Utils::LatencyTracer;
+ * int source = m_tracer->addSource(m_appSource.element()->getStaticPad("src"));
+ * int sink = m_tracer->addSink(m_videoSink->getStaticPad("sink"));
+ * ...
+ * QGst::Utils::LatencyTracer::Statistics s = m_tracer->statistics(source, sink);
+ * qDebug() << "p99 latency:" << s.p99 / 1000 << "us";
+ * \endcode
+ *
+ * Recording a sample takes no lock; it costs a few atomic increments. The histograms
+ * have a resolution of 1/16 of the measured value (about 6%), from 1 microsecond up
+ * to about 35 minutes.
+ *
+ * \note The source pads must be upstream of the sink pads and at most MaxSources
+ * sources can be traced by the same tracer. Buffers leaving a source pad are made
+ * writable in order to attach the stamp. A buffer that is still referenced elsewhere,
+ * for example by the application that pushed it, is replaced by a shallow copy that
+ * shares its memory.
+ */
+class QTGSTREAMERUTILS_EXPORT LatencyTracer
+{
+public:
+    enum { MaxSources = 8 };
+
+    /*! The latency of one path. All values are zero if no buffer was measured. */
+    struct Statistics
+    {
+        quint64 count;
+        ClockTime p50;
+        ClockTime p95;
+        ClockTime p99;
+        ClockTime max;
+    };
+
+    LatencyTracer();
+    virtual ~LatencyTracer();
+
+    /*! Starts stamping the buffers that pass through \a pad.
+     * \returns an id for the source, or -1 if MaxSources has been reached */
+    int addSource(const PadPtr & pad);
+
+    /*! Starts measuring the buffers that pass through \a pad.
+     * \returns an id for the sink */
+    int addSink(const PadPtr & pad);
+
+    int sourceCount() const;
+    int sinkCount() const;
+
+    /*! \returns the statistics of the path from \a source to \a sink */
+    Statistics statistics(int source, int sink) const;
+
+    /*! \returns the number of buffers that reached \a sink without a stamp */
+    quint64 unstampedCount(int sink) const;
+
+    /*! Clears all the recorded measurements. */
+    void reset();
+
+    /*! \returns a human-readable summary of every path that has measurements */
+    QString report() const;
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(LatencyTracer)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_LATENCYTRACER_H
@@ -0,0 +1,274 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "mappedfilesource.h"
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <gst/gst.h>
+
+#ifdef Q_OS_UNIX
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* Owned by the GstMemory that wraps the whole file. The buffers that are pushed
+ * share that memory, so the file stays mapped until the last of them is freed. */
+struct Mapping
+{
+    QFile file;
+    uchar *data;
+
+    static void release(gpointer mapping)
+    {
+        Mapping *m = static_cast<Mapping*>(mapping);
+        m->file.unmap(m->data);
+        delete m;
+    }
+};
+
+#ifdef Q_OS_UNIX
+void adviseRange(uchar *data, quint64 start, quint64 end, int advice)
+{
+    static const quint64 pageSize = sysconf(_SC_PAGESIZE);
+    start &= ~(pageSize - 1); //the mapping starts on a page boundary
+    if (end > start) {
+        madvise(data + start, end - start, advice);
+    }
+}
+#endif
+
+} //anonymous namespace
+
+struct QTGSTREAMERUTILS_NO_EXPORT MappedFileSource::Priv
+{
+public:
+    Priv()
+        : memory(NULL), data(NULL), size(0), readahead(2 * 1024 * 1024)
+    {
+        reset();
+    }
+
+    void reset();
+    void advise(quint64 start, quint64 length);
+
+    mutable QMutex mutex;
+    QString fileName;
+    GstMemory *memory;
+    uchar *data;
+    quint64 size;
+    int readahead;
+
+    quint64 offset;
+    quint64 lastEnd;
+    quint64 advisedEnd;
+    bool random;
+
+    quint64 bytesPushed;
+    uint seekCount;
+};
+
+void MappedFileSource::Priv::reset()
+{
+    offset = 0;
+    lastEnd = 0;
+    advisedEnd = 0;
+    random = false;
+    bytesPushed = 0;
+    seekCount = 0;
+}
+
+void MappedFileSource::Priv::advise(quint64 start, quint64 length)
+{
+#ifdef Q_OS_UNIX
+    const quint64 end = start + length;
+
+    if (start == lastEnd) {
+        //sequential; keep readahead bytes in flight, topping up in halves
+        if (random) {
+            adviseRange(data, 0, size, MADV_SEQUENTIAL);
+            random = false;
+            advisedEnd = start;
+        }
+        if (end + readahead / 2 > advisedEnd) {
+            const quint64 aheadEnd = qMin(size, end + readahead);
+            adviseRange(data, qMax(start, advisedEnd), aheadEnd, MADV_WILLNEED);
+            advisedEnd = aheadEnd;
+        }
+    } else {
+        //a jump; only fetch what was asked for
+        if (!random) {
+            adviseRange(data, 0, size, MADV_RANDOM);
+            random = true;
+        }
+        adviseRange(data, start, end, MADV_WILLNEED);
+        advisedEnd = end;
+    }
+#else
+    Q_UNUSED(start);
+    Q_UNUSED(length);
+#endif
+}
+
+#endif //DOXYGEN_RUN
+
+
+MappedFileSource::MappedFileSource()
+    : ApplicationSource(), d(new Priv)
+{
+}
+
+MappedFileSource::~MappedFileSource()
+{
+    close();
+    delete d;
+}
+
+bool MappedFileSource::open(const QString & fileName)
+{
+    close();
+
+    Mapping *mapping = new Mapping;
+    mapping->file.setFileName(fileName);
+    if (!mapping->file.open(QIODevice::ReadOnly) || mapping->file.size() <= 0) {
+        delete mapping;
+        return false;
+    }
+
+    const qint64 size = mapping->file.size();
+    mapping->data = mapping->file.map(0, size);
+    if (!mapping->data) {
+        delete mapping;
+        return false;
+    }
+
+    QMutexLocker lock(&d->mutex);
+    d->fileName = fileName;
+    d->data = mapping->data;
+    d->size = size;
+    d->memory = gst_memory_new_wrapped(GST_MEMORY_FLAG_READONLY, mapping->data, size,
+                                       0, size, mapping, &Mapping::release);
+    d->reset();
+#ifdef Q_OS_UNIX
+    adviseRange(d->data, 0, d->size, MADV_SEQUENTIAL);
+#endif
+    lock.unlock();
+
+    setStreamType(AppStreamTypeRandomAccess);
+    setFormat(FormatBytes);
+    setSize(size);
+    return true;
+}
+
+void MappedFileSource::close()
+{
+    QMutexLocker lock(&d->mutex);
+    if (d->memory) {
+        gst_memory_unref(d->memory);
+        d->memory = NULL;
+        d->data = NULL;
+        d->size = 0;
+        d->fileName.clear();
+    }
+}
+
+bool MappedFileSource::isOpen() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->memory != NULL;
+}
+
+QString MappedFileSource::fileName() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->fileName;
+}
+
+int MappedFileSource::readahead() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->readahead;
+}
+
+void MappedFileSource::setReadahead(int bytes)
+{
+    QMutexLocker lock(&d->mutex);
+    d->readahead = qMax(bytes, 0);
+}
+
+quint64 MappedFileSource::bytesPushed() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->bytesPushed;
+}
+
+uint MappedFileSource::seekCount() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->seekCount;
+}
+
+void MappedFileSource::needData(uint length)
+{
+    QMutexLocker lock(&d->mutex);
+    if (!d->memory || d->offset >= d->size) {
+        lock.unlock();
+        endOfStream();
+        return;
+    }
+
+    //length is only a hint when it is -1
+    if (length == 0 || length == uint(-1)) {
+        length = 64 * 1024;
+    }
+
+    const quint64 offset = d->offset;
+    const quint64 size = qMin<quint64>(length, d->size - offset);
+    d->advise(offset, size);
+
+    GstBuffer *buffer = gst_buffer_new();
+    gst_buffer_append_memory(buffer, gst_memory_share(d->memory, offset, size));
+    GST_BUFFER_OFFSET(buffer) = offset;
+    GST_BUFFER_OFFSET_END(buffer) = offset + size;
+
+    d->offset = d->lastEnd = offset + size;
+    d->bytesPushed += size;
+    lock.unlock();
+
+    pushBuffer(BufferPtr::wrap(buffer, false));
+}
+
+bool MappedFileSource::seekData(quint64 offset)
+{
+    QMutexLocker lock(&d->mutex);
+    if (!d->memory || offset > d->size) {
+        return false;
+    }
+    if (offset != d->offset) {
+        d->seekCount++;
+        d->offset = offset;
+    }
+    return true;
+}
+
+} //namespace Utils
+} //namespace QGst
@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_MAPPEDFILESOURCE_H
+#define QGST_UTILS_MAPPEDFILESOURCE_H
+
+#include "applicationsource.h"
+#include <QtCore/QString>
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile mappedfilesource.h <QGst/Utils/MappedFileSource>
+ * \brief Helper class for reading a local file through a memory mapping
+ *
+ * MappedFileSource is an ApplicationSource that maps a whole file into memory with
+ * QFile::map() and answers needData() and seekData() by pushing buffers that wrap
+ * sub-ranges of the mapping, so no data is copied. The buffers are read-only and keep the
+ * mapping alive, so the file may be closed or reopened while they are still in use
+ * downstream.
+ *
+ * The stream type is AppStreamTypeRandomAccess, so demuxers can operate in pull mode.
+ * On Unix, the source gives the kernel readahead hints that follow the access pattern:
+ * consecutive reads ask for readahead() bytes ahead of the current position, while jumps
+ * switch the mapping to random access, so that the kernel does not read pages that the
+ * demuxer will skip.
+ *
+ * \note This class is not suitable for files that are modified while they are being read.
+ */
+class QTGSTREAMERUTILS_EXPORT MappedFileSource : public ApplicationSource
+{
+public:
+    MappedFileSource();
+    virtual ~MappedFileSource();
+
+    /*! Maps \a fileName and configures appsrc to stream it.
+     * \returns false if the file could not be opened or mapped */
+    bool open(const QString & fileName);
+
+    /*! Releases the mapping. Buffers that are still in use keep it alive until they are freed. */
+    void close();
+
+    bool isOpen() const;
+    QString fileName() const;
+
+    /*! \returns the number of bytes that are hinted for readahead
+     * during sequential reads. The default is 2 MiB. */
+    int readahead() const;
+    void setReadahead(int bytes);
+
+    /*! \returns the number of bytes that have been pushed since the file was opened */
+    quint64 bytesPushed() const;
+
+    /*! \returns the number of seeks to a position other than the current one
+     * since the file was opened */
+    uint seekCount() const;
+
+protected:
+    virtual void needData(uint length);
+    virtual bool seekData(quint64 offset);
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(MappedFileSource)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_MAPPEDFILESOURCE_H
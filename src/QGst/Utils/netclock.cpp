@@ -0,0 +1,363 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "netclock.h"
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <gst/gst.h>
+#include <gst/net/gstnet.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+struct QTGSTREAMERUTILS_NO_EXPORT NetTimeProvider::Priv
+{
+    Priv() : provider(NULL) {}
+
+    ClockPtr clock;
+    GstNetTimeProvider *provider;
+};
+
+#endif //DOXYGEN_RUN
+
+NetTimeProvider::NetTimeProvider(const ClockPtr & clock, const QString & address, quint16 port)
+    : d(new Priv)
+{
+    d->clock = clock;
+    if (!clock) {
+        return;
+    }
+
+    QByteArray addressUtf8 = address.toUtf8();
+    d->provider = gst_net_time_provider_new(clock,
+            address.isEmpty() ? NULL : addressUtf8.constData(), port);
+    if (!d->provider) {
+        qWarning() << "NetTimeProvider: Failed to listen on" << address << port;
+    }
+}
+
+NetTimeProvider::~NetTimeProvider()
+{
+    if (d->provider) {
+        gst_object_unref(d->provider);
+    }
+    delete d;
+}
+
+bool NetTimeProvider::isValid() const
+{
+    return d->provider != NULL;
+}
+
+ClockPtr NetTimeProvider::clock() const
+{
+    return d->clock;
+}
+
+QString NetTimeProvider::address() const
+{
+    if (!d->provider) {
+        return QString();
+    }
+    gchar *address = NULL;
+    g_object_get(d->provider, "address", &address, NULL);
+    QString result = QString::fromUtf8(address);
+    g_free(address);
+    return result;
+}
+
+quint16 NetTimeProvider::port() const
+{
+    gint port = 0;
+    if (d->provider) {
+        g_object_get(d->provider, "port", &port, NULL);
+    }
+    return port;
+}
+
+bool NetTimeProvider::isActive() const
+{
+    gboolean active = FALSE;
+    if (d->provider) {
+        g_object_get(d->provider, "active", &active, NULL);
+    }
+    return active;
+}
+
+void NetTimeProvider::setActive(bool active)
+{
+    if (d->provider) {
+        g_object_set(d->provider, "active", gboolean(active), NULL);
+    }
+}
+
+ClockTime NetTimeProvider::publish(const PipelinePtr & pipeline)
+{
+    if (!pipeline || !d->clock) {
+        return ClockTime::None;
+    }
+
+    GstElement *element = GST_ELEMENT(static_cast<GstPipeline*>(pipeline));
+    gst_pipeline_use_clock(pipeline, d->clock);
+    //keep the pipeline from selecting a base time of its own when it goes to playing
+    gst_element_set_start_time(element, GST_CLOCK_TIME_NONE);
+
+    GstClockTime baseTime = gst_clock_get_time(d->clock);
+    gst_element_set_base_time(element, baseTime);
+    return baseTime;
+}
+
+
+#ifndef DOXYGEN_RUN
+
+struct QTGSTREAMERUTILS_NO_EXPORT NetClientClock::Priv
+{
+    Priv();
+
+    ClockPtr clock;
+    QString address;
+    quint16 port;
+
+    mutable QMutex mutex;
+    Statistics statistics;
+    bool hasOffset;
+
+#if GST_CHECK_VERSION(1, 6, 0)
+    /* The sync handler runs on the clock's thread and may still be running
+     * after it has been removed from the bus, so it does not point to Priv
+     * directly. The context lives as long as the bus; the destructor detaches
+     * it under its lock, which the handler holds while updating Priv. */
+    struct SyncContext
+    {
+        QMutex mutex;
+        Priv *owner;
+    };
+
+    GstBus *bus;
+    SyncContext *sync;
+    static GstBusSyncReply statisticsHandler(GstBus *bus, GstMessage *message, gpointer user_data);
+    static void destroySyncContext(gpointer data);
+#else
+    GstClockTime initialInternal;
+#endif
+};
+
+NetClientClock::Priv::Priv()
+    : port(0), hasOffset(false)
+{
+    statistics.synchronized = false;
+    statistics.updates = 0;
+    statistics.offset = 0;
+    statistics.jitter = 0;
+    statistics.roundTripTime = ClockTime::None;
+    statistics.averageRoundTripTime = ClockTime::None;
+#if GST_CHECK_VERSION(1, 6, 0)
+    bus = NULL;
+    sync = NULL;
+#else
+    initialInternal = 0;
+#endif
+}
+
+#if GST_CHECK_VERSION(1, 6, 0)
+//static
+GstBusSyncReply NetClientClock::Priv::statisticsHandler(GstBus *bus, GstMessage *message,
+                                                        gpointer user_data)
+{
+    Q_UNUSED(bus);
+    SyncContext *context = static_cast<SyncContext*>(user_data);
+
+    const GstStructure *s = gst_message_get_structure(message);
+    if (!s || !gst_structure_has_name(s, "gst-netclock-statistics")) {
+        return GST_BUS_DROP;
+    }
+
+    gboolean synchronized = FALSE;
+    guint64 rtt = GST_CLOCK_TIME_NONE, rttAverage = GST_CLOCK_TIME_NONE;
+    guint64 local = 0, remote = 0;
+    gst_structure_get_boolean(s, "synchronised", &synchronized);
+    gst_structure_get_uint64(s, "rtt", &rtt);
+    gst_structure_get_uint64(s, "rtt-average", &rttAverage);
+    bool hasTimes = gst_structure_get_uint64(s, "local", &local)
+                 && gst_structure_get_uint64(s, "remote", &remote);
+
+    QMutexLocker contextLocker(&context->mutex);
+    Priv *self = context->owner;
+    if (!self) {
+        return GST_BUS_DROP;
+    }
+
+    QMutexLocker locker(&self->mutex);
+    Statistics & stats = self->statistics;
+    stats.synchronized = synchronized;
+    stats.roundTripTime = rtt;
+    stats.averageRoundTripTime = rttAverage;
+    ++stats.updates;
+
+    if (hasTimes) {
+        ClockTimeDiff offset = GST_CLOCK_DIFF(local, remote);
+        if (self->hasOffset) {
+            ClockTimeDiff change = qAbs(offset - stats.offset);
+            stats.jitter += (change - stats.jitter) / 16;
+        }
+        stats.offset = offset;
+        self->hasOffset = true;
+    }
+    return GST_BUS_DROP;
+}
+
+//static
+void NetClientClock::Priv::destroySyncContext(gpointer data)
+{
+    delete static_cast<SyncContext*>(data);
+}
+#endif
+
+#endif //DOXYGEN_RUN
+
+NetClientClock::NetClientClock(const QString & address, quint16 port, ClockTime baseTime)
+    : d(new Priv)
+{
+    d->address = address;
+    d->port = port;
+
+    GstClock *clock = gst_net_client_clock_new(NULL, address.toUtf8().constData(), port, baseTime);
+    if (!clock) {
+        qWarning() << "NetClientClock: Failed to create a clock for" << address << port;
+        return;
+    }
+    if (g_object_is_floating(clock)) {
+        gst_object_ref_sink(clock);
+    }
+    d->clock = ClockPtr::wrap(clock, false);
+
+#if GST_CHECK_VERSION(1, 6, 0)
+    //the clock posts its statistics on this bus, which is only used for that
+    d->bus = gst_bus_new();
+    d->sync = new Priv::SyncContext;
+    d->sync->owner = d;
+    g_object_set_data_full(G_OBJECT(d->bus), "qgst-netclock-sync", d->sync,
+                           &Priv::destroySyncContext);
+    gst_bus_set_sync_handler(d->bus, &Priv::statisticsHandler, d->sync, NULL);
+    g_object_set(clock, "bus", d->bus, NULL);
+#else
+    GstClockTime external, rateNum, rateDenom;
+    gst_clock_get_calibration(clock, &d->initialInternal, &external, &rateNum, &rateDenom);
+#endif
+}
+
+NetClientClock::~NetClientClock()
+{
+#if GST_CHECK_VERSION(1, 6, 0)
+    if (d->bus) {
+        if (d->clock) {
+            g_object_set(static_cast<GstClock*>(d->clock), "bus", NULL, NULL);
+        }
+        gst_bus_set_sync_handler(d->bus, NULL, NULL, NULL);
+
+        //waits for a handler that is still running before d goes away
+        d->sync->mutex.lock();
+        d->sync->owner = NULL;
+        d->sync->mutex.unlock();
+        gst_object_unref(d->bus);
+    }
+#endif
+    delete d;
+}
+
+ClockPtr NetClientClock::clock() const
+{
+    return d->clock;
+}
+
+QString NetClientClock::address() const
+{
+    return d->address;
+}
+
+quint16 NetClientClock::port() const
+{
+    return d->port;
+}
+
+bool NetClientClock::waitForSync(ClockTime timeout)
+{
+    if (!d->clock) {
+        return false;
+    }
+
+#if GST_CHECK_VERSION(1, 6, 0)
+    return gst_clock_wait_for_sync(d->clock, timeout);
+#else
+    //without sync support in GstClock, wait for the first calibration
+    const gint64 deadline = g_get_monotonic_time() + gint64(timeout / 1000);
+    Q_FOREVER {
+        if (statistics().synchronized) {
+            return true;
+        }
+        if (g_get_monotonic_time() >= deadline) {
+            return false;
+        }
+        g_usleep(10 * 1000);
+    }
+#endif
+}
+
+NetClientClock::Statistics NetClientClock::statistics() const
+{
+#if !GST_CHECK_VERSION(1, 6, 0)
+    if (d->clock) {
+        GstClockTime internal, external, rateNum, rateDenom;
+        gst_clock_get_calibration(d->clock, &internal, &external, &rateNum, &rateDenom);
+
+        QMutexLocker locker(&d->mutex);
+        if (internal != d->initialInternal) {
+            d->statistics.synchronized = true;
+            d->statistics.updates = qMax(d->statistics.updates, Q_UINT64_C(1));
+            d->statistics.offset = GST_CLOCK_DIFF(internal, external);
+        }
+    }
+#endif
+
+    QMutexLocker locker(&d->mutex);
+    return d->statistics;
+}
+
+void NetClientClock::slavePipeline(const PipelinePtr & pipeline, ClockTime baseTime,
+                                   ClockTime latency) const
+{
+    if (!pipeline || !d->clock) {
+        return;
+    }
+
+    GstElement *element = GST_ELEMENT(static_cast<GstPipeline*>(pipeline));
+    gst_pipeline_use_clock(pipeline, d->clock);
+    gst_element_set_start_time(element, GST_CLOCK_TIME_NONE);
+    gst_element_set_base_time(element, baseTime);
+
+    if (latency.isValid()) {
+#if GST_CHECK_VERSION(1, 6, 0)
+        gst_pipeline_set_latency(pipeline, latency);
+#else
+        qWarning() << "NetClientClock: Setting the pipeline latency requires GStreamer 1.6";
+#endif
+    }
+}
+
+} //namespace Utils
+} //namespace QGst
@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_NETCLOCK_H
+#define QGST_UTILS_NETCLOCK_H
+
+#include "global.h"
+#include "../clock.h"
+#include "../pipeline.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile netclock.h <QGst/Utils/NetTimeProvider>
+ * \brief Publishes a clock on the network for NetClientClock instances to follow
+ *
+ * This wraps GstNetTimeProvider. The master process of a synchronized group
+ * creates a provider for the clock of its pipeline, then distributes the port
+ * and the base time returned by publish() to the other processes, by any means.
+ *
+ * \code
+ * //master
+ * QGst::Utils::NetTimeProvider provider(QGst::Clock::systemClock());
+ * QGst::ClockTime baseTime = provider.publish(pipeline);
+ * sendToClients(provider.port(), baseTime);
+ *
+ * //every client
+ * QGst::Utils::NetClientClock clock(masterAddress, port);
+ * clock.waitForSync(QGst::ClockTime::fromSeconds(5));
+ * clock.slavePipeline(pipeline, baseTime);
+ * \endcode
+ */
+class QTGSTREAMERUTILS_EXPORT NetTimeProvider
+{
+public:
+    /*! Starts publishing \a clock on the UDP \a port of the given \a address.
+     * An empty \a address listens on all interfaces and a zero \a port lets
+     * the system choose one, which can be read back from port(). */
+    explicit NetTimeProvider(const ClockPtr & clock, const QString & address = QString(),
+                             quint16 port = 0);
+    virtual ~NetTimeProvider();
+
+    /*! \returns whether the provider could bind its socket */
+    bool isValid() const;
+
+    ClockPtr clock() const;
+    QString address() const;
+    quint16 port() const;
+
+    bool isActive() const;
+    /*! Stops or resumes answering the requests of the clients. */
+    void setActive(bool active);
+
+    /*! Makes \a pipeline use the published clock and fixes its base time to the
+     * current time of the clock, so that the clients can use the same base time.
+     * \returns the base time, to be passed to NetClientClock::slavePipeline() */
+    ClockTime publish(const PipelinePtr & pipeline);
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(NetTimeProvider)
+};
+
+
+/*! \headerfile netclock.h <QGst/Utils/NetClientClock>
+ * \brief A clock that follows a NetTimeProvider over the network
+ *
+ * This wraps GstNetClientClock, which periodically sends a request to the
+ * provider and adjusts its calibration from the answers. The quality of the
+ * synchronization can be followed with statistics().
+ *
+ * With GStreamer 1.6 or later, every answer of the provider updates the statistics,
+ * including the round trip time. With older versions the round trip time is not
+ * available and the offset is read from the clock's calibration when statistics()
+ * is called.
+ */
+class QTGSTREAMERUTILS_EXPORT NetClientClock
+{
+public:
+    /*! The quality of the synchronization with the provider */
+    struct Statistics
+    {
+        /*! Whether the clock considers itself synchronized with the provider */
+        bool synchronized;
+        /*! The number of answers received from the provider */
+        quint64 updates;
+        /*! The difference between the provider's time and the local clock's time */
+        ClockTimeDiff offset;
+        /*! The average absolute change of the offset between two answers,
+         * smoothed over the last 16 answers, as in RFC 3550 */
+        ClockTimeDiff jitter;
+        /*! The round trip time of the last answer, or ClockTime::None */
+        ClockTime roundTripTime;
+        /*! The average round trip time, or ClockTime::None */
+        ClockTime averageRoundTripTime;
+    };
+
+    /*! Creates a clock that follows the provider at \a address and \a port.
+     * \a baseTime is the initial time of the clock, which is used until the
+     * first answer of the provider arrives. */
+    NetClientClock(const QString & address, quint16 port, ClockTime baseTime = 0);
+    virtual ~NetClientClock();
+
+    /*! \returns the clock, which can be passed to Pipeline::useClock() */
+    ClockPtr clock() const;
+
+    QString address() const;
+    quint16 port() const;
+
+    /*! Blocks until the clock is synchronized with the provider, or until
+     * \a timeout elapses. \returns whether the clock is synchronized */
+    bool waitForSync(ClockTime timeout);
+
+    Statistics statistics() const;
+
+    /*! Makes \a pipeline use this clock with the given \a baseTime, as returned
+     * by NetTimeProvider::publish() on the master. If \a latency is valid, it is
+     * used as the pipeline's latency instead of the latency computed by the
+     * sinks, so that every process renders with the same delay; this requires
+     * GStreamer 1.6. */
+    void slavePipeline(const PipelinePtr & pipeline, ClockTime baseTime,
+                       ClockTime latency = ClockTime::None) const;
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(NetClientClock)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_NETCLOCK_H
@@ -0,0 +1,926 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pipelinepool.h"
+#include "../parse.h"
+#include "../../QGlib/error.h"
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* An element of a precompiled template */
+struct ElementRecord
+{
+    GstElementFactory *factory;
+    QByteArray name;
+    QList< QPair<QByteArray, QGlib::Value> > properties;
+};
+
+/* A link between two always pads of a precompiled template */
+struct LinkRecord
+{
+    int source;
+    QByteArray sourcePad;
+    int sink;
+    QByteArray sinkPad;
+};
+
+bool hasPendingHandler(gpointer instance, const char *signal, GType type)
+{
+    guint signalId = g_signal_lookup(signal, type);
+    return signalId && g_signal_has_handler_pending(instance, signalId, 0, FALSE);
+}
+
+/* Whether the parser will finish building the element later, or built it itself */
+bool isIncomplete(GstElement *element)
+{
+    GstElementFactory *factory = gst_element_get_factory(element);
+    if (!factory) {
+        return true;
+    }
+
+    const gchar *factoryName = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+    if (GST_IS_BIN(element) && (qstrcmp(factoryName, "bin") == 0
+                                || qstrcmp(factoryName, "pipeline") == 0)) {
+        return true; //a bin written with parentheses
+    }
+
+    //delayed links and delayed properties of children
+    return hasPendingHandler(element, "pad-added", GST_TYPE_ELEMENT)
+        || (GST_IS_CHILD_PROXY(element)
+            && hasPendingHandler(element, "child-added", GST_TYPE_CHILD_PROXY));
+}
+
+bool isAlwaysPad(GstPad *pad)
+{
+    GstPadTemplate *padTemplate = gst_pad_get_pad_template(pad);
+    bool always = padTemplate && GST_PAD_TEMPLATE_PRESENCE(padTemplate) == GST_PAD_ALWAYS;
+    if (padTemplate) {
+        gst_object_unref(padTemplate);
+    }
+    return always;
+}
+
+/* Records the properties that differ from their default value, which are
+ * the ones that the description set (or that the element set itself) */
+void recordProperties(GstElement *element, ElementRecord *record)
+{
+    guint count = 0;
+    GParamSpec **pspecs = g_object_class_list_properties(G_OBJECT_GET_CLASS(element), &count);
+
+    for (guint i = 0; i < count; ++i) {
+        GParamSpec *pspec = pspecs[i];
+        if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE
+                || (pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+                || pspec->owner_type == GST_TYPE_OBJECT //name and parent
+                || pspec->value_type == G_TYPE_POINTER
+                || g_type_is_a(pspec->value_type, G_TYPE_OBJECT)
+                || G_TYPE_IS_INTERFACE(pspec->value_type)) {
+            continue;
+        }
+
+        GValue value = G_VALUE_INIT;
+        g_value_init(&value, pspec->value_type);
+        g_object_get_property(G_OBJECT(element), pspec->name, &value);
+        if (!g_param_value_defaults(pspec, &value)) {
+            record->properties.append(qMakePair(QByteArray(pspec->name), QGlib::Value(&value)));
+        }
+        g_value_unset(&value);
+    }
+
+    g_free(pspecs);
+}
+
+PipelinePtr toPipeline(const ElementPtr & element)
+{
+    if (!element) {
+        return PipelinePtr();
+    }
+
+    PipelinePtr pipeline = element.dynamicCast<Pipeline>();
+    if (!pipeline) {
+        pipeline = Pipeline::create();
+        pipeline->add(element);
+    }
+    return pipeline;
+}
+
+struct TemplateCache
+{
+    QMutex mutex;
+    QHash<QString, PipelineTemplate> templates;
+};
+
+Q_GLOBAL_STATIC(TemplateCache, s_templateCache)
+
+} //anonymous namespace
+
+
+struct QTGSTREAMERUTILS_NO_EXPORT PipelineTemplate::Data : public QSharedData
+{
+    Data() : QSharedData(), precompiled(false), singleElement(false) {}
+    Data(const Data & other);
+    virtual ~Data();
+
+    bool record(GstElement *prototype);
+    void clear();
+    ElementPtr instantiate() const;
+
+    QString description;
+    bool precompiled;
+    bool singleElement; //whether the description is one element, not a pipeline
+    QList<ElementRecord> elements;
+    QList<LinkRecord> links;
+};
+
+PipelineTemplate::Data::Data(const PipelineTemplate::Data & other)
+    : QSharedData(other), description(other.description), precompiled(other.precompiled),
+      singleElement(other.singleElement), elements(other.elements), links(other.links)
+{
+    for (int i = 0; i < elements.size(); ++i) {
+        gst_object_ref(elements[i].factory);
+    }
+}
+
+PipelineTemplate::Data::~Data()
+{
+    clear();
+}
+
+void PipelineTemplate::Data::clear()
+{
+    for (int i = 0; i < elements.size(); ++i) {
+        gst_object_unref(elements[i].factory);
+    }
+    elements.clear();
+    links.clear();
+}
+
+bool PipelineTemplate::Data::record(GstElement *prototype)
+{
+    GstElementFactory *factory = gst_element_get_factory(prototype);
+    singleElement = !(GST_IS_PIPELINE(prototype) && factory
+        && qstrcmp(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), "pipeline") == 0);
+
+    //delayed properties of elements that do not exist yet
+    if (GST_IS_BIN(prototype)
+            && hasPendingHandler(prototype, "deep-element-added", GST_TYPE_BIN)) {
+        return false;
+    }
+
+    QList<GstElement*> children;
+    if (singleElement) {
+        children.append(prototype);
+    } else {
+        GST_OBJECT_LOCK(prototype);
+        for (GList *item = GST_BIN_CHILDREN(prototype); item; item = item->next) {
+            children.prepend(GST_ELEMENT(item->data)); //the list is newest first
+        }
+        GST_OBJECT_UNLOCK(prototype);
+    }
+
+    Q_FOREACH(GstElement *child, children) {
+        if (isIncomplete(child)) {
+            return false;
+        }
+
+        ElementRecord element;
+        element.factory = GST_ELEMENT_FACTORY(gst_object_ref(gst_element_get_factory(child)));
+        element.name = GST_OBJECT_NAME(child);
+        recordProperties(child, &element);
+        elements.append(element);
+    }
+
+    for (int i = 0; i < children.size(); ++i) {
+        GST_OBJECT_LOCK(children[i]);
+        QList<GstPad*> pads;
+        for (GList *item = GST_ELEMENT(children[i])->srcpads; item; item = item->next) {
+            pads.append(GST_PAD(gst_object_ref(item->data)));
+        }
+        GST_OBJECT_UNLOCK(children[i]);
+
+        bool ok = true;
+        Q_FOREACH(GstPad *pad, pads) {
+            GstPad *peer = ok ? gst_pad_get_peer(pad) : NULL;
+            if (peer) {
+                GstElement *peerElement = gst_pad_get_parent_element(peer);
+                int sink = children.indexOf(peerElement);
+                if (sink < 0 || !isAlwaysPad(pad) || !isAlwaysPad(peer)) {
+                    ok = false;
+                } else {
+                    LinkRecord link;
+                    link.source = i;
+                    link.sourcePad = GST_OBJECT_NAME(pad);
+                    link.sink = sink;
+                    link.sinkPad = GST_OBJECT_NAME(peer);
+                    links.append(link);
+                }
+                if (peerElement) {
+                    gst_object_unref(peerElement);
+                }
+                gst_object_unref(peer);
+            }
+            gst_object_unref(pad);
+        }
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ElementPtr PipelineTemplate::Data::instantiate() const
+{
+    QList<ElementPtr> created;
+    PipelinePtr pipeline = singleElement ? PipelinePtr() : Pipeline::create();
+
+    Q_FOREACH(const ElementRecord & record, elements) {
+        GstElement *element = gst_element_factory_create(record.factory, record.name.constData());
+        if (!element) {
+            qWarning() << "PipelineTemplate: Failed to create element" << record.name;
+            return ElementPtr();
+        }
+        gst_object_ref_sink(element);
+        created.append(ElementPtr::wrap(element, false));
+
+        for (int i = 0; i < record.properties.size(); ++i) {
+            g_object_set_property(G_OBJECT(element), record.properties[i].first.constData(),
+                                  record.properties[i].second);
+        }
+        if (pipeline) {
+            pipeline->add(created.last());
+        }
+    }
+
+    Q_FOREACH(const LinkRecord & link, links) {
+        if (!gst_element_link_pads(created[link.source], link.sourcePad.constData(),
+                                   created[link.sink], link.sinkPad.constData())) {
+            qWarning() << "PipelineTemplate: Failed to link" << link.sourcePad
+                       << "to" << link.sinkPad;
+            return ElementPtr();
+        }
+    }
+
+    if (pipeline) {
+        return pipeline;
+    }
+    return created.isEmpty() ? ElementPtr() : created.first();
+}
+
+#endif //DOXYGEN_RUN
+
+
+PipelineTemplate::PipelineTemplate()
+{
+}
+
+PipelineTemplate::PipelineTemplate(const PipelineTemplate & other)
+    : d(other.d)
+{
+}
+
+PipelineTemplate::~PipelineTemplate()
+{
+}
+
+PipelineTemplate & PipelineTemplate::operator=(const PipelineTemplate & other)
+{
+    d = other.d;
+    return *this;
+}
+
+//static
+PipelineTemplate PipelineTemplate::fromDescription(const QString & description)
+{
+    TemplateCache *cache = s_templateCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        QHash<QString, PipelineTemplate>::const_iterator it = cache->templates.constFind(description);
+        if (it != cache->templates.constEnd()) {
+            return it.value();
+        }
+    }
+
+    //parse without holding the lock; throws QGlib::Error
+    ElementPtr prototype = Parse::launch(description);
+
+    PipelineTemplate result;
+    result.d = new Data;
+    result.d->description = description;
+    result.d->precompiled = result.d->record(prototype);
+    if (!result.d->precompiled) {
+        result.d->clear();
+    }
+
+    QMutexLocker locker(&cache->mutex);
+    //another thread may have parsed the same description meanwhile
+    QHash<QString, PipelineTemplate>::iterator it = cache->templates.find(description);
+    if (it == cache->templates.end()) {
+        it = cache->templates.insert(description, result);
+    }
+    return it.value();
+}
+
+//static
+void PipelineTemplate::clearCache()
+{
+    TemplateCache *cache = s_templateCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->templates.clear();
+}
+
+bool PipelineTemplate::isValid() const
+{
+    return d;
+}
+
+QString PipelineTemplate::description() const
+{
+    return d ? d->description : QString();
+}
+
+bool PipelineTemplate::isPrecompiled() const
+{
+    return d && d->precompiled;
+}
+
+PipelinePtr PipelineTemplate::create() const
+{
+    if (!d) {
+        return PipelinePtr();
+    }
+    if (d->precompiled) {
+        return toPipeline(d->instantiate());
+    }
+    return toPipeline(Parse::launch(d->description));
+}
+
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* The time to first frame measurements. They are shared with the probes
+ * of the acquired pipelines, which may outlive the pool. */
+struct FirstFrameMetrics
+{
+    FirstFrameMetrics() : count(0), total(0), max(0), last(0) {}
+
+    void record(gint64 usecs)
+    {
+        QMutexLocker locker(&mutex);
+        ++count;
+        total += usecs;
+        max = qMax(max, usecs);
+        last = usecs;
+    }
+
+    QMutex mutex;
+    quint64 count;
+    gint64 total;
+    gint64 max;
+    gint64 last;
+};
+
+typedef QSharedPointer<FirstFrameMetrics> FirstFrameMetricsPtr;
+
+/* The measurement of one acquired pipeline. Referenced by each probe and by the
+ * bus handler, which release the reference from their destroy notifications. */
+struct FirstFrameWatch
+{
+    FirstFrameWatch(const FirstFrameMetricsPtr & metrics)
+        : metrics(metrics), start(g_get_monotonic_time()), done(0), refCount(1) {}
+
+    void ref() { refCount.ref(); }
+
+    void unref()
+    {
+        if (!refCount.deref()) {
+            delete this;
+        }
+    }
+
+    void hit()
+    {
+        if (done.testAndSetOrdered(0, 1)) {
+            metrics->record(g_get_monotonic_time() - start);
+        }
+    }
+
+    FirstFrameMetricsPtr metrics;
+    const gint64 start;
+    QAtomicInt done;
+    QAtomicInt refCount;
+};
+
+void unrefWatch(gpointer watch)
+{
+    static_cast<FirstFrameWatch*>(watch)->unref();
+}
+
+void unrefWatchClosure(gpointer watch, GClosure *closure)
+{
+    Q_UNUSED(closure);
+    static_cast<FirstFrameWatch*>(watch)->unref();
+}
+
+GstPadProbeReturn firstBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer watch)
+{
+    Q_UNUSED(pad);
+    Q_UNUSED(info);
+    static_cast<FirstFrameWatch*>(watch)->hit();
+    return GST_PAD_PROBE_OK;
+}
+
+void asyncDoneHandler(GstBus *bus, GstMessage *message, gpointer watch)
+{
+    Q_UNUSED(bus);
+    Q_UNUSED(message);
+    static_cast<FirstFrameWatch*>(watch)->hit();
+}
+
+/* The first element that has \a property, searching \a bin recursively */
+ElementPtr findElementWithProperty(GstBin *bin, const char *property)
+{
+    ElementPtr result;
+    GstIterator *it = gst_bin_iterate_recurse(bin);
+    GValue item = G_VALUE_INIT;
+    bool done = false;
+
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+        {
+            GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+            if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), property)) {
+                result = ElementPtr::wrap(element);
+                done = true;
+            }
+            g_value_reset(&item);
+            break;
+        }
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return result;
+}
+
+} //anonymous namespace
+
+struct QTGSTREAMERUTILS_NO_EXPORT PipelinePool::Priv
+{
+    /* Builds one pipeline on QThreadPool::globalInstance() */
+    struct Builder : public QRunnable
+    {
+        Builder(Priv *d) : d(d) {}
+        virtual void run() { d->build(); }
+        Priv *const d;
+    };
+
+    /* A property changed by acquire(), with the value to restore */
+    struct Override
+    {
+        ObjectPtr object;
+        QByteArray property;
+        QGlib::Value value;
+    };
+
+    /* The state of an acquired pipeline */
+    struct Loan
+    {
+        Loan() : bus(NULL), asyncDoneHandlerId(0) {}
+
+        QList<Override> overrides;
+        QList< QPair<GstPad*, gulong> > probes;
+        GstBus *bus;
+        gulong asyncDoneHandlerId;
+    };
+
+    Priv(const PipelineTemplate & pipelineTemplate, int size);
+
+    void refill();
+    void build();
+    PipelinePtr createReady() const;
+    bool applyOverride(const ObjectPtr & object, const char *property,
+                       const QGlib::Value & value, Loan *loan) const;
+    void startWatch(const PipelinePtr & pipeline, Loan *loan) const;
+    void stopWatch(Loan *loan) const;
+
+    const PipelineTemplate pipelineTemplate;
+    const FirstFrameMetricsPtr metrics;
+
+    mutable QMutex mutex;
+    mutable QWaitCondition condition;
+    int size;
+    int building;
+    QList<PipelinePtr> available;
+    QHash<GstPipeline*, Loan> loans;
+    QByteArray uriElement;
+    QByteArray uriProperty;
+    bool uriPropertySet;
+    Statistics stats;
+};
+
+PipelinePool::Priv::Priv(const PipelineTemplate & pipelineTemplate, int size)
+    : pipelineTemplate(pipelineTemplate), metrics(new FirstFrameMetrics),
+      size(qMax(0, size)), building(0), uriProperty("uri"), uriPropertySet(false)
+{
+    stats.created = stats.acquired = stats.misses = stats.recycled = stats.firstFrames = 0;
+}
+
+void PipelinePool::Priv::refill()
+{
+    //called with the mutex held
+    while (available.size() + building < size) {
+        ++building;
+        QThreadPool::globalInstance()->start(new Builder(this));
+    }
+}
+
+void PipelinePool::Priv::build()
+{
+    PipelinePtr pipeline = createReady();
+
+    QMutexLocker locker(&mutex);
+    --building;
+    if (pipeline) {
+        ++stats.created;
+        if (available.size() < size) {
+            available.append(pipeline);
+            pipeline.clear();
+        }
+    }
+    condition.wakeAll();
+    locker.unlock();
+
+    //the pool shrank meanwhile
+    if (pipeline) {
+        pipeline->setState(StateNull);
+    }
+}
+
+PipelinePtr PipelinePool::Priv::createReady() const
+{
+    PipelinePtr pipeline;
+    try {
+        pipeline = pipelineTemplate.create();
+    } catch (const QGlib::Error & error) {
+        qWarning() << "PipelinePool: Failed to build a pipeline:" << error.message();
+        return PipelinePtr();
+    }
+
+    if (pipeline && pipeline->setState(StateReady) == StateChangeFailure) {
+        qWarning() << "PipelinePool: Failed to bring a pipeline to the ready state";
+        pipeline->setState(StateNull);
+        pipeline.clear();
+    }
+    return pipeline;
+}
+
+bool PipelinePool::Priv::applyOverride(const ObjectPtr & object, const char *property,
+                                       const QGlib::Value & value, Loan *loan) const
+{
+    if (!object || !object->findProperty(property)) {
+        qWarning() << "PipelinePool: No property" << property << "to set";
+        return false;
+    }
+
+    Override saved;
+    saved.object = object;
+    saved.property = property;
+    saved.value = object->property(property);
+    loan->overrides.append(saved);
+
+    object->setProperty(property, value);
+    return true;
+}
+
+void PipelinePool::Priv::startWatch(const PipelinePtr & pipeline, Loan *loan) const
+{
+    FirstFrameWatch *watch = new FirstFrameWatch(metrics);
+
+    GstIterator *it = gst_bin_iterate_sinks(GST_BIN(static_cast<GstPipeline*>(pipeline)));
+    GValue item = G_VALUE_INIT;
+    bool done = false;
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+        {
+            GstElement *sink = GST_ELEMENT(g_value_get_object(&item));
+            GST_OBJECT_LOCK(sink);
+            for (GList *pad = sink->sinkpads; pad; pad = pad->next) {
+                watch->ref();
+                gulong id = gst_pad_add_probe(GST_PAD(pad->data),
+                        GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                        &firstBufferProbe, watch, &unrefWatch);
+                loan->probes.append(qMakePair(GST_PAD(gst_object_ref(pad->data)), id));
+            }
+            GST_OBJECT_UNLOCK(sink);
+            g_value_reset(&item);
+            break;
+        }
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    //the end of the preroll, for the sinks that do not exist yet
+    loan->bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    gst_bus_enable_sync_message_emission(loan->bus);
+    watch->ref();
+    loan->asyncDoneHandlerId = g_signal_connect_data(loan->bus, "sync-message::async-done",
+            G_CALLBACK(&asyncDoneHandler), watch, &unrefWatchClosure, GConnectFlags(0));
+
+    watch->unref();
+}
+
+void PipelinePool::Priv::stopWatch(Loan *loan) const
+{
+    for (int i = 0; i < loan->probes.size(); ++i) {
+        gst_pad_remove_probe(loan->probes[i].first, loan->probes[i].second);
+        gst_object_unref(loan->probes[i].first);
+    }
+    loan->probes.clear();
+
+    if (loan->bus) {
+        g_signal_handler_disconnect(loan->bus, loan->asyncDoneHandlerId);
+        gst_bus_disable_sync_message_emission(loan->bus);
+        gst_object_unref(loan->bus);
+        loan->bus = NULL;
+    }
+}
+
+#endif //DOXYGEN_RUN
+
+
+PipelinePool::PipelinePool(const PipelineTemplate & pipelineTemplate, int size)
+    : d(new Priv(pipelineTemplate, size))
+{
+    QMutexLocker locker(&d->mutex);
+    d->refill();
+}
+
+PipelinePool::~PipelinePool()
+{
+    QList<PipelinePtr> pipelines;
+    QHash<GstPipeline*, Priv::Loan> loans;
+    {
+        QMutexLocker locker(&d->mutex);
+        d->size = 0;
+        while (d->building > 0) {
+            d->condition.wait(&d->mutex);
+        }
+        pipelines = d->available;
+        d->available.clear();
+        loans = d->loans;
+        d->loans.clear();
+    }
+
+    Q_FOREACH(const PipelinePtr & pipeline, pipelines) {
+        pipeline->setState(StateNull);
+    }
+    for (QHash<GstPipeline*, Priv::Loan>::iterator it = loans.begin(); it != loans.end(); ++it) {
+        d->stopWatch(&it.value());
+    }
+
+    delete d;
+}
+
+PipelineTemplate PipelinePool::pipelineTemplate() const
+{
+    return d->pipelineTemplate;
+}
+
+int PipelinePool::size() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->size;
+}
+
+void PipelinePool::setSize(int size)
+{
+    QList<PipelinePtr> discarded;
+
+    QMutexLocker locker(&d->mutex);
+    d->size = qMax(0, size);
+    while (d->available.size() > d->size) {
+        discarded.append(d->available.takeLast());
+    }
+    d->refill();
+    locker.unlock();
+
+    Q_FOREACH(const PipelinePtr & pipeline, discarded) {
+        pipeline->setState(StateNull);
+    }
+}
+
+int PipelinePool::availableCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->available.size();
+}
+
+bool PipelinePool::waitForReady(ClockTime timeout) const
+{
+    QMutexLocker locker(&d->mutex);
+    const gint64 deadline = timeout.isValid()
+        ? g_get_monotonic_time() + gint64(timeout / 1000) : G_MAXINT64;
+
+    while (d->available.size() < d->size && d->building > 0) {
+        if (!timeout.isValid()) {
+            d->condition.wait(&d->mutex);
+        } else {
+            gint64 remaining = deadline - g_get_monotonic_time();
+            if (remaining <= 0) {
+                break;
+            }
+            d->condition.wait(&d->mutex, static_cast<unsigned long>((remaining + 999) / 1000));
+        }
+    }
+    return d->available.size() >= d->size;
+}
+
+void PipelinePool::setUriProperty(const QString & elementName, const QString & property)
+{
+    QMutexLocker locker(&d->mutex);
+    d->uriElement = elementName.toUtf8();
+    d->uriProperty = property.toUtf8();
+    d->uriPropertySet = true;
+}
+
+PipelinePtr PipelinePool::acquire(const QString & uri, const PropertyHash & properties)
+{
+    PipelinePtr pipeline;
+
+    QMutexLocker locker(&d->mutex);
+    ++d->stats.acquired;
+    if (!d->available.isEmpty()) {
+        pipeline = d->available.takeFirst();
+    } else {
+        ++d->stats.misses;
+    }
+    d->refill();
+    const QByteArray uriElement = d->uriElement;
+    const QByteArray uriProperty = d->uriProperty;
+    const bool uriPropertySet = d->uriPropertySet;
+    locker.unlock();
+
+    if (!pipeline) {
+        pipeline = d->createReady();
+        if (!pipeline) {
+            return PipelinePtr();
+        }
+        locker.relock();
+        ++d->stats.created;
+        locker.unlock();
+    }
+
+    Priv::Loan loan;
+
+    if (!uri.isEmpty()) {
+        ObjectPtr target;
+        if (uriPropertySet) {
+            target = uriElement.isEmpty() ? ElementPtr(pipeline)
+                                          : pipeline->getElementByName(uriElement.constData());
+        } else if (pipeline->findProperty(uriProperty.constData())) {
+            target = pipeline;
+        } else {
+            target = findElementWithProperty(GST_BIN(static_cast<GstPipeline*>(pipeline)),
+                                             uriProperty.constData());
+        }
+        d->applyOverride(target, uriProperty.constData(), QGlib::Value(uri), &loan);
+    }
+
+    for (PropertyHash::const_iterator it = properties.constBegin();
+         it != properties.constEnd(); ++it)
+    {
+        int dot = it.key().indexOf(QLatin1Char('.'));
+        QByteArray property = it.key().mid(dot + 1).toUtf8();
+        ObjectPtr target = dot < 0 ? ElementPtr(pipeline)
+            : pipeline->getElementByName(it.key().left(dot).toUtf8().constData());
+        d->applyOverride(target, property.constData(), it.value(), &loan);
+    }
+
+    d->startWatch(pipeline, &loan);
+
+    locker.relock();
+    d->loans.insert(pipeline, loan);
+    return pipeline;
+}
+
+void PipelinePool::release(const PipelinePtr & pipeline)
+{
+    if (!pipeline) {
+        return;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    QHash<GstPipeline*, Priv::Loan>::iterator it = d->loans.find(pipeline);
+    if (it == d->loans.end()) {
+        qWarning() << "PipelinePool: The pipeline was not acquired from this pool";
+        return;
+    }
+    Priv::Loan loan = it.value();
+    d->loans.erase(it);
+    locker.unlock();
+
+    d->stopWatch(&loan);
+
+    bool reusable = pipeline->setState(StateReady) != StateChangeFailure;
+
+    //drop the messages of the previous use
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+
+    for (int i = loan.overrides.size() - 1; i >= 0; --i) {
+        const Priv::Override & saved = loan.overrides.at(i);
+        saved.object->setProperty(saved.property.constData(), saved.value);
+    }
+
+    locker.relock();
+    if (reusable && d->available.size() < d->size) {
+        d->available.append(pipeline);
+        ++d->stats.recycled;
+        d->condition.wakeAll();
+        return;
+    }
+    locker.unlock();
+
+    pipeline->setState(StateNull);
+}
+
+PipelinePool::Statistics PipelinePool::statistics() const
+{
+    QMutexLocker locker(&d->mutex);
+    Statistics result = d->stats;
+    locker.unlock();
+
+    QMutexLocker metricsLocker(&d->metrics->mutex);
+    result.firstFrames = d->metrics->count;
+    if (d->metrics->count) {
+        result.lastTimeToFirstFrame = ClockTime::fromUSecs(d->metrics->last);
+        result.averageTimeToFirstFrame = ClockTime::fromUSecs(d->metrics->total / d->metrics->count);
+        result.maxTimeToFirstFrame = ClockTime::fromUSecs(d->metrics->max);
+    } else {
+        result.lastTimeToFirstFrame = ClockTime::None;
+        result.averageTimeToFirstFrame = ClockTime::None;
+        result.maxTimeToFirstFrame = ClockTime::None;
+    }
+    return result;
+}
+
+void PipelinePool::resetStatistics()
+{
+    QMutexLocker locker(&d->mutex);
+    d->stats.created = d->stats.acquired = d->stats.misses = d->stats.recycled = 0;
+    locker.unlock();
+
+    QMutexLocker metricsLocker(&d->metrics->mutex);
+    d->metrics->count = 0;
+    d->metrics->total = d->metrics->max = d->metrics->last = 0;
+}
+
+} //namespace Utils
+} //namespace QGst
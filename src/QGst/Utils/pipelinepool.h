@@ -0,0 +1,197 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_PIPELINEPOOL_H
+#define QGST_UTILS_PIPELINEPOOL_H
+
+#include "global.h"
+#include "../pipeline.h"
+#include "../clocktime.h"
+#include <QtCore/QHash>
+#include <QtCore/QSharedDataPointer>
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile pipelinepool.h <QGst/Utils/PipelineTemplate>
+ * \brief A pipeline description that is parsed once and instantiated many times
+ *
+ * Parse::launch() parses the description and looks up every factory by name each
+ * time it is called. A PipelineTemplate parses the description once, into a
+ * prototype pipeline, and records its elements, their factories, the properties
+ * that the description set and the links between them. create() then builds new
+ * pipelines directly from the recorded factories.
+ *
+ * Descriptions that the parser completes only at run time cannot be recorded: links
+ * to "sometimes" pads (for example "decodebin ! videoconvert"), links to request
+ * pads (for example "tee name=t t. ! queue") and bins written with parentheses.
+ * For those, create() parses the description again; isPrecompiled() tells which
+ * method is used. Either way, the description is validated once.
+ *
+ * fromDescription() keeps the templates in a process-wide cache, so that the
+ * description of a pipeline that is built repeatedly is only parsed the first time.
+ *
+ * \sa PipelinePool
+ */
+class QTGSTREAMERUTILS_EXPORT PipelineTemplate
+{
+public:
+    /*! Creates an invalid template */
+    PipelineTemplate();
+    PipelineTemplate(const PipelineTemplate & other);
+    virtual ~PipelineTemplate();
+
+    PipelineTemplate & operator=(const PipelineTemplate & other);
+
+    /*! \returns the template of \a description from the cache, parsing the
+     * description if it is not in the cache yet.
+     * \throws QGlib::Error when there was a problem parsing the description */
+    static PipelineTemplate fromDescription(const QString & description);
+
+    /*! Removes all templates from the cache. Templates that are still referenced
+     * stay valid. */
+    static void clearCache();
+
+    bool isValid() const;
+    QString description() const;
+
+    /*! \returns whether create() builds the pipeline from the recorded factories,
+     * instead of parsing the description again */
+    bool isPrecompiled() const;
+
+    /*! Builds a new pipeline in the null state. A description that does not
+     * describe a pipeline is put into a new one, as gst-launch does.
+     * \throws QGlib::Error if the description has to be parsed again and this fails */
+    PipelinePtr create() const;
+
+private:
+    struct Data;
+    QSharedDataPointer<Data> d;
+};
+
+
+/*! \headerfile pipelinepool.h <QGst/Utils/PipelinePool>
+ * \brief Keeps pipelines of a template constructed and in the ready state
+ *
+ * Building a pipeline and bringing it to the ready state opens devices, loads
+ * plugins and allocates resources, which is a large part of the time that passes
+ * before the first frame is shown. PipelinePool keeps size() pipelines of a
+ * PipelineTemplate ready, so that acquire() only has to set the URI and the
+ * properties that differ before the pipeline is started. When all the pipelines
+ * are taken, acquire() builds one on the spot and counts a miss.
+ *
+ * release() returns a pipeline to the pool: it is set back to the ready state, its
+ * bus is flushed and the URI and properties that acquire() changed are restored.
+ * Pipelines are built and brought to the ready state on a thread of
+ * QThreadPool::globalInstance(), to replace the ones that have been acquired.
+ *
+ * The time from acquire() to the first buffer that reaches a sink of the pipeline,
+ * or to the end of its preroll if no sink existed at the time of acquire() (as with
+ * playbin, which creates its sinks later), is measured and reported by statistics().
+ *
+ * \code
+ * QGst::Utils::PipelinePool pool(QGst::Utils::PipelineTemplate::fromDescription(
+ *         "uridecodebin name=dec ! videoconvert ! autovideosink"), 2);
+ *
+ * //switching channels
+ * pool.release(m_pipeline);
+ * m_pipeline = pool.acquire(channelUri);
+ * m_pipeline->setState(QGst::StatePlaying);
+ * \endcode
+ *
+ * \note All the functions of this class are thread-safe. Pipelines that are not
+ * released must be set to the null state by the caller.
+ */
+class QTGSTREAMERUTILS_EXPORT PipelinePool
+{
+public:
+    /*! Properties to set with acquire(). The keys are of the form "element.property",
+     * where element is the name of an element of the pipeline, or just "property"
+     * for a property of the pipeline itself. */
+    typedef QHash<QString, QGlib::Value> PropertyHash;
+
+    struct Statistics
+    {
+        /*! The number of pipelines that the pool has built */
+        quint64 created;
+        /*! The number of calls to acquire() */
+        quint64 acquired;
+        /*! The number of calls to acquire() that found no pipeline ready */
+        quint64 misses;
+        /*! The number of pipelines that release() put back in the pool */
+        quint64 recycled;
+        /*! The number of acquired pipelines whose first frame was measured */
+        quint64 firstFrames;
+        /*! The time to first frame of the last measured pipeline, or ClockTime::None */
+        ClockTime lastTimeToFirstFrame;
+        /*! The average time to first frame, or ClockTime::None */
+        ClockTime averageTimeToFirstFrame;
+        /*! The longest time to first frame, or ClockTime::None */
+        ClockTime maxTimeToFirstFrame;
+    };
+
+    /*! Creates a pool that keeps \a size pipelines of \a pipelineTemplate ready.
+     * The pipelines are built in the background; use waitForReady() to wait for them. */
+    explicit PipelinePool(const PipelineTemplate & pipelineTemplate, int size = 2);
+
+    /*! Waits for the pipelines that are being built and sets the ones that are in
+     * the pool to the null state. Acquired pipelines are not affected. */
+    virtual ~PipelinePool();
+
+    PipelineTemplate pipelineTemplate() const;
+
+    int size() const;
+    /*! Changes the number of pipelines that are kept ready. Pipelines are built
+     * or discarded to match the new size. */
+    void setSize(int size);
+
+    /*! \returns the number of pipelines that are ready to be acquired */
+    int availableCount() const;
+
+    /*! Blocks until size() pipelines are ready, or \a timeout has elapsed.
+     * \returns whether the pool is full */
+    bool waitForReady(ClockTime timeout = ClockTime::None) const;
+
+    /*! Sets the element and the property that acquire() sets the URI on. By default,
+     * this is the pipeline itself if it has a "uri" property (as playbin does),
+     * otherwise the first element of the pipeline that has one. */
+    void setUriProperty(const QString & elementName, const QString & property = QLatin1String("uri"));
+
+    /*! Takes a pipeline, in the ready state, out of the pool and sets \a uri and
+     * \a properties on it. An empty \a uri leaves the URI unchanged.
+     * \returns the pipeline, or a null pointer if none could be built */
+    PipelinePtr acquire(const QString & uri = QString(),
+                        const PropertyHash & properties = PropertyHash());
+
+    /*! Returns \a pipeline, which must have been acquired from this pool, to the
+     * pool. If the pool is full or the pipeline cannot be set to the ready state,
+     * the pipeline is set to the null state and dropped instead. */
+    void release(const PipelinePtr & pipeline);
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(PipelinePool)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_PIPELINEPOOL_H
@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "playbackstatusquery.h"
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+struct QTGSTREAMERUTILS_NO_EXPORT PlaybackStatusQuery::Priv
+{
+    Format format;
+    PositionQueryPtr position;
+    DurationQueryPtr duration;
+    BufferingQueryPtr buffering;
+};
+
+#endif //DOXYGEN_RUN
+
+PlaybackStatusQuery::PlaybackStatusQuery(Format format)
+    : d(new Priv)
+{
+    d->format = format;
+    d->position = PositionQuery::create(format);
+    d->duration = DurationQuery::create(format);
+    d->buffering = BufferingQuery::create(format);
+}
+
+PlaybackStatusQuery::~PlaybackStatusQuery()
+{
+    delete d;
+}
+
+Format PlaybackStatusQuery::format() const
+{
+    return d->format;
+}
+
+PlaybackStatusQuery::QueryTypes PlaybackStatusQuery::run(const ElementPtr & element,
+                                                         QueryTypes queries)
+{
+    QueryTypes answered;
+
+    if (!element) {
+        return answered;
+    }
+
+    //gst_element_query() is called directly to avoid converting
+    //each query to a temporary QueryPtr on every call
+    if (queries & Position) {
+        d->position->reset();
+        if (gst_element_query(element, d->position)) {
+            answered |= Position;
+        }
+    }
+
+    if (queries & Duration) {
+        d->duration->reset();
+        if (gst_element_query(element, d->duration)) {
+            answered |= Duration;
+        }
+    }
+
+    if (queries & Buffering) {
+        d->buffering->reset();
+        if (gst_element_query(element, d->buffering)) {
+            answered |= Buffering;
+        }
+    }
+
+    return answered;
+}
+
+qint64 PlaybackStatusQuery::position() const
+{
+    return d->position->position();
+}
+
+qint64 PlaybackStatusQuery::duration() const
+{
+    return d->duration->duration();
+}
+
+bool PlaybackStatusQuery::isBuffering() const
+{
+    return d->buffering->isBusy();
+}
+
+int PlaybackStatusQuery::bufferingPercent() const
+{
+    return d->buffering->percent();
+}
+
+PositionQueryPtr PlaybackStatusQuery::positionQuery() const
+{
+    return d->position;
+}
+
+DurationQueryPtr PlaybackStatusQuery::durationQuery() const
+{
+    return d->duration;
+}
+
+BufferingQueryPtr PlaybackStatusQuery::bufferingQuery() const
+{
+    return d->buffering;
+}
+
+} //namespace Utils
+} //namespace QGst
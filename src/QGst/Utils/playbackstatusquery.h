@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_PLAYBACKSTATUSQUERY_H
+#define QGST_UTILS_PLAYBACKSTATUSQUERY_H
+
+#include "global.h"
+#include "../element.h"
+#include "../query.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile playbackstatusquery.h <QGst/Utils/PlaybackStatusQuery>
+ * \brief Helper class for polling the position, duration and buffering state of a pipeline
+ *
+ * User interfaces usually poll the pipeline on a timer to update a position slider.
+ * Creating a new PositionQuery and DurationQuery on every tick allocates a GstQuery and
+ * a wrapper object for each of them. This class instead creates its queries only once
+ * and resets and re-issues them every time run() is called, so that polling does not
+ * allocate any memory.
+ *
+ * \code
+ * //in the constructor
+ * m_status = new QGst::Utils::PlaybackStatusQuery;
+ *
+ * //in the timer slot
+ * if (m_status->run(m_pipeline) & QGst::Utils::PlaybackStatusQuery::Position) {
+ *     m_slider->setValue(m_status->position() / QGst::ClockTime::fromMSecs(1));
+ * }
+ * \endcode
+ *
+ * The results of the last run() are available through position(), duration(),
+ * isBuffering() and bufferingPercent(), or directly from the underlying queries.
+ *
+ * \note This class is not thread-safe. Each thread that polls should use its own instance.
+ */
+class QTGSTREAMERUTILS_EXPORT PlaybackStatusQuery
+{
+public:
+    enum QueryType {
+        Position = 0x1,
+        Duration = 0x2,
+        Buffering = 0x4,
+        All = Position | Duration | Buffering
+    };
+    Q_DECLARE_FLAGS(QueryTypes, QueryType)
+
+    explicit PlaybackStatusQuery(Format format = FormatTime);
+    virtual ~PlaybackStatusQuery();
+
+    /*! \returns the format in which position and duration are queried */
+    Format format() const;
+
+    /*! Issues the given \a queries on \a element, which is usually the pipeline.
+     * \returns the subset of \a queries that were answered successfully */
+    QueryTypes run(const ElementPtr & element, QueryTypes queries = All);
+
+    /*! \returns the position from the last run(), or -1 if it is not known */
+    qint64 position() const;
+
+    /*! \returns the duration from the last run(), or -1 if it is not known */
+    qint64 duration() const;
+
+    /*! \returns whether the pipeline reported that it is buffering during the last run() */
+    bool isBuffering() const;
+
+    /*! \returns the buffering percentage from the last run() */
+    int bufferingPercent() const;
+
+    PositionQueryPtr positionQuery() const;
+    DurationQueryPtr durationQuery() const;
+    BufferingQueryPtr bufferingQuery() const;
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(PlaybackStatusQuery)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(QGst::Utils::PlaybackStatusQuery::QueryTypes)
+
+#endif // QGST_UTILS_PLAYBACKSTATUSQUERY_H
@@ -0,0 +1,526 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "positiontracker.h"
+#include "../clock.h"
+#include <QtCore/QDebug>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <gst/gst.h>
+#include <cstring>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* Everything position() needs in order to extrapolate the position.
+ * This is a plain struct so that it can be copied in the seqlock below. */
+struct Timing
+{
+    GstSegment segment;
+    GstClock *clock;
+    GstClockTime baseTime;
+    GstClockTime stoppedRunningTime;
+    GstClockTime latency;
+    GstClockTime frozenPosition;
+    bool hasSegment;
+    bool running;
+    bool frozen;
+    uint resyncCount;
+};
+
+} //anonymous namespace
+
+/* Shared between the tracker and its pad probe. The probe holds a reference, released
+ * by its destroy notify, which GStreamer calls only once the probe is no longer running,
+ * so that the tracker can be detached or destroyed while the pipeline is streaming. */
+struct QTGSTREAMERUTILS_NO_EXPORT PositionTracker::Priv
+{
+    struct ProbeContext
+    {
+        Priv *priv;
+        uint generation;
+    };
+
+    Priv();
+
+    void ref() { refCount.ref(); }
+    void unref() { if (!refCount.deref()) delete this; }
+
+    QAtomicInt refCount;
+
+    PipelinePtr pipeline;
+    ElementPtr sink;
+    bool autoSink;
+    GstPad *pad;
+    gulong probeId;
+    GstBus *bus;
+    gulong messageHandlerId;
+
+    //written by the streaming thread and the main thread, protected by writeMutex
+    QMutex writeMutex;
+    Timing state;
+    //incremented on every detach, so that a probe that is still running
+    //on the old pad does not touch the state of the new attachment
+    uint generation;
+
+    //keeps every clock that was ever published alive, since readers
+    //may still be using a clock pointer from an older snapshot
+    QList<ClockPtr> clocks;
+
+    //seqlock: odd while 'published' is being written
+    QAtomicInt sequence;
+    Timing published;
+
+    inline GstElement *pipelineElement() const
+    {
+        return GST_ELEMENT(static_cast<GstPipeline*>(pipeline));
+    }
+
+    Timing read() const;
+    void publish();
+    static GstClockTime computePosition(const Timing & timing);
+
+    void attachSink(const ElementPtr & element);
+    void detachSink();
+    void resync(bool thaw);
+    void queryLatency();
+    void handleSegment(GstEvent *event, uint fromGeneration);
+
+    static GstElement *findSink(GstBin *bin);
+    static GstPadProbeReturn eventProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static void destroyContext(gpointer user_data);
+    static void busMessage(GstBus *bus, GstMessage *message, gpointer user_data);
+};
+
+PositionTracker::Priv::Priv()
+    : refCount(1), autoSink(false), pad(NULL), probeId(0), bus(NULL), messageHandlerId(0),
+      generation(0)
+{
+    std::memset(&state, 0, sizeof(Timing));
+    gst_segment_init(&state.segment, GST_FORMAT_TIME);
+    state.baseTime = GST_CLOCK_TIME_NONE;
+    state.stoppedRunningTime = 0;
+    state.latency = 0;
+    state.frozenPosition = GST_CLOCK_TIME_NONE;
+    published = state;
+}
+
+Timing PositionTracker::Priv::read() const
+{
+    Timing timing;
+    QAtomicInt & seq = const_cast<QAtomicInt&>(sequence);
+
+    Q_FOREVER {
+#if QT_VERSION >= 0x050000
+        int before = seq.loadAcquire();
+#else
+        int before = seq.fetchAndAddAcquire(0);
+#endif
+        if (before & 1) {
+            continue; //a writer is in the middle of publish()
+        }
+
+        timing = published;
+
+        //full barrier, so that the copy above cannot be reordered after this load
+        if (seq.fetchAndAddOrdered(0) == before) {
+            return timing;
+        }
+    }
+}
+
+void PositionTracker::Priv::publish()
+{
+    //must be called with writeMutex locked
+    sequence.fetchAndAddOrdered(1);
+    published = state;
+    sequence.fetchAndAddOrdered(1);
+}
+
+//static
+GstClockTime PositionTracker::Priv::computePosition(const Timing & timing)
+{
+    if (!timing.hasSegment) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    if (timing.frozen) {
+        return timing.frozenPosition;
+    }
+
+    GstClockTime runningTime = timing.stoppedRunningTime;
+    if (timing.running && timing.clock && GST_CLOCK_TIME_IS_VALID(timing.baseTime)) {
+        runningTime = gst_clock_get_time(timing.clock) - timing.baseTime;
+    }
+
+    //the sink renders a buffer 'latency' after its running time
+    if (!GST_CLOCK_TIME_IS_VALID(runningTime) || runningTime > GstClockTime(G_MAXINT64)
+        || runningTime < timing.latency) {
+        runningTime = 0;
+    } else {
+        runningTime -= timing.latency;
+    }
+
+    const GstSegment *segment = &timing.segment;
+    guint64 position = gst_segment_to_position(segment, GST_FORMAT_TIME, runningTime);
+
+    if (position == guint64(-1)) {
+        //the running time is outside of the segment; clamp to its edges
+        bool beforeSegment = runningTime <= segment->base;
+        if ((segment->rate > 0) == beforeSegment || !GST_CLOCK_TIME_IS_VALID(segment->stop)) {
+            position = segment->start;
+        } else {
+            position = segment->stop;
+        }
+    }
+
+    guint64 streamTime = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, position);
+    return GST_CLOCK_TIME_IS_VALID(streamTime) ? streamTime : position;
+}
+
+void PositionTracker::Priv::attachSink(const ElementPtr & element)
+{
+    sink = element;
+    pad = gst_element_get_static_pad(sink, "sink");
+    if (!pad) {
+        qWarning() << "PositionTracker: the sink element has no \"sink\" pad";
+        return;
+    }
+
+    ProbeContext *context = new ProbeContext;
+    context->priv = this;
+    {
+        QMutexLocker lock(&writeMutex);
+        context->generation = generation;
+    }
+    ref();
+    probeId = gst_pad_add_probe(pad,
+            GstPadProbeType(GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+            &Priv::eventProbe, context, &Priv::destroyContext);
+
+    //the segment may have already gone through, pick it up from the sticky events
+    GstEvent *event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (event) {
+        handleSegment(event, context->generation);
+        gst_event_unref(event);
+    }
+}
+
+void PositionTracker::Priv::detachSink()
+{
+    {
+        QMutexLocker lock(&writeMutex);
+        generation++;
+    }
+
+    if (pad) {
+        if (probeId) {
+            gst_pad_remove_probe(pad, probeId);
+            probeId = 0;
+        }
+        gst_object_unref(pad);
+        pad = NULL;
+    }
+    sink.clear();
+}
+
+void PositionTracker::Priv::resync(bool thaw)
+{
+    GstState current = GST_STATE_NULL;
+    gst_element_get_state(pipelineElement(), &current, NULL, 0);
+
+    GstClock *clock = gst_element_get_clock(pipelineElement());
+
+    QMutexLocker lock(&writeMutex);
+    if (clock && clock != state.clock) {
+        clocks.append(ClockPtr::wrap(clock, false));
+        state.clock = clock;
+    } else if (clock) {
+        gst_object_unref(clock);
+    }
+
+    state.running = (current == GST_STATE_PLAYING);
+    state.baseTime = gst_element_get_base_time(pipelineElement());
+    state.stoppedRunningTime = gst_element_get_start_time(pipelineElement());
+    if (current <= GST_STATE_READY) {
+        state.hasSegment = false;
+        thaw = true;
+    }
+    if (thaw) {
+        state.frozen = false;
+    }
+    state.resyncCount++;
+    publish();
+}
+
+void PositionTracker::Priv::queryLatency()
+{
+    GstQuery *query = gst_query_new_latency();
+    if (gst_element_query(pipelineElement(), query)) {
+        gboolean live;
+        GstClockTime minLatency;
+        gst_query_parse_latency(query, &live, &minLatency, NULL);
+
+        QMutexLocker lock(&writeMutex);
+        state.latency = GST_CLOCK_TIME_IS_VALID(minLatency) ? minLatency : 0;
+        publish();
+    }
+    gst_query_unref(query);
+}
+
+void PositionTracker::Priv::handleSegment(GstEvent *event, uint fromGeneration)
+{
+    const GstSegment *segment;
+    gst_event_parse_segment(event, &segment);
+    if (segment->format != GST_FORMAT_TIME) {
+        return;
+    }
+
+    QMutexLocker lock(&writeMutex);
+    if (fromGeneration != generation) {
+        return;
+    }
+    gst_segment_copy_into(segment, &state.segment);
+    state.hasSegment = true;
+
+    //after a flush the base time is only valid again once the pipeline has
+    //prerolled, so keep showing the start of the new segment until then
+    if (state.frozen) {
+        guint64 start = segment->rate > 0 ? segment->start : segment->stop;
+        if (!GST_CLOCK_TIME_IS_VALID(start)) {
+            start = segment->start;
+        }
+        state.frozenPosition = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, start);
+    }
+    state.resyncCount++;
+    publish();
+}
+
+//static
+GstElement *PositionTracker::Priv::findSink(GstBin *bin)
+{
+    GstIterator *it = gst_bin_iterate_sinks(bin);
+    GValue item = G_VALUE_INIT;
+    GstElement *found = NULL;
+    bool done = false;
+
+    while (!done && !found) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+        {
+            GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+            if (GST_IS_BIN(element)) {
+                found = findSink(GST_BIN(element));
+            } else {
+                found = GST_ELEMENT(gst_object_ref(element));
+            }
+            g_value_reset(&item);
+            break;
+        }
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return found;
+}
+
+//static
+GstPadProbeReturn PositionTracker::Priv::eventProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                    gpointer user_data)
+{
+    Q_UNUSED(pad);
+    const ProbeContext *context = static_cast<const ProbeContext*>(user_data);
+    Priv *d = context->priv;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+
+    switch (GST_EVENT_TYPE(event)) {
+    case GST_EVENT_FLUSH_START:
+    {
+        QMutexLocker lock(&d->writeMutex);
+        if (context->generation == d->generation && !d->state.frozen) {
+            d->state.frozenPosition = computePosition(d->state);
+            d->state.frozen = true;
+            d->publish();
+        }
+        break;
+    }
+    case GST_EVENT_SEGMENT:
+        d->handleSegment(event, context->generation);
+        break;
+    default:
+        break;
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+//static
+void PositionTracker::Priv::destroyContext(gpointer user_data)
+{
+    ProbeContext *context = static_cast<ProbeContext*>(user_data);
+    context->priv->unref();
+    delete context;
+}
+
+//static
+void PositionTracker::Priv::busMessage(GstBus *bus, GstMessage *message, gpointer user_data)
+{
+    Q_UNUSED(bus);
+    Priv *d = static_cast<Priv*>(user_data);
+
+    switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_STATE_CHANGED:
+        if (GST_MESSAGE_SRC(message) == GST_OBJECT(d->pipelineElement())) {
+            GstState newState;
+            gst_message_parse_state_changed(message, NULL, &newState, NULL);
+
+            if (d->autoSink && !d->pad && newState >= GST_STATE_PAUSED) {
+                GstElement *sink = findSink(GST_BIN(d->pipelineElement()));
+                if (sink) {
+                    d->attachSink(ElementPtr::wrap(sink, false));
+                }
+            }
+            d->resync(false);
+        }
+        break;
+    case GST_MESSAGE_ASYNC_DONE:
+        //a flushing seek is complete once the pipeline has prerolled again
+        d->queryLatency();
+        d->resync(true);
+        break;
+    case GST_MESSAGE_LATENCY:
+        d->queryLatency();
+        break;
+    case GST_MESSAGE_NEW_CLOCK:
+        d->resync(false);
+        break;
+    case GST_MESSAGE_BUFFERING:
+    {
+        gint percent;
+        gst_message_parse_buffering(message, &percent);
+        if (percent >= 100) {
+            d->resync(false);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+#endif //DOXYGEN_RUN
+
+
+PositionTracker::PositionTracker()
+    : d(new Priv)
+{
+}
+
+PositionTracker::~PositionTracker()
+{
+    setPipeline(PipelinePtr());
+    d->unref();
+}
+
+PipelinePtr PositionTracker::pipeline() const
+{
+    return d->pipeline;
+}
+
+ElementPtr PositionTracker::sink() const
+{
+    return d->sink;
+}
+
+void PositionTracker::setPipeline(const PipelinePtr & pipeline, const ElementPtr & sink)
+{
+    if (d->bus) {
+        g_signal_handler_disconnect(d->bus, d->messageHandlerId);
+        gst_bus_remove_signal_watch(d->bus);
+        gst_object_unref(d->bus);
+        d->bus = NULL;
+        d->messageHandlerId = 0;
+    }
+    d->detachSink();
+
+    {
+        QMutexLocker lock(&d->writeMutex);
+        d->state.hasSegment = false;
+        d->state.running = false;
+        d->state.frozen = false;
+        d->state.clock = NULL;
+        d->state.latency = 0;
+        d->publish();
+        d->clocks.clear();
+    }
+
+    d->pipeline = pipeline;
+    d->autoSink = !sink;
+    if (!pipeline) {
+        return;
+    }
+
+    d->bus = gst_element_get_bus(d->pipelineElement());
+    gst_bus_add_signal_watch(d->bus);
+    d->messageHandlerId = g_signal_connect(d->bus, "message",
+                                           G_CALLBACK(&Priv::busMessage), d);
+
+    if (sink) {
+        d->attachSink(sink);
+    } else {
+        GstElement *found = Priv::findSink(GST_BIN(d->pipelineElement()));
+        if (found) {
+            d->attachSink(ElementPtr::wrap(found, false));
+        }
+    }
+
+    d->queryLatency();
+    d->resync(true);
+}
+
+bool PositionTracker::isValid() const
+{
+    return d->read().hasSegment;
+}
+
+ClockTime PositionTracker::position() const
+{
+    return Priv::computePosition(d->read());
+}
+
+double PositionTracker::rate() const
+{
+    return d->read().segment.rate;
+}
+
+uint PositionTracker::resyncCount() const
+{
+    return d->read().resyncCount;
+}
+
+} //namespace Utils
+} //namespace QGst
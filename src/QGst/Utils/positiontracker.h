@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_POSITIONTRACKER_H
+#define QGST_UTILS_POSITIONTRACKER_H
+
+#include "global.h"
+#include "../pipeline.h"
+#include "../clocktime.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile positiontracker.h <QGst/Utils/PositionTracker>
+ * \brief Helper class for reading the playback position without querying the pipeline
+ *
+ * A PositionQuery travels through the sink chain and takes several element locks,
+ * which makes it expensive to issue at display refresh rate. PositionTracker instead
+ * watches the segment events that reach a sink and the state changes of the pipeline,
+ * and extrapolates the current stream position from the pipeline's clock, the same way
+ * the sink itself synchronizes its rendering.
+ *
+ * The tracker resynchronizes whenever the timeline is interrupted: on flushing seeks,
+ * on new segments (which also carry rate changes), on state changes, on clock changes,
+ * when the pipeline finishes buffering and when its latency changes. Between those
+ * discontinuities position() does not touch the pipeline at all; it only reads a
+ * snapshot of the timing information, without taking any lock, and asks the clock
+ * for the current time.
+ *
+ * \code
+ * m_tracker = new QGst::Utils::PositionTracker;
+ * m_tracker->setPipeline(m_pipeline);
+ * ...
+ * //in a slot that runs on every frame
+ * m_slider->setValue(m_tracker->position() / QGst::ClockTime::fromMSecs(1));
+ * \endcode
+ *
+ * If no sink is passed to setPipeline(), the tracker follows the first sink element that
+ * it finds inside the pipeline, even if it is created later, as it is the case with playbin.
+ *
+ * \note The tracker listens to the pipeline's bus through a signal watch, so the thread
+ * that owns the default GMainContext (normally the Qt main thread) must run an event loop.
+ * position(), rate() and isValid() may be called from any thread. setPipeline() must
+ * not be called while another thread is reading the position.
+ */
+class QTGSTREAMERUTILS_EXPORT PositionTracker
+{
+public:
+    PositionTracker();
+    virtual ~PositionTracker();
+
+    /*! \returns the pipeline that is being tracked */
+    PipelinePtr pipeline() const;
+
+    /*! \returns the sink element whose segment is being followed */
+    ElementPtr sink() const;
+
+    /*! Starts tracking \a pipeline, following the segments that reach \a sink.
+     * If \a sink is null, a sink is discovered automatically. Passing a null
+     * \a pipeline stops tracking. */
+    void setPipeline(const PipelinePtr & pipeline, const ElementPtr & sink = ElementPtr());
+
+    /*! \returns whether a segment has been received, i.e. whether position() can be computed */
+    bool isValid() const;
+
+    /*! \returns the current stream position, or ClockTime::None if it is not known */
+    ClockTime position() const;
+
+    /*! \returns the playback rate of the current segment */
+    double rate() const;
+
+    /*! \returns the number of times the tracker had to resynchronize. This can be
+     * used to detect discontinuities, for example to avoid animating across a seek. */
+    uint resyncCount() const;
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(PositionTracker)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_POSITIONTRACKER_H
@@ -0,0 +1,455 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "reconfigurator.h"
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+struct QTGSTREAMERUTILS_NO_EXPORT Reconfigurator::Priv
+{
+    //runs an operation on QThreadPool::globalInstance(); it is deleted by the pool,
+    //so nothing touches Priv after finish() has released the waiters
+    struct Worker : public QRunnable
+    {
+        Worker(Priv *d) : d(d) {}
+        virtual void run() { d->run(); }
+        Priv *const d;
+    };
+
+    Priv(Reconfigurator *q);
+
+    bool start(GstPad *upstreamPad, GstElement *oldElement, GstElement *newElement);
+    void run();
+    void finish(const Report & report);
+    bool waitUntil(const bool & flag, gint64 deadline);
+
+    static GstPadProbeReturn blockProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn eosProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn bufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+
+    Reconfigurator *const q;
+
+    mutable QMutex mutex;
+    mutable QWaitCondition condition;
+    gint64 timeout;
+    bool busy;
+    Report lastReport;
+
+    //the current operation; only touched by the worker thread once started,
+    //except for the flags and times, which are protected by the mutex
+    GstPad *upstream;
+    GstPad *downstream;
+    GstElement *oldElement;
+    GstElement *newElement;
+    GstBin *bin;
+    gulong blockProbeId;
+    gulong bufferProbeId;
+
+    bool isBlocked;
+    bool isDrained;
+    bool waitingFirstBuffer;
+    bool hasFirstBuffer;
+    gint64 blockTime;
+    gint64 lastBufferTime;
+    gint64 firstBufferTime;
+};
+
+Reconfigurator::Priv::Priv(Reconfigurator *reconfigurator)
+    : q(reconfigurator), timeout(2 * G_USEC_PER_SEC), busy(false),
+      upstream(NULL), downstream(NULL), oldElement(NULL), newElement(NULL), bin(NULL),
+      blockProbeId(0), bufferProbeId(0)
+{
+    lastReport.success = false;
+    lastReport.drained = false;
+    lastReport.blockedTime = ClockTime::None;
+    lastReport.gap = ClockTime::None;
+}
+
+bool Reconfigurator::Priv::start(GstPad *upstreamPad, GstElement *oldElem, GstElement *newElem)
+{
+    QMutexLocker locker(&mutex);
+    if (busy) {
+        qWarning() << "Reconfigurator: An operation is already in progress";
+        return false;
+    }
+
+    GstPad *peer = upstreamPad ? gst_pad_get_peer(upstreamPad) : NULL;
+    GstElement *reference = oldElem ? GST_ELEMENT(gst_object_ref(oldElem))
+                                    : (upstreamPad ? gst_pad_get_parent_element(upstreamPad) : NULL);
+    GstObject *parent = reference ? gst_object_get_parent(GST_OBJECT(reference)) : NULL;
+    if (reference) {
+        gst_object_unref(reference);
+    }
+
+    if (!peer || !parent || !GST_IS_BIN(parent)
+            || (newElem && GST_OBJECT_PARENT(newElem) != NULL)) {
+        qWarning() << "Reconfigurator: The elements must be linked inside a bin"
+                      " and the new element must not be in a bin";
+        if (peer) {
+            gst_object_unref(peer);
+        }
+        if (parent) {
+            gst_object_unref(parent);
+        }
+        return false;
+    }
+
+    upstream = GST_PAD(gst_object_ref(upstreamPad));
+    downstream = peer;
+    bin = GST_BIN(parent);
+    oldElement = oldElem ? GST_ELEMENT(gst_object_ref(oldElem)) : NULL;
+    newElement = newElem ? GST_ELEMENT(gst_object_ref(newElem)) : NULL;
+
+    if (oldElement) {
+        //the pads around the old element, not the pads of the old element
+        GstPad *oldSrc = gst_element_get_static_pad(oldElement, "src");
+        GstPad *oldPeer = oldSrc ? gst_pad_get_peer(oldSrc) : NULL;
+        if (oldSrc) {
+            gst_object_unref(oldSrc);
+        }
+        gst_object_unref(downstream);
+        downstream = oldPeer;
+        if (!downstream) {
+            qWarning() << "Reconfigurator: The element is not linked downstream";
+            gst_object_unref(upstream);
+            gst_object_unref(bin);
+            gst_object_unref(oldElement);
+            if (newElement) {
+                gst_object_unref(newElement);
+            }
+            upstream = NULL;
+            bin = NULL;
+            oldElement = newElement = NULL;
+            return false;
+        }
+    }
+
+    busy = true;
+    isBlocked = isDrained = waitingFirstBuffer = hasFirstBuffer = false;
+    blockTime = lastBufferTime = firstBufferTime = 0;
+
+    bufferProbeId = gst_pad_add_probe(downstream,
+            GstPadProbeType(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+            &Priv::bufferProbe, this, NULL);
+    blockProbeId = gst_pad_add_probe(upstream, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM,
+                                     &Priv::blockProbe, this, NULL);
+
+    QThreadPool::globalInstance()->start(new Worker(this));
+    return true;
+}
+
+bool Reconfigurator::Priv::waitUntil(const bool & flag, gint64 deadline)
+{
+    while (!flag) {
+        gint64 remaining = deadline - g_get_monotonic_time();
+        if (remaining <= 0) {
+            return false;
+        }
+        condition.wait(&mutex, static_cast<unsigned long>((remaining + 999) / 1000));
+    }
+    return true;
+}
+
+void Reconfigurator::Priv::run()
+{
+    Report report;
+    report.success = false;
+    report.drained = false;
+    report.blockedTime = ClockTime::None;
+    report.gap = ClockTime::None;
+
+    mutex.lock();
+    const gint64 wait = timeout;
+    bool blocked = waitUntil(isBlocked, g_get_monotonic_time() + wait);
+    mutex.unlock();
+
+    if (!blocked) {
+        qWarning() << "Reconfigurator: No data reached the upstream pad";
+        gst_pad_remove_probe(upstream, blockProbeId);
+        gst_pad_remove_probe(downstream, bufferProbeId);
+        finish(report);
+        return;
+    }
+
+    q->blocked();
+
+    if (oldElement) {
+        GstPad *oldSink = gst_element_get_static_pad(oldElement, "sink");
+        GstPad *oldSrc = gst_element_get_static_pad(oldElement, "src");
+
+        //push the data held by the old element out, then drop its EOS
+        gulong eosProbeId = gst_pad_add_probe(oldSrc, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                                              &Priv::eosProbe, this, NULL);
+        gst_pad_send_event(oldSink, gst_event_new_eos());
+
+        mutex.lock();
+        report.drained = waitUntil(isDrained, g_get_monotonic_time() + wait);
+        mutex.unlock();
+        gst_pad_remove_probe(oldSrc, eosProbeId);
+
+        gst_pad_unlink(upstream, oldSink);
+        gst_pad_unlink(oldSrc, downstream);
+        gst_object_unref(oldSink);
+        gst_object_unref(oldSrc);
+
+        //flushes the element if it did not drain
+        gst_element_set_state(oldElement, GST_STATE_NULL);
+        gst_bin_remove(bin, oldElement);
+    } else {
+        report.drained = true;
+        gst_pad_unlink(upstream, downstream);
+    }
+
+    if (newElement) {
+        gst_bin_add(bin, newElement);
+        GstPad *newSink = gst_element_get_static_pad(newElement, "sink");
+        GstPad *newSrc = gst_element_get_static_pad(newElement, "src");
+        report.success = newSink && newSrc
+                && GST_PAD_LINK_SUCCESSFUL(gst_pad_link(upstream, newSink))
+                && GST_PAD_LINK_SUCCESSFUL(gst_pad_link(newSrc, downstream));
+        if (newSink) {
+            gst_object_unref(newSink);
+        }
+        if (newSrc) {
+            gst_object_unref(newSrc);
+        }
+        gst_element_sync_state_with_parent(newElement);
+    } else {
+        report.success = GST_PAD_LINK_SUCCESSFUL(gst_pad_link(upstream, downstream));
+    }
+
+    if (!report.success) {
+        qWarning() << "Reconfigurator: Failed to link the new element";
+    }
+
+    mutex.lock();
+    waitingFirstBuffer = true;
+    mutex.unlock();
+
+    gst_pad_remove_probe(upstream, blockProbeId);
+    const gint64 unblockTime = g_get_monotonic_time();
+
+    mutex.lock();
+    report.blockedTime = ClockTime::fromUSecs(unblockTime - blockTime);
+    if (report.success && waitUntil(hasFirstBuffer, unblockTime + wait) && lastBufferTime) {
+        report.gap = ClockTime::fromUSecs(firstBufferTime - lastBufferTime);
+    }
+    mutex.unlock();
+
+    gst_pad_remove_probe(downstream, bufferProbeId);
+    finish(report);
+}
+
+void Reconfigurator::Priv::finish(const Report & report)
+{
+    gst_object_unref(upstream);
+    gst_object_unref(downstream);
+    gst_object_unref(bin);
+    if (oldElement) {
+        gst_object_unref(oldElement);
+    }
+    if (newElement) {
+        gst_object_unref(newElement);
+    }
+    upstream = downstream = NULL;
+    oldElement = newElement = NULL;
+    bin = NULL;
+
+    q->finished(report);
+
+    QMutexLocker locker(&mutex);
+    lastReport = report;
+    busy = false;
+    condition.wakeAll();
+}
+
+//static
+GstPadProbeReturn Reconfigurator::Priv::blockProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                   gpointer user_data)
+{
+    Q_UNUSED(pad);
+    Q_UNUSED(info);
+    Priv *self = static_cast<Priv*>(user_data);
+
+    QMutexLocker locker(&self->mutex);
+    if (!self->isBlocked) {
+        self->isBlocked = true;
+        self->blockTime = g_get_monotonic_time();
+        self->condition.wakeAll();
+    }
+    //stay blocked until the worker removes the probe
+    return GST_PAD_PROBE_OK;
+}
+
+//static
+GstPadProbeReturn Reconfigurator::Priv::eosProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                 gpointer user_data)
+{
+    Q_UNUSED(pad);
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_EOS) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    Priv *self = static_cast<Priv*>(user_data);
+    QMutexLocker locker(&self->mutex);
+    self->isDrained = true;
+    self->condition.wakeAll();
+    return GST_PAD_PROBE_DROP;
+}
+
+//static
+GstPadProbeReturn Reconfigurator::Priv::bufferProbe(GstPad *pad, GstPadProbeInfo *info,
+                                                    gpointer user_data)
+{
+    Q_UNUSED(pad);
+    Q_UNUSED(info);
+    Priv *self = static_cast<Priv*>(user_data);
+    const gint64 now = g_get_monotonic_time();
+
+    QMutexLocker locker(&self->mutex);
+    if (!self->waitingFirstBuffer) {
+        self->lastBufferTime = now;
+    } else if (!self->hasFirstBuffer) {
+        self->hasFirstBuffer = true;
+        self->firstBufferTime = now;
+        self->condition.wakeAll();
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+#endif //DOXYGEN_RUN
+
+
+Reconfigurator::Reconfigurator()
+    : d(new Priv(this))
+{
+}
+
+Reconfigurator::~Reconfigurator()
+{
+    waitForFinished();
+    delete d;
+}
+
+ClockTime Reconfigurator::drainTimeout() const
+{
+    QMutexLocker locker(&d->mutex);
+    return ClockTime::fromUSecs(d->timeout);
+}
+
+void Reconfigurator::setDrainTimeout(ClockTime timeout)
+{
+    QMutexLocker locker(&d->mutex);
+    d->timeout = timeout.isValid() ? gint64(timeout / 1000) : G_MAXINT64 / 2;
+}
+
+bool Reconfigurator::replace(const ElementPtr & oldElement, const ElementPtr & newElement)
+{
+    if (!oldElement || !newElement) {
+        return false;
+    }
+
+    GstPad *sink = gst_element_get_static_pad(oldElement, "sink");
+    GstPad *upstream = sink ? gst_pad_get_peer(sink) : NULL;
+    bool started = upstream && d->start(upstream, oldElement, newElement);
+    if (upstream) {
+        gst_object_unref(upstream);
+    }
+    if (sink) {
+        gst_object_unref(sink);
+    }
+    return started;
+}
+
+bool Reconfigurator::insert(const PadPtr & srcPad, const ElementPtr & element)
+{
+    if (!srcPad || !element) {
+        return false;
+    }
+    return d->start(srcPad, NULL, element);
+}
+
+bool Reconfigurator::remove(const ElementPtr & element)
+{
+    if (!element) {
+        return false;
+    }
+
+    GstPad *sink = gst_element_get_static_pad(element, "sink");
+    GstPad *upstream = sink ? gst_pad_get_peer(sink) : NULL;
+    bool started = upstream && d->start(upstream, element, NULL);
+    if (upstream) {
+        gst_object_unref(upstream);
+    }
+    if (sink) {
+        gst_object_unref(sink);
+    }
+    return started;
+}
+
+bool Reconfigurator::isBusy() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->busy;
+}
+
+bool Reconfigurator::waitForFinished(ClockTime timeout) const
+{
+    QMutexLocker locker(&d->mutex);
+    if (!timeout.isValid()) {
+        while (d->busy) {
+            d->condition.wait(&d->mutex);
+        }
+        return true;
+    }
+
+    const gint64 deadline = g_get_monotonic_time() + gint64(timeout / 1000);
+    while (d->busy) {
+        gint64 remaining = deadline - g_get_monotonic_time();
+        if (remaining <= 0) {
+            return false;
+        }
+        d->condition.wait(&d->mutex, static_cast<unsigned long>((remaining + 999) / 1000));
+    }
+    return true;
+}
+
+Reconfigurator::Report Reconfigurator::lastReport() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->lastReport;
+}
+
+void Reconfigurator::blocked()
+{
+}
+
+void Reconfigurator::finished(const Report & report)
+{
+    Q_UNUSED(report);
+}
+
+} //namespace Utils
+} //namespace QGst
@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_RECONFIGURATOR_H
+#define QGST_UTILS_RECONFIGURATOR_H
+
+#include "global.h"
+#include "../element.h"
+#include "../pad.h"
+#include "../clocktime.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile reconfigurator.h <QGst/Utils/Reconfigurator>
+ * \brief Helper class for changing the elements of a running pipeline
+ *
+ * Reconfigurator replaces, inserts or removes an element in a playing pipeline,
+ * without stopping it, using the sequence recommended by GStreamer for dynamic
+ * pipelines:
+ *
+ * \li The source pad upstream of the change is blocked with a probe, as soon as
+ * the next buffer reaches it.
+ * \li When an element is replaced or removed, an EOS event is sent into it and
+ * dropped when it comes out, so that the data it holds (for example the frames
+ * buffered by an encoder) is pushed downstream before it goes away. If the EOS
+ * does not come out within drainTimeout(), the element is flushed instead.
+ * \li The old element is unlinked, set to the null state and removed from its bin;
+ * the new one is added, linked and brought to the state of its bin.
+ * \li The upstream pad is unblocked. The sticky events (stream-start, caps and
+ * segment) are sent again to the new element before the next buffer.
+ *
+ * The work is done on a thread of QThreadPool::globalInstance(), since an element
+ * cannot be stopped from its own streaming thread; the functions that start an
+ * operation return immediately. Only one operation may run at a time.
+ *
+ * blocked() and finished() are called from that thread. finished() reports how
+ * long the upstream pad was blocked and the gap that the downstream element saw
+ * between the last buffer before the change and the first one after it.
+ *
+ * \code
+ * class EncoderSwitch : public QGst::Utils::Reconfigurator
+ * {
+ * protected:
+ *     virtual void finished(const Report & report)
+ *     {
+ *         qDebug() << "encoder replaced, gap" << report.gap / 1000 << "us";
+ *     }
+ * };
+ *
+ * m_switch.replace(m_encoder, newEncoder);
+ * \endcode
+ *
+ * \note Data must be flowing through the upstream pad for the operation to start.
+ * The elements must have exactly one always "sink" pad and one always "src" pad.
+ */
+class QTGSTREAMERUTILS_EXPORT Reconfigurator
+{
+public:
+    /*! The outcome of an operation */
+    struct Report
+    {
+        /*! Whether the new links could be made */
+        bool success;
+        /*! Whether the old element delivered its data before it was removed */
+        bool drained;
+        /*! How long the upstream pad was blocked */
+        ClockTime blockedTime;
+        /*! The time between the last buffer that reached the downstream pad before
+         * the change and the first one after it, or ClockTime::None if no buffer
+         * arrived within drainTimeout() */
+        ClockTime gap;
+    };
+
+    Reconfigurator();
+    virtual ~Reconfigurator();
+
+    /*! \returns how long to wait for the upstream pad to block, for the old element
+     * to drain and for the first buffer after the change. The default is 2 seconds. */
+    ClockTime drainTimeout() const;
+    void setDrainTimeout(ClockTime timeout);
+
+    /*! Replaces \a oldElement, which must be linked on both sides, with
+     * \a newElement, which must not be in a bin. */
+    bool replace(const ElementPtr & oldElement, const ElementPtr & newElement);
+
+    /*! Inserts \a element between \a srcPad and its peer.
+     * This can be used, for example, to insert a tee. */
+    bool insert(const PadPtr & srcPad, const ElementPtr & element);
+
+    /*! Removes \a element and links its neighbours directly. */
+    bool remove(const ElementPtr & element);
+
+    /*! \returns whether an operation is in progress */
+    bool isBusy() const;
+
+    /*! Blocks until the current operation has finished or \a timeout has elapsed.
+     * \returns whether no operation is in progress */
+    bool waitForFinished(ClockTime timeout = ClockTime::None) const;
+
+    /*! \returns the report of the last operation that finished */
+    Report lastReport() const;
+
+protected:
+    /*! Called once the upstream pad is blocked, before the old element is drained.
+     * Nothing flows into the affected part of the pipeline until this returns.
+     * The default implementation does nothing. */
+    virtual void blocked();
+
+    /*! Called when an operation has finished, after the first buffer following
+     * the change has reached the downstream pad, or after drainTimeout().
+     * The default implementation does nothing. */
+    virtual void finished(const Report & report);
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(Reconfigurator)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_RECONFIGURATOR_H
@@ -0,0 +1,356 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "samplering.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+inline int loadAcquire(const QAtomicInt & value)
+{
+    QAtomicInt & v = const_cast<QAtomicInt&>(value);
+#if QT_VERSION >= 0x050000
+    return v.loadAcquire();
+#else
+    return v.fetchAndAddAcquire(0);
+#endif
+}
+
+inline GstSample *loadAcquire(const QAtomicPointer<GstSample> & value)
+{
+    QAtomicPointer<GstSample> & v = const_cast<QAtomicPointer<GstSample>&>(value);
+#if QT_VERSION >= 0x050000
+    return v.loadAcquire();
+#else
+    return v.fetchAndAddAcquire(0);
+#endif
+}
+
+} //anonymous namespace
+
+/* head is only advanced by the streaming thread and tail by pop(), except that
+ * the DropOldest policy lets the streaming thread advance tail as well. Both
+ * sides advance tail with a compare-and-swap and only touch the sample they read
+ * from the slot after winning it, so a sample is never released twice. */
+struct QTGSTREAMERUTILS_NO_EXPORT SampleRing::Priv
+{
+public:
+    Priv(int capacity, OverflowPolicy policy);
+    ~Priv();
+
+    bool tryPop(GstSample **sample);
+    void wake();
+    void updateMaximumOccupancy(int value);
+    static bool isFlushing(SampleRing *self);
+
+    int capacity;
+    int mask;
+    QAtomicPointer<GstSample> *slots;
+    QAtomicInt head;
+    QAtomicInt tail;
+    QAtomicInt policy;
+    QAtomicInt eos;
+
+    //waiting for room or for samples; only used when the ring is full or empty
+    QMutex waitMutex;
+    QWaitCondition waitCondition;
+    QAtomicInt waiters;
+
+    QAtomicInt pushed;
+    QAtomicInt popped;
+    QAtomicInt dropped;
+    QAtomicInt maximumOccupancy;
+    mutable QMutex statsMutex;
+    qint64 producerWaitTime;
+    qint64 consumerWaitTime;
+};
+
+SampleRing::Priv::Priv(int requestedCapacity, OverflowPolicy overflowPolicy)
+    : head(0), tail(0), policy(overflowPolicy), eos(0), waiters(0),
+      pushed(0), popped(0), dropped(0), maximumOccupancy(0),
+      producerWaitTime(0), consumerWaitTime(0)
+{
+    //a power of two, so that the indices can wrap around
+    capacity = 1;
+    while (capacity < requestedCapacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    slots = new QAtomicPointer<GstSample>[capacity];
+}
+
+SampleRing::Priv::~Priv()
+{
+    GstSample *sample;
+    while (tryPop(&sample)) {
+        gst_sample_unref(sample);
+    }
+    delete [] slots;
+}
+
+bool SampleRing::Priv::tryPop(GstSample **sample)
+{
+    Q_FOREVER {
+        int t = loadAcquire(tail);
+        if (t == loadAcquire(head)) {
+            return false;
+        }
+
+        GstSample *s = loadAcquire(slots[t & mask]);
+        if (tail.testAndSetOrdered(t, t + 1)) {
+            *sample = s;
+            return true;
+        }
+        //the streaming thread dropped this sample in the meantime
+    }
+}
+
+void SampleRing::Priv::wake()
+{
+    //full barrier, so that a waiter either sees the new head/tail or is counted here
+    if (waiters.fetchAndAddOrdered(0) > 0) {
+        QMutexLocker lock(&waitMutex);
+        waitCondition.wakeAll();
+    }
+}
+
+void SampleRing::Priv::updateMaximumOccupancy(int value)
+{
+    Q_FOREVER {
+        int current = loadAcquire(maximumOccupancy);
+        if (value <= current || maximumOccupancy.testAndSetOrdered(current, value)) {
+            return;
+        }
+    }
+}
+
+//static
+bool SampleRing::Priv::isFlushing(SampleRing *self)
+{
+    ElementPtr sink = self->element();
+    GstPad *pad = sink ? gst_element_get_static_pad(sink, "sink") : NULL;
+    if (!pad) {
+        return true;
+    }
+    bool flushing = GST_PAD_IS_FLUSHING(pad);
+    gst_object_unref(pad);
+    return flushing;
+}
+
+#endif //DOXYGEN_RUN
+
+
+SampleRing::SampleRing(int capacity, OverflowPolicy policy)
+    : ApplicationSink(), d(new Priv(capacity, policy))
+{
+}
+
+SampleRing::~SampleRing()
+{
+    delete d;
+}
+
+int SampleRing::capacity() const
+{
+    return d->capacity;
+}
+
+SampleRing::OverflowPolicy SampleRing::overflowPolicy() const
+{
+    return static_cast<OverflowPolicy>(loadAcquire(d->policy));
+}
+
+void SampleRing::setOverflowPolicy(OverflowPolicy policy)
+{
+    d->policy.fetchAndStoreRelease(policy);
+    //let a blocked streaming thread re-evaluate the policy
+    d->wake();
+}
+
+SamplePtr SampleRing::pop(int timeout)
+{
+    GstSample *sample = NULL;
+
+    if (!d->tryPop(&sample) && timeout != 0) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QMutexLocker lock(&d->waitMutex);
+        d->waiters.fetchAndAddOrdered(1);
+        while (!d->tryPop(&sample) && !loadAcquire(d->eos)) {
+            if (timeout < 0) {
+                d->waitCondition.wait(&d->waitMutex);
+            } else {
+                qint64 remaining = timeout - timer.elapsed();
+                if (remaining <= 0) {
+                    break;
+                }
+                d->waitCondition.wait(&d->waitMutex, static_cast<unsigned long>(remaining));
+            }
+        }
+        d->waiters.fetchAndAddOrdered(-1);
+        lock.unlock();
+
+        QMutexLocker statsLock(&d->statsMutex);
+        d->consumerWaitTime += timer.nsecsElapsed() / 1000;
+    }
+
+    if (sample) {
+        d->popped.fetchAndAddRelaxed(1);
+        d->wake(); //there is room for a blocked streaming thread now
+    }
+    return SamplePtr::wrap(sample, false);
+}
+
+int SampleRing::occupancy() const
+{
+    return loadAcquire(d->head) - loadAcquire(d->tail);
+}
+
+int SampleRing::maximumOccupancy() const
+{
+    return loadAcquire(d->maximumOccupancy);
+}
+
+uint SampleRing::pushedCount() const
+{
+    return loadAcquire(d->pushed);
+}
+
+uint SampleRing::poppedCount() const
+{
+    return loadAcquire(d->popped);
+}
+
+uint SampleRing::droppedCount() const
+{
+    return loadAcquire(d->dropped);
+}
+
+qint64 SampleRing::producerWaitTime() const
+{
+    QMutexLocker lock(&d->statsMutex);
+    return d->producerWaitTime;
+}
+
+qint64 SampleRing::consumerWaitTime() const
+{
+    QMutexLocker lock(&d->statsMutex);
+    return d->consumerWaitTime;
+}
+
+void SampleRing::resetStatistics()
+{
+    d->pushed.fetchAndStoreOrdered(0);
+    d->popped.fetchAndStoreOrdered(0);
+    d->dropped.fetchAndStoreOrdered(0);
+    d->maximumOccupancy.fetchAndStoreOrdered(occupancy());
+
+    QMutexLocker lock(&d->statsMutex);
+    d->producerWaitTime = 0;
+    d->consumerWaitTime = 0;
+}
+
+void SampleRing::eos()
+{
+    d->eos.fetchAndStoreOrdered(1);
+    //wake up pop(), which returns once the ring is empty
+    QMutexLocker lock(&d->waitMutex);
+    d->waitCondition.wakeAll();
+}
+
+FlowReturn SampleRing::newSample()
+{
+    SamplePtr pulled = pullSample();
+    if (!pulled) {
+        return FlowOk;
+    }
+
+    GstSample *sample = gst_sample_ref(pulled);
+    d->eos.fetchAndStoreRelaxed(0);
+
+    //only this thread advances head
+    const int h = loadAcquire(d->head);
+
+    Q_FOREVER {
+        const int t = loadAcquire(d->tail);
+        if (h - t < d->capacity) {
+            break;
+        }
+
+        switch (overflowPolicy()) {
+        case DropNewest:
+            gst_sample_unref(sample);
+            d->dropped.fetchAndAddRelaxed(1);
+            return FlowOk;
+
+        case DropOldest:
+        {
+            GstSample *oldest = loadAcquire(d->slots[t & d->mask]);
+            if (d->tail.testAndSetOrdered(t, t + 1)) {
+                gst_sample_unref(oldest);
+                d->dropped.fetchAndAddRelaxed(1);
+            }
+            break;
+        }
+
+        case Block:
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            //poll for flushing, so that stopping the pipeline does not dead-lock
+            bool flushing = false;
+            QMutexLocker lock(&d->waitMutex);
+            d->waiters.fetchAndAddOrdered(1);
+            while (h - loadAcquire(d->tail) >= d->capacity && overflowPolicy() == Block
+                   && !(flushing = Priv::isFlushing(this))) {
+                d->waitCondition.wait(&d->waitMutex, 50);
+            }
+            d->waiters.fetchAndAddOrdered(-1);
+            lock.unlock();
+
+            QMutexLocker statsLock(&d->statsMutex);
+            d->producerWaitTime += timer.nsecsElapsed() / 1000;
+            statsLock.unlock();
+
+            if (flushing) {
+                gst_sample_unref(sample);
+                return FlowFlushing;
+            }
+            break;
+        }
+        }
+    }
+
+    d->slots[h & d->mask].fetchAndStoreRelease(sample);
+    d->head.fetchAndStoreRelease(h + 1);
+    d->pushed.fetchAndAddRelaxed(1);
+    d->updateMaximumOccupancy(h + 1 - loadAcquire(d->tail));
+    d->wake();
+    return FlowOk;
+}
+
+} //namespace Utils
+} //namespace QGst
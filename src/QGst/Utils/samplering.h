@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_SAMPLERING_H
+#define QGST_UTILS_SAMPLERING_H
+
+#include "applicationsink.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile samplering.h <QGst/Utils/SampleRing>
+ * \brief Helper class for handing samples from the streaming thread to one consumer thread
+ *
+ * SampleRing is an ApplicationSink that moves every new sample into a bounded ring buffer,
+ * from where a single consumer thread takes it with pop(). Only references move through
+ * the ring, the sample data is never copied, and neither side takes a lock as long as the
+ * ring is neither empty nor full. This keeps a slow consumer, such as an inference worker,
+ * from contending with the streaming thread on the appsink queue lock.
+ *
+ * When the ring is full, overflowPolicy() decides what happens to a new sample:
+ * \li DropOldest discards the oldest queued sample, so that the consumer always gets the
+ * most recent ones. This is the default.
+ * \li DropNewest discards the new sample.
+ * \li Block makes the streaming thread wait until the consumer has made room. It stops
+ * waiting when the sink starts flushing, for example when the pipeline is stopped.
+ *
+ * occupancy(), droppedCount() and the wait times can be read from any thread to see
+ * whether the consumer keeps up.
+ *
+ * \note pop() must only ever be called from one thread at a time.
+ */
+class QTGSTREAMERUTILS_EXPORT SampleRing : public ApplicationSink
+{
+public:
+    enum OverflowPolicy {
+        DropOldest,
+        DropNewest,
+        Block
+    };
+
+    /*! Creates a ring that holds at least \a capacity samples. The capacity is
+     * rounded up to the next power of two. */
+    explicit SampleRing(int capacity = 8, OverflowPolicy policy = DropOldest);
+    virtual ~SampleRing();
+
+    /*! \returns the number of samples that the ring can hold */
+    int capacity() const;
+
+    OverflowPolicy overflowPolicy() const;
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    /*! Takes the oldest sample from the ring, waiting up to \a timeout milliseconds
+     * for one to arrive. A negative timeout waits until a sample arrives or the sink
+     * reaches end-of-stream. \returns a null SamplePtr if no sample arrived in time */
+    SamplePtr pop(int timeout = -1);
+
+    /*! \returns the number of samples that are currently queued */
+    int occupancy() const;
+
+    /*! \returns the highest occupancy() since the last resetStatistics() */
+    int maximumOccupancy() const;
+
+    /*! \returns the number of samples that have been put in the ring */
+    uint pushedCount() const;
+
+    /*! \returns the number of samples that have been taken with pop() */
+    uint poppedCount() const;
+
+    /*! \returns the number of samples that were discarded because the ring was full */
+    uint droppedCount() const;
+
+    /*! \returns the time, in microseconds, that the streaming thread spent
+     * waiting for room with the Block policy */
+    qint64 producerWaitTime() const;
+
+    /*! \returns the time, in microseconds, that pop() spent waiting for samples */
+    qint64 consumerWaitTime() const;
+
+    void resetStatistics();
+
+protected:
+    virtual void eos();
+    virtual FlowReturn newSample();
+
+private:
+    struct Priv;
+    friend struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(SampleRing)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_SAMPLERING_H
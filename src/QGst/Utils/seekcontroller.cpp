@@ -0,0 +1,423 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "seekcontroller.h"
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <gst/gst.h>
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+struct SeekRequest
+{
+    SeekRequest() : valid(false), hasPosition(false), position(GST_CLOCK_TIME_NONE), rate(1.0) {}
+
+    bool valid;
+    bool hasPosition;
+    GstClockTime position;
+    double rate;
+    QElapsedTimer timer;
+};
+
+/* How long to wait before asking again for the position of a rate change */
+const guint RetryInterval = 50; //ms
+
+} //anonymous namespace
+
+struct QTGSTREAMERUTILS_NO_EXPORT SeekController::Priv
+{
+    Priv(SeekController *q);
+
+    SeekController *const q;
+    ElementPtr element;
+    GstBus *bus;
+    gulong messageHandlerId;
+    guint timeoutSourceId;
+    guint retrySourceId;
+    guint seekTimeout; //ms, 0 to wait forever
+
+    Mode mode;
+    double trickModeThreshold;
+    double rate;
+
+    bool seeking;
+    bool inFlightAccurate;
+    SeekRequest inFlight;
+    SeekRequest pending;
+
+    uint requestCount;
+    uint seekCount;
+    uint completedCount;
+    qint64 lastLatency;
+    qint64 totalLatency;
+    qint64 maximumLatency;
+
+    void request(bool hasPosition, GstClockTime position);
+    void send(SeekRequest & request, bool accurate);
+    void seekDone();
+    void seekAborted();
+    void removeSources();
+
+    static void busMessage(GstBus *bus, GstMessage *message, gpointer user_data);
+    static gboolean seekTimedOut(gpointer user_data);
+    static gboolean retry(gpointer user_data);
+};
+
+SeekController::Priv::Priv(SeekController *q)
+    : q(q), bus(NULL), messageHandlerId(0), timeoutSourceId(0), retrySourceId(0),
+      seekTimeout(2000), mode(SeekController::Adaptive),
+      trickModeThreshold(2.0), rate(1.0), seeking(false), inFlightAccurate(false),
+      requestCount(0), seekCount(0), completedCount(0),
+      lastLatency(0), totalLatency(0), maximumLatency(0)
+{
+}
+
+void SeekController::Priv::request(bool hasPosition, GstClockTime position)
+{
+    requestCount++;
+
+    //merge with the queued request; a rate change keeps the queued position
+    if (!pending.valid) {
+        pending.valid = true;
+        pending.hasPosition = false;
+        pending.timer.start();
+    } else if (hasPosition) {
+        //the latency is measured from the request that is going to be displayed
+        pending.timer.start();
+    }
+    if (hasPosition) {
+        pending.hasPosition = true;
+        pending.position = position;
+    }
+    pending.rate = rate;
+
+    if (!seeking) {
+        //nothing is in flight, so the user is not dragging (yet)
+        send(pending, mode != SeekController::Fast);
+    }
+}
+
+void SeekController::Priv::send(SeekRequest & request, bool accurate)
+{
+    if (!element) {
+        request = SeekRequest();
+        return;
+    }
+
+    SeekRequest r = request;
+    GstElement *e = element;
+    if (!r.hasPosition) {
+        gint64 current;
+        if (!gst_element_query_position(e, GST_FORMAT_TIME, &current)) {
+            //the pipeline may not be prerolled yet; keep the request and try again
+            if (&request == &pending && !retrySourceId) {
+                retrySourceId = g_timeout_add(RetryInterval, &Priv::retry, this);
+            }
+            return;
+        }
+        r.position = current;
+    }
+    request = SeekRequest();
+
+    int flags = GST_SEEK_FLAG_FLUSH;
+    if (accurate) {
+        flags |= GST_SEEK_FLAG_ACCURATE;
+    } else {
+        flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST;
+    }
+    if (qAbs(r.rate) > trickModeThreshold) {
+        flags |= GST_SEEK_FLAG_SKIP;
+    }
+
+    gboolean ok;
+    if (r.rate >= 0) {
+        //reset the stop position that a reverse seek may have left behind
+        ok = gst_element_seek(e, r.rate, GST_FORMAT_TIME, GstSeekFlags(flags),
+                              GST_SEEK_TYPE_SET, r.position,
+                              GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE);
+    } else {
+        ok = gst_element_seek(e, r.rate, GST_FORMAT_TIME, GstSeekFlags(flags),
+                              GST_SEEK_TYPE_SET, 0,
+                              GST_SEEK_TYPE_SET, r.position);
+    }
+
+    if (ok) {
+        seekCount++;
+        seeking = true;
+        inFlightAccurate = accurate;
+        inFlight = r;
+        inFlight.hasPosition = true;
+        //not every pipeline posts ASYNC_DONE after a seek, live ones in particular
+        if (seekTimeout) {
+            timeoutSourceId = g_timeout_add(seekTimeout, &Priv::seekTimedOut, this);
+        }
+    } else {
+        qWarning() << "SeekController: the seek was not handled by the element";
+    }
+}
+
+void SeekController::Priv::seekDone()
+{
+    SeekRequest done = inFlight;
+    bool doneAccurate = inFlightAccurate;
+    seeking = false;
+    inFlight = SeekRequest();
+    if (timeoutSourceId) {
+        g_source_remove(timeoutSourceId);
+        timeoutSourceId = 0;
+    }
+
+    qint64 latency = done.timer.elapsed();
+    lastLatency = latency;
+    totalLatency += latency;
+    maximumLatency = qMax(maximumLatency, latency);
+    completedCount++;
+
+    if (pending.valid) {
+        //the user is scrubbing; keyframes are the fastest frames to show
+        send(pending, mode == SeekController::Accurate);
+    } else if (mode == SeekController::Adaptive && !doneAccurate) {
+        //the cursor stopped moving; land exactly on the last requested position
+        SeekRequest refine = done;
+        refine.timer.start();
+        send(refine, true);
+    }
+
+    q->seekCompleted(done.position, latency);
+}
+
+void SeekController::Priv::seekAborted()
+{
+    //the seek is not going to complete; do not block the following requests
+    seeking = false;
+    inFlight = SeekRequest();
+    if (timeoutSourceId) {
+        g_source_remove(timeoutSourceId);
+        timeoutSourceId = 0;
+    }
+
+    if (pending.valid) {
+        send(pending, mode != SeekController::Fast);
+    }
+}
+
+void SeekController::Priv::removeSources()
+{
+    if (timeoutSourceId) {
+        g_source_remove(timeoutSourceId);
+        timeoutSourceId = 0;
+    }
+    if (retrySourceId) {
+        g_source_remove(retrySourceId);
+        retrySourceId = 0;
+    }
+}
+
+//static
+void SeekController::Priv::busMessage(GstBus *bus, GstMessage *message, gpointer user_data)
+{
+    Q_UNUSED(bus);
+    Priv *d = static_cast<Priv*>(user_data);
+
+    switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_ASYNC_DONE:
+        if (d->seeking) {
+            d->seekDone();
+        }
+        break;
+    case GST_MESSAGE_ERROR:
+        if (d->seeking) {
+            d->seekAborted();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+//static
+gboolean SeekController::Priv::seekTimedOut(gpointer user_data)
+{
+    Priv *d = static_cast<Priv*>(user_data);
+    d->timeoutSourceId = 0;
+    qWarning() << "SeekController: the seek did not complete within" << d->seekTimeout << "ms";
+    d->seekAborted();
+    return FALSE;
+}
+
+//static
+gboolean SeekController::Priv::retry(gpointer user_data)
+{
+    Priv *d = static_cast<Priv*>(user_data);
+    d->retrySourceId = 0;
+    if (!d->seeking && d->pending.valid) {
+        d->send(d->pending, d->mode != SeekController::Fast);
+    }
+    return FALSE;
+}
+
+#endif //DOXYGEN_RUN
+
+
+SeekController::SeekController()
+    : d(new Priv(this))
+{
+}
+
+SeekController::~SeekController()
+{
+    setElement(ElementPtr());
+    delete d;
+}
+
+ElementPtr SeekController::element() const
+{
+    return d->element;
+}
+
+void SeekController::setElement(const ElementPtr & pipeline)
+{
+    if (d->bus) {
+        g_signal_handler_disconnect(d->bus, d->messageHandlerId);
+        gst_bus_remove_signal_watch(d->bus);
+        gst_object_unref(d->bus);
+        d->bus = NULL;
+        d->messageHandlerId = 0;
+    }
+    d->removeSources();
+
+    d->element = pipeline;
+    d->seeking = false;
+    d->inFlight = SeekRequest();
+    d->pending = SeekRequest();
+
+    if (pipeline) {
+        d->bus = gst_element_get_bus(pipeline);
+        if (d->bus) {
+            gst_bus_add_signal_watch(d->bus);
+            d->messageHandlerId = g_signal_connect(d->bus, "message",
+                                                   G_CALLBACK(&Priv::busMessage), d);
+        } else {
+            qWarning() << "SeekController: the element has no bus; is it in a pipeline?";
+        }
+    }
+}
+
+SeekController::Mode SeekController::mode() const
+{
+    return d->mode;
+}
+
+void SeekController::setMode(Mode mode)
+{
+    d->mode = mode;
+}
+
+double SeekController::trickModeThreshold() const
+{
+    return d->trickModeThreshold;
+}
+
+void SeekController::setTrickModeThreshold(double rate)
+{
+    d->trickModeThreshold = qAbs(rate);
+}
+
+ClockTime SeekController::seekTimeout() const
+{
+    return d->seekTimeout ? ClockTime::fromMSecs(d->seekTimeout) : ClockTime(ClockTime::None);
+}
+
+void SeekController::setSeekTimeout(ClockTime timeout)
+{
+    d->seekTimeout = timeout.isValid() ? static_cast<guint>(qMax<quint64>(timeout / GST_MSECOND, 1)) : 0;
+}
+
+void SeekController::seek(ClockTime position)
+{
+    d->request(true, position);
+}
+
+double SeekController::rate() const
+{
+    return d->rate;
+}
+
+void SeekController::setRate(double rate)
+{
+    Q_ASSERT(rate != 0);
+    d->rate = rate;
+    d->request(false, GST_CLOCK_TIME_NONE);
+}
+
+bool SeekController::isSeeking() const
+{
+    return d->seeking;
+}
+
+ClockTime SeekController::pendingPosition() const
+{
+    return d->pending.valid && d->pending.hasPosition ? d->pending.position : ClockTime::None;
+}
+
+uint SeekController::requestCount() const
+{
+    return d->requestCount;
+}
+
+uint SeekController::seekCount() const
+{
+    return d->seekCount;
+}
+
+qint64 SeekController::lastLatency() const
+{
+    return d->lastLatency;
+}
+
+qint64 SeekController::averageLatency() const
+{
+    return d->completedCount ? d->totalLatency / d->completedCount : 0;
+}
+
+qint64 SeekController::maximumLatency() const
+{
+    return d->maximumLatency;
+}
+
+void SeekController::resetStatistics()
+{
+    d->requestCount = 0;
+    d->seekCount = 0;
+    d->completedCount = 0;
+    d->lastLatency = 0;
+    d->totalLatency = 0;
+    d->maximumLatency = 0;
+}
+
+void SeekController::seekCompleted(ClockTime position, qint64 latency)
+{
+    Q_UNUSED(position);
+    Q_UNUSED(latency);
+}
+
+} //namespace Utils
+} //namespace QGst
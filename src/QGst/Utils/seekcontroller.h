@@ -0,0 +1,146 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_SEEKCONTROLLER_H
+#define QGST_UTILS_SEEKCONTROLLER_H
+
+#include "global.h"
+#include "../element.h"
+#include "../clocktime.h"
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile seekcontroller.h <QGst/Utils/SeekController>
+ * \brief Helper class for seeking interactively, for example from a timeline slider
+ *
+ * Element::seek() sends a flushing seek immediately. When the user drags a slider,
+ * dozens of such seeks are sent every second, and since each of them has to flush
+ * the pipeline and preroll a new frame, they queue up and the video ends up lagging
+ * far behind the cursor.
+ *
+ * SeekController keeps at most one seek in flight. Requests made with seek() while
+ * a seek is in progress are coalesced: only the newest one is remembered, and it is
+ * sent as soon as the pipeline has prerolled the previous one (i.e. it has posted an
+ * ASYNC_DONE message), which is also the moment when the frame of the previous seek
+ * is on the screen.
+ *
+ * In the Adaptive mode, which is the default, seeks that are sent while the user is
+ * still moving the cursor snap to the nearest keyframe, which is much faster to decode.
+ * When no newer request arrives, one final accurate seek is sent to land exactly on
+ * the last requested position. The Fast and Accurate modes always use keyframe or
+ * accurate seeks respectively.
+ *
+ * setRate() changes the playback rate from the current position. Rates whose absolute
+ * value is higher than trickModeThreshold() also ask the decoders to skip frames.
+ *
+ * The time from each seek request to the display of the corresponding frame, i.e. until
+ * the sinks have prerolled it, is measured and is available through lastLatency(),
+ * averageLatency() and maximumLatency(). It is also passed to seekCompleted(), which can
+ * be reimplemented to be notified.
+ *
+ * A seek that is rejected by the element, that causes an error, or that does not complete
+ * within seekTimeout() (some pipelines, live ones in particular, do not post ASYNC_DONE)
+ * no longer holds back the queued request. A rate change whose current position cannot be
+ * queried yet, because the pipeline has not prerolled, is retried until it can.
+ *
+ * \note The controller listens to the bus of the element through a signal watch, so
+ * it must be used from the thread that owns the default GMainContext, normally the
+ * Qt main thread.
+ */
+class QTGSTREAMERUTILS_EXPORT SeekController
+{
+public:
+    enum Mode {
+        Adaptive,
+        Fast,
+        Accurate
+    };
+
+    SeekController();
+    virtual ~SeekController();
+
+    /*! \returns the element that receives the seeks */
+    ElementPtr element() const;
+
+    /*! Sets the element that receives the seeks. This is normally the
+     * pipeline, since the controller needs to watch its bus. */
+    void setElement(const ElementPtr & pipeline);
+
+    /*! \returns the mode used to choose the seek flags */
+    Mode mode() const;
+    void setMode(Mode mode);
+
+    /*! \returns the absolute rate above which the decoders are asked to skip frames */
+    double trickModeThreshold() const;
+    void setTrickModeThreshold(double rate);
+
+    /*! \returns how long to wait for a seek to complete before the next queued request
+     * is sent anyway. The default is 2 seconds. */
+    ClockTime seekTimeout() const;
+    /*! Sets the seek timeout. ClockTime::None waits forever. */
+    void setSeekTimeout(ClockTime timeout);
+
+    /*! Requests a seek to \a position, in stream time. If a seek is already
+     * in progress, the request is queued and replaces any earlier queued request. */
+    void seek(ClockTime position);
+
+    /*! \returns the rate of the last rate change request */
+    double rate() const;
+
+    /*! Requests the playback rate to be changed to \a rate from the current
+     * position. Negative rates play backwards. This is coalesced like seek(). */
+    void setRate(double rate);
+
+    /*! \returns true while a seek has been sent and has not completed yet */
+    bool isSeeking() const;
+
+    /*! \returns the position of the queued request, or ClockTime::None if there is none */
+    ClockTime pendingPosition() const;
+
+    /*! \returns the number of seek() and setRate() calls */
+    uint requestCount() const;
+
+    /*! \returns the number of seeks that were actually sent to the element */
+    uint seekCount() const;
+
+    /*! \returns the time, in milliseconds, between the request of the last
+     * completed seek and the display of its frame */
+    qint64 lastLatency() const;
+
+    /*! \returns the average of the seek latencies since the last resetStatistics() */
+    qint64 averageLatency() const;
+
+    /*! \returns the maximum seek latency since the last resetStatistics() */
+    qint64 maximumLatency() const;
+
+    void resetStatistics();
+
+protected:
+    /*! Called when the pipeline has prerolled the frame of a seek to \a position,
+     * \a latency milliseconds after it was requested. */
+    virtual void seekCompleted(ClockTime position, qint64 latency);
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(SeekController)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_SEEKCONTROLLER_H
@@ -0,0 +1,473 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "taskpool.h"
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <gst/gst.h>
+#include <cstring>
+#ifdef Q_OS_UNIX
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* The settings of a TaskPool, owned by its GstTaskPool instance, since
+ * tasks keep a reference to the GstTaskPool after the TaskPool is gone. */
+struct TaskPoolConfig
+{
+    TaskPoolConfig() : threadPool(NULL), priority(0), active(0), started(0) {}
+
+    mutable QMutex mutex;
+    QThreadPool *threadPool;
+    QList<int> cpus;
+    int priority;
+
+    QAtomicInt active;
+    QAtomicInt started;
+};
+
+/* Returned by push() and waited for in join(). One reference is held by the
+ * runnable and one by the task, which releases it by joining. */
+struct TaskHandle
+{
+    TaskHandle() : done(false), refCount(2) {}
+
+    void finish()
+    {
+        QMutexLocker locker(&mutex);
+        done = true;
+        condition.wakeAll();
+    }
+
+    void wait()
+    {
+        QMutexLocker locker(&mutex);
+        while (!done) {
+            condition.wait(&mutex);
+        }
+    }
+
+    void unref()
+    {
+        if (!refCount.deref()) {
+            delete this;
+        }
+    }
+
+    QMutex mutex;
+    QWaitCondition condition;
+    bool done;
+    QAtomicInt refCount;
+};
+
+QAtomicInt s_priorityWarned;
+
+} //anonymous namespace
+
+#endif //DOXYGEN_RUN
+
+} //namespace Utils
+} //namespace QGst
+
+//*** GstTaskPool subclass ***
+
+#ifndef DOXYGEN_RUN
+
+typedef struct _QGstUtilsTaskPool QGstUtilsTaskPool;
+typedef struct _QGstUtilsTaskPoolClass QGstUtilsTaskPoolClass;
+
+struct _QGstUtilsTaskPool
+{
+    GstTaskPool parent;
+    QGst::Utils::TaskPoolConfig *config;
+};
+
+struct _QGstUtilsTaskPoolClass
+{
+    GstTaskPoolClass parent_class;
+};
+
+G_DEFINE_TYPE(QGstUtilsTaskPool, qgst_utils_task_pool, GST_TYPE_TASK_POOL)
+
+#define QGST_UTILS_TASK_POOL(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), qgst_utils_task_pool_get_type(), QGstUtilsTaskPool))
+
+namespace QGst {
+namespace Utils {
+namespace {
+
+class TaskRunnable : public QRunnable
+{
+public:
+    TaskRunnable(QGstUtilsTaskPool *pool, GstTaskPoolFunction func, gpointer data,
+                 TaskHandle *handle)
+        : m_pool(QGST_UTILS_TASK_POOL(gst_object_ref(pool))),
+          m_func(func), m_data(data), m_handle(handle)
+    {
+        QMutexLocker locker(&pool->config->mutex);
+        m_cpus = pool->config->cpus;
+        m_priority = pool->config->priority;
+    }
+
+    virtual ~TaskRunnable()
+    {
+        /* QThreadPool deletes the runnable while it holds its lock and only releases the
+         * lock once the thread is idle, so a task that is pushed after join() returns
+         * finds this thread available. */
+        m_handle->finish();
+        m_handle->unref();
+        gst_object_unref(m_pool);
+    }
+
+    virtual void run();
+
+private:
+    QGstUtilsTaskPool *m_pool;
+    GstTaskPoolFunction m_func;
+    gpointer m_data;
+    TaskHandle *m_handle;
+    QList<int> m_cpus;
+    int m_priority;
+};
+
+void TaskRunnable::run()
+{
+    //the worker thread is shared with other pools, so every
+    //setting that is changed here is restored afterwards
+#ifdef Q_OS_LINUX
+    cpu_set_t oldCpus;
+    bool restoreCpus = false;
+    if (!m_cpus.isEmpty() && pthread_getaffinity_np(pthread_self(), sizeof(oldCpus), &oldCpus) == 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        Q_FOREACH(int cpu, m_cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        restoreCpus = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+        if (!restoreCpus) {
+            qWarning() << "TaskPool: Failed to set the CPU affinity to" << m_cpus;
+        }
+    }
+#endif
+
+#ifdef Q_OS_UNIX
+    int oldPolicy;
+    sched_param oldParam;
+    bool restoreScheduling = false;
+    if (m_priority > 0 && pthread_getschedparam(pthread_self(), &oldPolicy, &oldParam) == 0) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = m_priority;
+        restoreScheduling = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+        if (!restoreScheduling && s_priorityWarned.testAndSetRelaxed(0, 1)) {
+            qWarning() << "TaskPool: Failed to set the realtime priority" << m_priority
+                       << "- running streaming threads with normal priority";
+        }
+    }
+#endif
+
+    m_pool->config->active.ref();
+    m_func(m_data);
+    m_pool->config->active.deref();
+
+#ifdef Q_OS_UNIX
+    if (restoreScheduling) {
+        pthread_setschedparam(pthread_self(), oldPolicy, &oldParam);
+    }
+#endif
+#ifdef Q_OS_LINUX
+    if (restoreCpus) {
+        pthread_setaffinity_np(pthread_self(), sizeof(oldCpus), &oldCpus);
+    }
+#endif
+}
+
+} //anonymous namespace
+} //namespace Utils
+} //namespace QGst
+
+static void qgst_utils_task_pool_prepare(GstTaskPool *pool, GError **error)
+{
+    //the QThreadPool is ready to be used at all times
+    Q_UNUSED(pool);
+    Q_UNUSED(error);
+}
+
+static void qgst_utils_task_pool_cleanup(GstTaskPool *pool)
+{
+    Q_UNUSED(pool);
+}
+
+static gpointer qgst_utils_task_pool_push(GstTaskPool *pool, GstTaskPoolFunction func,
+                                          gpointer user_data, GError **error)
+{
+    using namespace QGst::Utils;
+
+    QGstUtilsTaskPool *self = QGST_UTILS_TASK_POOL(pool);
+    QThreadPool *threadPool = self->config->threadPool;
+    if (!threadPool) {
+        g_set_error(error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED, "No thread pool");
+        return NULL;
+    }
+
+    /* A task keeps its thread until it is stopped, so a task that waited in the queue
+     * for a free thread could wait forever, stalling its pipeline and any join() on it.
+     * Failing makes the element fail its state change instead. */
+    TaskHandle *handle = new TaskHandle;
+    TaskRunnable *runnable = new TaskRunnable(self, func, user_data, handle);
+    if (!threadPool->tryStart(runnable)) {
+        delete runnable;
+        handle->unref();
+        g_set_error(error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+                    "All %d threads of the thread pool are busy", threadPool->maxThreadCount());
+        return NULL;
+    }
+
+    self->config->started.ref();
+    return handle;
+}
+
+static void qgst_utils_task_pool_join(GstTaskPool *pool, gpointer id)
+{
+    Q_UNUSED(pool);
+    QGst::Utils::TaskHandle *handle = static_cast<QGst::Utils::TaskHandle*>(id);
+    handle->wait();
+    handle->unref();
+}
+
+static void qgst_utils_task_pool_finalize(GObject *object)
+{
+    delete QGST_UTILS_TASK_POOL(object)->config;
+    G_OBJECT_CLASS(qgst_utils_task_pool_parent_class)->finalize(object);
+}
+
+static void qgst_utils_task_pool_class_init(QGstUtilsTaskPoolClass *klass)
+{
+    GObjectClass *objectClass = G_OBJECT_CLASS(klass);
+    GstTaskPoolClass *poolClass = GST_TASK_POOL_CLASS(klass);
+
+    objectClass->finalize = qgst_utils_task_pool_finalize;
+    poolClass->prepare = qgst_utils_task_pool_prepare;
+    poolClass->cleanup = qgst_utils_task_pool_cleanup;
+    poolClass->push = qgst_utils_task_pool_push;
+    poolClass->join = qgst_utils_task_pool_join;
+}
+
+static void qgst_utils_task_pool_init(QGstUtilsTaskPool *self)
+{
+    self->config = new QGst::Utils::TaskPoolConfig;
+}
+
+#endif //DOXYGEN_RUN
+
+//*** TaskPool ***
+
+namespace QGst {
+namespace Utils {
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+class SharedThreadPool : public QThreadPool
+{
+public:
+    SharedThreadPool()
+    {
+        setMaxThreadCount(qMax(1, QThread::idealThreadCount()) * 8);
+    }
+};
+
+bool setPoolOnTask(GstMessage *message, GstTaskPool *pool)
+{
+    GstStreamStatusType type;
+    gst_message_parse_stream_status(message, &type, NULL);
+    if (type != GST_STREAM_STATUS_TYPE_CREATE) {
+        return false;
+    }
+
+    const GValue *object = gst_message_get_stream_status_object(message);
+    if (!object || !G_VALUE_HOLDS(object, GST_TYPE_TASK)) {
+        return false;
+    }
+
+    gst_task_set_pool(GST_TASK(g_value_get_object(object)), pool);
+    return true;
+}
+
+void streamStatusHandler(GstBus *bus, GstMessage *message, gpointer user_data)
+{
+    Q_UNUSED(bus);
+    setPoolOnTask(message, GST_TASK_POOL(user_data));
+}
+
+} //anonymous namespace
+
+Q_GLOBAL_STATIC(SharedThreadPool, s_sharedThreadPool)
+
+struct QTGSTREAMERUTILS_NO_EXPORT TaskPool::Priv
+{
+    struct Installation
+    {
+        GstElement *pipeline;
+        GstBus *bus;
+        gulong handlerId;
+    };
+
+    QGstUtilsTaskPool *pool;
+    QList<Installation> installations;
+
+    void uninstall(const Installation & installation);
+};
+
+void TaskPool::Priv::uninstall(const Installation & installation)
+{
+    g_signal_handler_disconnect(installation.bus, installation.handlerId);
+    gst_bus_disable_sync_message_emission(installation.bus);
+    gst_object_unref(installation.bus);
+}
+
+#endif //DOXYGEN_RUN
+
+
+TaskPool::TaskPool(QThreadPool *threadPool)
+    : d(new Priv)
+{
+    d->pool = QGST_UTILS_TASK_POOL(g_object_new(qgst_utils_task_pool_get_type(), NULL));
+    gst_object_ref_sink(d->pool);
+    d->pool->config->threadPool = threadPool ? threadPool : sharedThreadPool();
+}
+
+TaskPool::~TaskPool()
+{
+    Q_FOREACH(const Priv::Installation & installation, d->installations) {
+        d->uninstall(installation);
+    }
+    gst_object_unref(d->pool);
+    delete d;
+}
+
+//static
+QThreadPool *TaskPool::sharedThreadPool()
+{
+    return s_sharedThreadPool();
+}
+
+QThreadPool *TaskPool::threadPool() const
+{
+    return d->pool->config->threadPool;
+}
+
+QList<int> TaskPool::cpuAffinity() const
+{
+    QMutexLocker locker(&d->pool->config->mutex);
+    return d->pool->config->cpus;
+}
+
+void TaskPool::setCpuAffinity(const QList<int> & cpus)
+{
+    QMutexLocker locker(&d->pool->config->mutex);
+    d->pool->config->cpus = cpus;
+}
+
+int TaskPool::realtimePriority() const
+{
+    QMutexLocker locker(&d->pool->config->mutex);
+    return d->pool->config->priority;
+}
+
+void TaskPool::setRealtimePriority(int priority)
+{
+    QMutexLocker locker(&d->pool->config->mutex);
+    d->pool->config->priority = qMax(0, priority);
+}
+
+void TaskPool::install(const PipelinePtr & pipeline)
+{
+    if (!pipeline) {
+        return;
+    }
+
+    Priv::Installation installation;
+    installation.pipeline = GST_ELEMENT(static_cast<GstPipeline*>(pipeline));
+    Q_FOREACH(const Priv::Installation & existing, d->installations) {
+        if (existing.pipeline == installation.pipeline) {
+            return;
+        }
+    }
+
+    installation.bus = gst_element_get_bus(installation.pipeline);
+    gst_bus_enable_sync_message_emission(installation.bus);
+    installation.handlerId = g_signal_connect_data(installation.bus, "sync-message::stream-status",
+            G_CALLBACK(streamStatusHandler), gst_object_ref(d->pool),
+            reinterpret_cast<GClosureNotify>(gst_object_unref), GConnectFlags(0));
+    d->installations.append(installation);
+}
+
+void TaskPool::uninstall(const PipelinePtr & pipeline)
+{
+    GstElement *element = pipeline ? GST_ELEMENT(static_cast<GstPipeline*>(pipeline)) : NULL;
+    for (int i = 0; i < d->installations.size(); ++i) {
+        if (d->installations.at(i).pipeline == element) {
+            d->uninstall(d->installations.takeAt(i));
+            return;
+        }
+    }
+}
+
+bool TaskPool::handleStreamStatus(const StreamStatusMessagePtr & message)
+{
+    return message && setPoolOnTask(message, GST_TASK_POOL(d->pool));
+}
+
+int TaskPool::activeTaskCount() const
+{
+#if QT_VERSION >= 0x050000
+    return d->pool->config->active.loadAcquire();
+#else
+    return d->pool->config->active.fetchAndAddAcquire(0);
+#endif
+}
+
+quint64 TaskPool::startedTaskCount() const
+{
+#if QT_VERSION >= 0x050000
+    return quint32(d->pool->config->started.loadAcquire());
+#else
+    return quint32(d->pool->config->started.fetchAndAddAcquire(0));
+#endif
+}
+
+GstTaskPool *TaskPool::gstTaskPool() const
+{
+    return GST_TASK_POOL(d->pool);
+}
+
+} //namespace Utils
+} //namespace QGst
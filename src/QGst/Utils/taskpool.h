@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_UTILS_TASKPOOL_H
+#define QGST_UTILS_TASKPOOL_H
+
+#include "global.h"
+#include "../pipeline.h"
+#include "../message.h"
+#include <QtCore/QList>
+
+class QThreadPool;
+typedef struct _GstTaskPool GstTaskPool;
+
+namespace QGst {
+namespace Utils {
+
+/*! \headerfile taskpool.h <QGst/Utils/TaskPool>
+ * \brief A GstTaskPool that runs streaming threads on a QThreadPool
+ *
+ * By default, every GstTask (the streaming thread of a source, a queue or a
+ * demuxer) takes a thread from GStreamer's own, unbounded, thread pool. TaskPool
+ * replaces that pool with a QThreadPool, which is shared by default between
+ * all the TaskPool instances of the process. This bounds the number of streaming
+ * threads, lets them be reused across pipelines and lets each TaskPool run its
+ * tasks with a CPU affinity and a realtime priority of its own.
+ *
+ * \code
+ * QGst::Utils::TaskPool *pool = new QGst::Utils::TaskPool;
+ * pool->setCpuAffinity(QList<int>() << 2 << 3);
+ * pool->install(pipeline);
+ * \endcode
+ *
+ * install() watches the stream-status messages of the pipeline through a sync
+ * message handler on its bus, and sets the pool on every task when it is created.
+ * Applications that already handle stream-status messages synchronously can
+ * call handleStreamStatus() instead.
+ *
+ * \note A GstTask occupies its thread for as long as it is started, not only while
+ * it processes a buffer. When every thread of the QThreadPool is busy, a task cannot
+ * be started and the element that starts it fails its state change, instead of
+ * stalling until another task stops. The maximum thread count of the QThreadPool
+ * must therefore be at least the number of streaming tasks that run at the same time.
+ * \note CPU affinity is only supported on Linux and realtime priority only on
+ * platforms with POSIX threads. Realtime priority requires the appropriate
+ * privileges; if it cannot be set, a warning is printed once and the tasks run
+ * with normal priority. The worker threads get their original settings back when
+ * a task finishes, since they are shared with other pools.
+ */
+class QTGSTREAMERUTILS_EXPORT TaskPool
+{
+public:
+    /*! Creates a pool that runs its tasks on \a threadPool, which must outlive it.
+     * If \a threadPool is NULL, sharedThreadPool() is used. */
+    explicit TaskPool(QThreadPool *threadPool = 0);
+    virtual ~TaskPool();
+
+    /*! \returns the QThreadPool that is shared by default between all the TaskPools.
+     * It allows up to QThread::idealThreadCount() * 8 threads. */
+    static QThreadPool *sharedThreadPool();
+
+    QThreadPool *threadPool() const;
+
+    /*! \returns the CPUs that the tasks of this pool are allowed to run on */
+    QList<int> cpuAffinity() const;
+    /*! Restricts the tasks of this pool to the given \a cpus. An empty list
+     * (the default) lets them run on any CPU. Takes effect for tasks started
+     * after the call. */
+    void setCpuAffinity(const QList<int> & cpus);
+
+    /*! \returns the SCHED_FIFO priority of the tasks, or 0 if they use the normal policy */
+    int realtimePriority() const;
+    /*! Runs the tasks of this pool with the SCHED_FIFO policy and the given
+     * \a priority, or with the normal policy if \a priority is 0 (the default).
+     * Takes effect for tasks started after the call. */
+    void setRealtimePriority(int priority);
+
+    /*! Makes every task created by the elements of \a pipeline from now on use
+     * this pool. Tasks that exist already keep their pool. */
+    void install(const PipelinePtr & pipeline);
+    void uninstall(const PipelinePtr & pipeline);
+
+    /*! Sets this pool on the task carried by \a message, if it is a stream-status
+     * message of type StreamStatusTypeCreate. This must be called synchronously,
+     * from a bus sync handler.
+     * \returns true if a pool was set */
+    bool handleStreamStatus(const StreamStatusMessagePtr & message);
+
+    /*! \returns the number of tasks that are currently running in this pool */
+    int activeTaskCount() const;
+    /*! \returns the number of tasks that were started by this pool */
+    quint64 startedTaskCount() const;
+
+    /*! \returns the underlying GstTaskPool, which can be set on tasks directly */
+    GstTaskPool *gstTaskPool() const;
+
+private:
+    struct Priv;
+    Priv *const d;
+    Q_DISABLE_COPY(TaskPool)
+};
+
+} //namespace Utils
+} //namespace QGst
+
+#endif // QGST_UTILS_TASKPOOL_H
@@ -107,4 +107,41 @@ void Buffer::unmap(MapInfo &info)
     gst_buffer_unmap(object<GstBuffer>(), static_cast<GstMapInfo *>(info.m_object));
 }
 
+Meta Buffer::addMeta(const GstMetaInfo *info, void *params)
+{
+    return Meta(gst_buffer_add_meta(object<GstBuffer>(), info, params));
+}
+
+Meta Buffer::getMeta(QGlib::Type api) const
+{
+    return Meta(gst_buffer_get_meta(object<GstBuffer>(), api));
+}
+
+QList<Meta> Buffer::iterateMeta() const
+{
+    QList<Meta> result;
+    gpointer state = NULL;
+    while (GstMeta *meta = gst_buffer_iterate_meta(object<GstBuffer>(), &state)) {
+        result.append(Meta(meta));
+    }
+    return result;
+}
+
+QList<Meta> Buffer::iterateMeta(QGlib::Type api) const
+{
+    QList<Meta> result;
+    gpointer state = NULL;
+    while (GstMeta *meta = gst_buffer_iterate_meta(object<GstBuffer>(), &state)) {
+        if (meta->info->api == static_cast<GType>(api)) {
+            result.append(Meta(meta));
+        }
+    }
+    return result;
+}
+
+bool Buffer::removeMeta(const Meta & meta)
+{
+    return gst_buffer_remove_meta(object<GstBuffer>(), meta);
+}
+
 } //namespace QGst
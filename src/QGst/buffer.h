@@ -21,6 +21,8 @@
 #include "miniobject.h"
 #include "clocktime.h"
 #include "memory.h"
+#include "meta.h"
+#include <QtCore/QList>
 
 namespace QGst {
 
@@ -32,6 +34,11 @@ namespace QGst {
      * and the length is obtained from size(). Buffers also contain a CapsPtr in 
      * caps() that indicates the format of the buffer data.
      *
+     * Additional data can be attached to a buffer in the form of metas. Metas
+     * defined by GStreamer plugins are accessed with the Meta-based functions, while
+     * application data can be carried by registering a C++ type with CustomMeta and
+     * using the template versions of addMeta(), getMeta() and removeMeta().
+     * Adding or removing metas requires the buffer to be writable.
      */
 class QTGSTREAMER_EXPORT Buffer : public MiniObject
 {
@@ -63,8 +70,44 @@ public:
 
     bool map(MapInfo &info, MapFlags flags);
     void unmap(MapInfo &info);
+
+    /*! Adds a meta described by \a info to this buffer, passing \a params
+     * to its init function. Returns an invalid Meta if the init function fails. */
+    Meta addMeta(const GstMetaInfo *info, void *params = NULL);
+    /*! Returns the first meta of the given \a api type, or an invalid Meta. */
+    Meta getMeta(QGlib::Type api) const;
+    /*! Returns all the metas attached to this buffer. */
+    QList<Meta> iterateMeta() const;
+    /*! Returns the metas of the given \a api type attached to this buffer. */
+    QList<Meta> iterateMeta(QGlib::Type api) const;
+    bool removeMeta(const Meta & meta);
+
+    /*! Adds a default-constructed \a T to this buffer and returns a pointer to it.
+     * \a T must have been registered with CustomMeta::registerMeta(). */
+    template <typename T> inline T *addMeta();
+    /*! Returns the first \a T attached to this buffer, or NULL. */
+    template <typename T> inline T *getMeta() const;
+    template <typename T> inline bool removeMeta();
 };
 
+template <typename T>
+T *Buffer::addMeta()
+{
+    return static_cast<T*>(Private::addCustomMeta(object<GstBuffer>(), CustomMeta<T>::info()));
+}
+
+template <typename T>
+T *Buffer::getMeta() const
+{
+    return static_cast<T*>(Private::getCustomMeta(object<GstBuffer>(), CustomMeta<T>::info()));
+}
+
+template <typename T>
+bool Buffer::removeMeta()
+{
+    return Private::removeCustomMeta(object<GstBuffer>(), CustomMeta<T>::info());
+}
+
 BufferPtr Buffer::makeWritable() const
 {
     return MiniObject::makeWritable().staticCast<Buffer>();
@@ -106,6 +106,28 @@ private:
 
 Q_GLOBAL_STATIC(Private::BusWatchManager, s_watchManager)
 
+struct SyncHandlerData
+{
+    BusSyncReply (*func)(MessageType, GstMessage *, void *);
+    void *userData;
+    void (*destroy)(void *);
+};
+
+static GstBusSyncReply syncHandler(GstBus *bus, GstMessage *message, gpointer userData)
+{
+    Q_UNUSED(bus);
+    SyncHandlerData *data = static_cast<SyncHandlerData*>(userData);
+    MessageType type = static_cast<MessageType>(GST_MESSAGE_TYPE(message));
+    return static_cast<GstBusSyncReply>(data->func(type, message, data->userData));
+}
+
+static void destroySyncHandlerData(gpointer userData)
+{
+    SyncHandlerData *data = static_cast<SyncHandlerData*>(userData);
+    data->destroy(data->userData);
+    delete data;
+}
+
 } //namespace Private
 
 
@@ -170,4 +192,22 @@ void Bus::disableSyncMessageEmission()
     gst_bus_disable_sync_message_emission(object<GstBus>());
 }
 
+void Bus::setSyncHandlerImpl(SyncHandlerFunction func, void *userData, DestroyFunction destroy)
+{
+    Private::SyncHandlerData *data = new Private::SyncHandlerData;
+    data->func = func;
+    data->userData = userData;
+    data->destroy = destroy;
+
+    //gst_bus_set_sync_handler() refuses to replace a handler, so remove the old one first
+    gst_bus_set_sync_handler(object<GstBus>(), NULL, NULL, NULL);
+    gst_bus_set_sync_handler(object<GstBus>(), &Private::syncHandler, data,
+                             &Private::destroySyncHandlerData);
+}
+
+void Bus::unsetSyncHandler()
+{
+    gst_bus_set_sync_handler(object<GstBus>(), NULL, NULL, NULL);
+}
+
 } //namespace QGst
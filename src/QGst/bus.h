@@ -33,11 +33,14 @@ namespace QGst {
  * This is important since the actual streaming of media is done in another thread
  * than the application.
  *
- * There are three ways to get messages from a Bus:
+ * There are four ways to get messages from a Bus:
  * \li Poll manually with the peek() and pop() methods.
  * \li Enable the emission of the "sync-message" signal using enableSyncMessageEmission()
  * and connect to this signal. The slot connected to this signal will be called
  * synchronously from the thread that posts the message.
+ * \li Install a synchronous handler with setSyncHandler(). This is also called from the
+ * thread that posts the message, but it is a plain C++ callable and it decides whether the
+ * message is dropped or continues to the bus' queue.
  * \li Add a signal "watch" to the bus. This is an object that will poll the bus from the
  * main event loop and will emit the "message" signal on the main thread whenever a new
  * message is available. Note that the watch will pop messages from the bus, so they
@@ -130,8 +133,85 @@ public:
      * times as enableSyncMessageEmission() has been called.
      */
     void disableSyncMessageEmission();
+
+
+    /*! Installs \a handler as the synchronous handler of the bus, replacing any handler
+     * that was installed before. The handler is called from inside post(), on the thread
+     * that posts the message, as
+     * \code
+     * QGst::BusSyncReply handler(QGst::MessageType type, GstMessage *message);
+     * \endcode
+     * and its return value decides what happens to the message:
+     * \li BusDrop discards the message; it never reaches the queue, the watch or pop().
+     * \li BusPass queues the message as usual.
+     * \li BusAsync queues the message and blocks post() until the message has been
+     * handled by the main loop.
+     *
+     * Unlike the "sync-message" signal, the handler is not dispatched through the GObject
+     * signal system and the message is not wrapped in a MessagePtr. The type is passed
+     * first so that the handler can filter on it without touching the message; use
+     * MessagePtr::wrap() on \a message if you need the wrapper. This makes it the place
+     * for cheap filtering of high rate messages and for messages that need an answer with
+     * the least latency, such as the "prepare-window-handle" message of video sinks.
+     *
+     * \a handler may be a function pointer or a function object; it is copied and the
+     * copy is destroyed when it is replaced, when unsetSyncHandler() is called or when
+     * the bus is destroyed. It must be thread-safe and it must not block.
+     *
+     * \code
+     * bus->setSyncHandler(&syncHandler);
+     * ...
+     * static QGst::BusSyncReply syncHandler(QGst::MessageType type, GstMessage *message)
+     * {
+     *     if (type == QGst::MessageElement
+     *             && gst_is_video_overlay_prepare_window_handle_message(message)) {
+     *         gst_video_overlay_set_window_handle(GST_VIDEO_OVERLAY(GST_MESSAGE_SRC(message)),
+     *                                             s_windowId);
+     *         return QGst::BusDrop;
+     *     }
+     *     return type == QGst::MessageQos ? QGst::BusDrop : QGst::BusPass;
+     * }
+     * \endcode
+     */
+    template <typename F>
+    inline void setSyncHandler(F handler);
+
+    /*! Removes the handler that was installed with setSyncHandler(). */
+    void unsetSyncHandler();
+
+private:
+    typedef BusSyncReply (*SyncHandlerFunction)(MessageType, GstMessage *, void *);
+    typedef void (*DestroyFunction)(void *);
+
+    template <typename F>
+    static BusSyncReply syncHandlerTrampoline(MessageType type, GstMessage *message,
+                                              void *handler);
+    template <typename F>
+    static void syncHandlerDestroy(void *handler);
+    void setSyncHandlerImpl(SyncHandlerFunction func, void *userData, DestroyFunction destroy);
 };
 
+template <typename F>
+inline void Bus::setSyncHandler(F handler)
+{
+    setSyncHandlerImpl(&Bus::syncHandlerTrampoline<F>, new F(handler),
+                       &Bus::syncHandlerDestroy<F>);
+}
+
+//static
+template <typename F>
+BusSyncReply Bus::syncHandlerTrampoline(MessageType type, GstMessage *message, void *handler)
+{
+    return (*static_cast<F*>(handler))(type, message);
+}
+
+//static
+template <typename F>
+void Bus::syncHandlerDestroy(void *handler)
+{
+    delete static_cast<F*>(handler);
+}
+
 } //namespace QGst
 
 QGST_REGISTER_TYPE(QGst::Bus)
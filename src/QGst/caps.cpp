@@ -20,9 +20,78 @@
 #include "objectstore_p.h"
 #include <QtCore/QDebug>
 #include <gst/gst.h>
+#include <gst/audio/audio.h>
+#include <gst/video/video.h>
 
 namespace QGst {
 
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+/* Interned once, so that building raw media caps never hashes a string */
+struct MediaQuarks
+{
+    MediaQuarks()
+        : videoRaw(QGlib::Quark::fromStaticString("video/x-raw")),
+          audioRaw(QGlib::Quark::fromStaticString("audio/x-raw")),
+          format(QGlib::Quark::fromStaticString("format")),
+          width(QGlib::Quark::fromStaticString("width")),
+          height(QGlib::Quark::fromStaticString("height")),
+          framerate(QGlib::Quark::fromStaticString("framerate")),
+          pixelAspectRatio(QGlib::Quark::fromStaticString("pixel-aspect-ratio")),
+          rate(QGlib::Quark::fromStaticString("rate")),
+          channels(QGlib::Quark::fromStaticString("channels")),
+          layout(QGlib::Quark::fromStaticString("layout"))
+    {}
+
+    QGlib::Quark videoRaw;
+    QGlib::Quark audioRaw;
+    QGlib::Quark format;
+    QGlib::Quark width;
+    QGlib::Quark height;
+    QGlib::Quark framerate;
+    QGlib::Quark pixelAspectRatio;
+    QGlib::Quark rate;
+    QGlib::Quark channels;
+    QGlib::Quark layout;
+};
+
+} //anonymous namespace
+
+Q_GLOBAL_STATIC(MediaQuarks, mediaQuarks)
+
+#endif //DOXYGEN_RUN
+
+//static
+CapsPtr Caps::rawVideo(VideoFormat format, int width, int height,
+                       const Fraction & framerate, const Fraction & pixelAspectRatio)
+{
+    const MediaQuarks *q = mediaQuarks();
+    GstStructure *s = gst_structure_new_id(q->videoRaw,
+        q->format, G_TYPE_STRING, gst_video_format_to_string(static_cast<GstVideoFormat>(format)),
+        q->width, G_TYPE_INT, width,
+        q->height, G_TYPE_INT, height,
+        q->framerate, GST_TYPE_FRACTION, framerate.numerator, framerate.denominator,
+        q->pixelAspectRatio, GST_TYPE_FRACTION,
+                pixelAspectRatio.numerator, pixelAspectRatio.denominator,
+        NULL);
+    return CapsPtr::wrap(gst_caps_new_full(s, NULL), false);
+}
+
+//static
+CapsPtr Caps::rawAudio(AudioFormat format, int rate, int channels, bool interleaved)
+{
+    const MediaQuarks *q = mediaQuarks();
+    GstStructure *s = gst_structure_new_id(q->audioRaw,
+        q->format, G_TYPE_STRING, gst_audio_format_to_string(static_cast<GstAudioFormat>(format)),
+        q->rate, G_TYPE_INT, rate,
+        q->channels, G_TYPE_INT, channels,
+        q->layout, G_TYPE_STRING, interleaved ? "interleaved" : "non-interleaved",
+        NULL);
+    return CapsPtr::wrap(gst_caps_new_full(s, NULL), false);
+}
+
 //static
 CapsPtr Caps::createSimple(const char *mediaType)
 {
@@ -83,6 +152,11 @@ StructurePtr Caps::internalStructure(uint index)
     return SharedStructure::fromCaps(structure, CapsPtr(this));
 }
 
+StructureView Caps::structureView(uint index) const
+{
+    return gst_caps_get_structure(object<GstCaps>(), index);
+}
+
 void Caps::appendStructure(const Structure & structure)
 {
     gst_caps_append_structure(object<GstCaps>(), gst_structure_copy(structure));
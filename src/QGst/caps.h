@@ -18,7 +18,9 @@
 #define QGST_CAPS_H
 
 #include "global.h"
+#include "enums.h"
 #include "miniobject.h"
+#include "structs.h"
 #include "../QGlib/value.h"
 #include "../QGlib/refpointer.h"
 #include "../QGlib/type.h"
@@ -27,6 +29,9 @@ namespace QGst {
 
 /*! \headerfile caps.h <QGst/Caps>
  * \brief Wrapper class for GstCaps
+ *
+ * Caps that are known in advance are cheapest to build with rawVideo(), rawAudio()
+ * or a StructureBuilder, which skip the string parser that fromString() uses.
  */
 class QTGSTREAMER_EXPORT Caps : public QGst::MiniObject
 {
@@ -36,6 +41,15 @@ public:
     static CapsPtr createAny();
     static CapsPtr createEmpty();
 
+    /*! Creates fixed video/x-raw caps without parsing a string. A \a framerate of 0/1
+     * means variable or unknown. */
+    static CapsPtr rawVideo(VideoFormat format, int width, int height,
+                            const Fraction & framerate = Fraction(0, 1),
+                            const Fraction & pixelAspectRatio = Fraction(1, 1));
+    /*! Creates fixed audio/x-raw caps without parsing a string */
+    static CapsPtr rawAudio(AudioFormat format, int rate, int channels,
+                            bool interleaved = true);
+
     static CapsPtr fromString(const char *string);
     static inline CapsPtr fromString(const QString & string);
     QString toString() const;
@@ -49,6 +63,7 @@ public:
     CapsPtr truncate();
 
     StructurePtr internalStructure(uint index);
+    StructureView structureView(uint index) const;
 
     void appendStructure(const Structure & structure);
     CapsPtr mergeStructure(Structure & structure);
@@ -198,6 +198,15 @@ namespace QGst {
 }
 QGST_REGISTER_TYPE(QGst::MessageType)
 
+namespace QGst {
+    enum BusSyncReply {
+        BusDrop = 0,
+        BusPass = 1,
+        BusAsync = 2
+    };
+}
+QGST_REGISTER_TYPE(QGst::BusSyncReply)
+
 
 namespace QGst {
     enum ParseError {
@@ -393,7 +402,10 @@ namespace QGst {
         SeekFlagAccurate = (1 << 1),
         SeekFlagKeyUnit = (1 << 2),
         SeekFlagSegment = (1 << 3),
-        SeekFlagSkip = (1 << 4)
+        SeekFlagSkip = (1 << 4),
+        SeekFlagSnapBefore = (1 << 5),
+        SeekFlagSnapAfter = (1 << 6),
+        SeekFlagSnapNearest = SeekFlagSnapBefore | SeekFlagSnapAfter
     };
     Q_DECLARE_FLAGS(SeekFlags, SeekFlag);
     Q_DECLARE_OPERATORS_FOR_FLAGS(SeekFlags)
@@ -516,4 +528,57 @@ namespace QGst {
 }
 Q_DECLARE_OPERATORS_FOR_FLAGS(QGst::MemoryFlags)
 QGST_REGISTER_TYPE(QGst::MemoryFlags)
+
+namespace QGst {
+    /*! The most common raw video formats, see Caps::rawVideo() */
+    enum VideoFormat {
+        //codegen: VideoFormatRGBx=VIDEO_FORMAT_RGBx, VideoFormatBGRx=VIDEO_FORMAT_BGRx, VideoFormatxRGB=VIDEO_FORMAT_xRGB, VideoFormatxBGR=VIDEO_FORMAT_xBGR
+        VideoFormatUnknown = 0,
+        VideoFormatEncoded = 1,
+        VideoFormatI420 = 2,
+        VideoFormatYV12 = 3,
+        VideoFormatYUY2 = 4,
+        VideoFormatUYVY = 5,
+        VideoFormatAYUV = 6,
+        VideoFormatRGBx = 7,
+        VideoFormatBGRx = 8,
+        VideoFormatxRGB = 9,
+        VideoFormatxBGR = 10,
+        VideoFormatRGBA = 11,
+        VideoFormatBGRA = 12,
+        VideoFormatARGB = 13,
+        VideoFormatABGR = 14,
+        VideoFormatRGB = 15,
+        VideoFormatBGR = 16,
+        VideoFormatY41B = 17,
+        VideoFormatY42B = 18,
+        VideoFormatYVYU = 19,
+        VideoFormatY444 = 20,
+        VideoFormatNV12 = 23,
+        VideoFormatNV21 = 24,
+        VideoFormatGray8 = 25,
+        VideoFormatRGB16 = 29,
+        VideoFormatBGR16 = 30
+    };
+}
+QGST_REGISTER_TYPE(QGst::VideoFormat)
+
+namespace QGst {
+    /*! The most common raw audio formats, see Caps::rawAudio() */
+    enum AudioFormat {
+        AudioFormatUnknown = 0,
+        AudioFormatEncoded = 1,
+        AudioFormatS8 = 2,
+        AudioFormatU8 = 3,
+        AudioFormatS16LE = 4,
+        AudioFormatS16BE = 5,
+        AudioFormatS32LE = 12,
+        AudioFormatS32BE = 13,
+        AudioFormatF32LE = 28,
+        AudioFormatF32BE = 29,
+        AudioFormatF64LE = 30,
+        AudioFormatF64BE = 31
+    };
+}
+QGST_REGISTER_TYPE(QGst::AudioFormat)
 #endif
@@ -46,6 +46,11 @@ StructureConstPtr Event::internalStructure()
     return SharedStructure::fromMiniObject(const_cast<GstStructure *>(structure), MiniObjectPtr(this));
 }
 
+StructureView Event::structureView() const
+{
+    return gst_event_get_structure(object<GstEvent>());
+}
+
 bool Event::hasName(const char *name) const
 {
     return gst_event_has_name(object<GstEvent>(), name);
@@ -61,6 +61,7 @@ public:
     QString typeName() const;
 
     StructureConstPtr internalStructure();
+    StructureView structureView() const;
 
     bool hasName(const char *name) const;
 
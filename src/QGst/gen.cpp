@@ -27,8 +27,10 @@
     }
 
 #include <gst/gst.h>
+#include <gst/audio/audio.h>
 #include <gst/audio/audio-enumtypes.h>
 #include <gst/audio/streamvolume.h>
+#include <gst/video/video.h>
 #include <gst/video/video-enumtypes.h>
 #include <gst/video/videooverlay.h>
 #include <gst/video/colorbalance.h>
@@ -502,6 +504,8 @@ REGISTER_TYPE_IMPLEMENTATION(QGst::Rank,GST_TYPE_RANK)
 
 REGISTER_TYPE_IMPLEMENTATION(QGst::MessageType,GST_TYPE_MESSAGE_TYPE)
 
+REGISTER_TYPE_IMPLEMENTATION(QGst::BusSyncReply,GST_TYPE_BUS_SYNC_REPLY)
+
 REGISTER_TYPE_IMPLEMENTATION(QGst::ParseError,GST_TYPE_PARSE_ERROR)
 
 REGISTER_TYPE_IMPLEMENTATION(QGst::UriType,GST_TYPE_URI_TYPE)
@@ -542,6 +546,10 @@ REGISTER_TYPE_IMPLEMENTATION(QGst::MapFlags,GST_TYPE_MAP_FLAGS)
 
 REGISTER_TYPE_IMPLEMENTATION(QGst::MemoryFlags,GST_TYPE_MEMORY_FLAGS)
 
+REGISTER_TYPE_IMPLEMENTATION(QGst::VideoFormat,GST_TYPE_VIDEO_FORMAT)
+
+REGISTER_TYPE_IMPLEMENTATION(QGst::AudioFormat,GST_TYPE_AUDIO_FORMAT)
+
 namespace QGst {
     BOOST_STATIC_ASSERT(static_cast<int>(MiniObjectFlagLockable) == static_cast<int>(GST_MINI_OBJECT_FLAG_LOCKABLE));
     BOOST_STATIC_ASSERT(static_cast<int>(MiniObjectFlagLockReadonly) == static_cast<int>(GST_MINI_OBJECT_FLAG_LOCK_READONLY));
@@ -666,6 +674,12 @@ namespace QGst {
     BOOST_STATIC_ASSERT(static_cast<int>(MessageAny) == static_cast<int>(GST_MESSAGE_ANY));
 }
 
+namespace QGst {
+    BOOST_STATIC_ASSERT(static_cast<int>(BusDrop) == static_cast<int>(GST_BUS_DROP));
+    BOOST_STATIC_ASSERT(static_cast<int>(BusPass) == static_cast<int>(GST_BUS_PASS));
+    BOOST_STATIC_ASSERT(static_cast<int>(BusAsync) == static_cast<int>(GST_BUS_ASYNC));
+}
+
 namespace QGst {
     BOOST_STATIC_ASSERT(static_cast<int>(ParseErrorSyntax) == static_cast<int>(GST_PARSE_ERROR_SYNTAX));
     BOOST_STATIC_ASSERT(static_cast<int>(ParseErrorNoSuchElement) == static_cast<int>(GST_PARSE_ERROR_NO_SUCH_ELEMENT));
@@ -807,6 +821,9 @@ namespace QGst {
     BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagKeyUnit) == static_cast<int>(GST_SEEK_FLAG_KEY_UNIT));
     BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagSegment) == static_cast<int>(GST_SEEK_FLAG_SEGMENT));
     BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagSkip) == static_cast<int>(GST_SEEK_FLAG_SKIP));
+    BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagSnapBefore) == static_cast<int>(GST_SEEK_FLAG_SNAP_BEFORE));
+    BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagSnapAfter) == static_cast<int>(GST_SEEK_FLAG_SNAP_AFTER));
+    BOOST_STATIC_ASSERT(static_cast<int>(SeekFlagSnapNearest) == static_cast<int>(GST_SEEK_FLAG_SNAP_NEAREST));
 }
 
 namespace QGst {
@@ -878,6 +895,50 @@ namespace QGst {
     BOOST_STATIC_ASSERT(static_cast<int>(MemoryFlagLast) == static_cast<int>(GST_MEMORY_FLAG_LAST));
 }
 
+namespace QGst {
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatUnknown) == static_cast<int>(GST_VIDEO_FORMAT_UNKNOWN));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatEncoded) == static_cast<int>(GST_VIDEO_FORMAT_ENCODED));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatI420) == static_cast<int>(GST_VIDEO_FORMAT_I420));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatYV12) == static_cast<int>(GST_VIDEO_FORMAT_YV12));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatYUY2) == static_cast<int>(GST_VIDEO_FORMAT_YUY2));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatUYVY) == static_cast<int>(GST_VIDEO_FORMAT_UYVY));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatAYUV) == static_cast<int>(GST_VIDEO_FORMAT_AYUV));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatRGBx) == static_cast<int>(GST_VIDEO_FORMAT_RGBx));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatBGRx) == static_cast<int>(GST_VIDEO_FORMAT_BGRx));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatxRGB) == static_cast<int>(GST_VIDEO_FORMAT_xRGB));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatxBGR) == static_cast<int>(GST_VIDEO_FORMAT_xBGR));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatRGBA) == static_cast<int>(GST_VIDEO_FORMAT_RGBA));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatBGRA) == static_cast<int>(GST_VIDEO_FORMAT_BGRA));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatARGB) == static_cast<int>(GST_VIDEO_FORMAT_ARGB));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatABGR) == static_cast<int>(GST_VIDEO_FORMAT_ABGR));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatRGB) == static_cast<int>(GST_VIDEO_FORMAT_RGB));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatBGR) == static_cast<int>(GST_VIDEO_FORMAT_BGR));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatY41B) == static_cast<int>(GST_VIDEO_FORMAT_Y41B));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatY42B) == static_cast<int>(GST_VIDEO_FORMAT_Y42B));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatYVYU) == static_cast<int>(GST_VIDEO_FORMAT_YVYU));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatY444) == static_cast<int>(GST_VIDEO_FORMAT_Y444));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatNV12) == static_cast<int>(GST_VIDEO_FORMAT_NV12));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatNV21) == static_cast<int>(GST_VIDEO_FORMAT_NV21));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatGray8) == static_cast<int>(GST_VIDEO_FORMAT_GRAY8));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatRGB16) == static_cast<int>(GST_VIDEO_FORMAT_RGB16));
+    BOOST_STATIC_ASSERT(static_cast<int>(VideoFormatBGR16) == static_cast<int>(GST_VIDEO_FORMAT_BGR16));
+}
+
+namespace QGst {
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatUnknown) == static_cast<int>(GST_AUDIO_FORMAT_UNKNOWN));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatEncoded) == static_cast<int>(GST_AUDIO_FORMAT_ENCODED));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatS8) == static_cast<int>(GST_AUDIO_FORMAT_S8));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatU8) == static_cast<int>(GST_AUDIO_FORMAT_U8));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatS16LE) == static_cast<int>(GST_AUDIO_FORMAT_S16LE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatS16BE) == static_cast<int>(GST_AUDIO_FORMAT_S16BE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatS32LE) == static_cast<int>(GST_AUDIO_FORMAT_S32LE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatS32BE) == static_cast<int>(GST_AUDIO_FORMAT_S32BE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatF32LE) == static_cast<int>(GST_AUDIO_FORMAT_F32LE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatF32BE) == static_cast<int>(GST_AUDIO_FORMAT_F32BE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatF64LE) == static_cast<int>(GST_AUDIO_FORMAT_F64LE));
+    BOOST_STATIC_ASSERT(static_cast<int>(AudioFormatF64BE) == static_cast<int>(GST_AUDIO_FORMAT_F64BE));
+}
+
 #include "QGst/parse.h"
 
 #include "QGst/colorbalance.h"
@@ -1027,46 +1088,47 @@ namespace QGst {
   }
 } //namespace QGst
 
+#include "QGst/meta.h"
+
 #include "QGst/init.h"
 
 namespace QGst {
 namespace Private {
   void registerWrapperConstructors()
   {
-    QGlib::Quark q = g_quark_from_static_string("QGlib__wrapper_constructor");
-    QGlib::GetType<Message>().setQuarkData(q, reinterpret_cast<void*>(&Message_new));
-    QGlib::GetType<Pad>().setQuarkData(q, reinterpret_cast<void*>(&Pad_new));
-    QGlib::GetType<VideoOrientation>().setQuarkData(q, reinterpret_cast<void*>(&VideoOrientation_new));
-    QGlib::GetType<Clock>().setQuarkData(q, reinterpret_cast<void*>(&Clock_new));
-    QGlib::GetType<ChildProxy>().setQuarkData(q, reinterpret_cast<void*>(&ChildProxy_new));
-    QGlib::GetType<Query>().setQuarkData(q, reinterpret_cast<void*>(&Query_new));
-    QGlib::GetType<Pipeline>().setQuarkData(q, reinterpret_cast<void*>(&Pipeline_new));
-    QGlib::GetType<StreamVolume>().setQuarkData(q, reinterpret_cast<void*>(&StreamVolume_new));
-    QGlib::GetType<Caps>().setQuarkData(q, reinterpret_cast<void*>(&Caps_new));
-    QGlib::GetType<Event>().setQuarkData(q, reinterpret_cast<void*>(&Event_new));
-    QGlib::GetType<Memory>().setQuarkData(q, reinterpret_cast<void*>(&Memory_new));
-    QGlib::GetType<Element>().setQuarkData(q, reinterpret_cast<void*>(&Element_new));
-    QGlib::GetType<Allocator>().setQuarkData(q, reinterpret_cast<void*>(&Allocator_new));
-    QGlib::GetType<PluginFeature>().setQuarkData(q, reinterpret_cast<void*>(&PluginFeature_new));
-    QGlib::GetType<DiscovererStreamInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererStreamInfo_new));
-    QGlib::GetType<DiscovererContainerInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererContainerInfo_new));
-    QGlib::GetType<DiscovererAudioInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererAudioInfo_new));
-    QGlib::GetType<DiscovererVideoInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererVideoInfo_new));
-    QGlib::GetType<DiscovererSubtitleInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererSubtitleInfo_new));
-    QGlib::GetType<DiscovererInfo>().setQuarkData(q, reinterpret_cast<void*>(&DiscovererInfo_new));
-    QGlib::GetType<Discoverer>().setQuarkData(q, reinterpret_cast<void*>(&Discoverer_new));
-    QGlib::GetType<UriHandler>().setQuarkData(q, reinterpret_cast<void*>(&UriHandler_new));
-    QGlib::GetType<ColorBalanceChannel>().setQuarkData(q, reinterpret_cast<void*>(&ColorBalanceChannel_new));
-    QGlib::GetType<ColorBalance>().setQuarkData(q, reinterpret_cast<void*>(&ColorBalance_new));
-    QGlib::GetType<VideoOverlay>().setQuarkData(q, reinterpret_cast<void*>(&VideoOverlay_new));
-    QGlib::GetType<Buffer>().setQuarkData(q, reinterpret_cast<void*>(&Buffer_new));
-    QGlib::GetType<GhostPad>().setQuarkData(q, reinterpret_cast<void*>(&GhostPad_new));
-    QGlib::GetType<ElementFactory>().setQuarkData(q, reinterpret_cast<void*>(&ElementFactory_new));
-    QGlib::GetType<Sample>().setQuarkData(q, reinterpret_cast<void*>(&Sample_new));
-    QGlib::GetType<Bin>().setQuarkData(q, reinterpret_cast<void*>(&Bin_new));
-    QGlib::GetType<BufferList>().setQuarkData(q, reinterpret_cast<void*>(&BufferList_new));
-    QGlib::GetType<Object>().setQuarkData(q, reinterpret_cast<void*>(&Object_new));
-    QGlib::GetType<Bus>().setQuarkData(q, reinterpret_cast<void*>(&Bus_new));
+    QGlib::Private::registerWrapperConstructor("GstMessage", &QGlib::GetType<Message>, &Message_new);
+    QGlib::Private::registerWrapperConstructor("GstPad", &QGlib::GetType<Pad>, &Pad_new);
+    QGlib::Private::registerWrapperConstructor("GstVideoOrientation", &QGlib::GetType<VideoOrientation>, &VideoOrientation_new);
+    QGlib::Private::registerWrapperConstructor("GstClock", &QGlib::GetType<Clock>, &Clock_new);
+    QGlib::Private::registerWrapperConstructor("GstChildProxy", &QGlib::GetType<ChildProxy>, &ChildProxy_new);
+    QGlib::Private::registerWrapperConstructor("GstQuery", &QGlib::GetType<Query>, &Query_new);
+    QGlib::Private::registerWrapperConstructor("GstPipeline", &QGlib::GetType<Pipeline>, &Pipeline_new);
+    QGlib::Private::registerWrapperConstructor("GstStreamVolume", &QGlib::GetType<StreamVolume>, &StreamVolume_new);
+    QGlib::Private::registerWrapperConstructor("GstCaps", &QGlib::GetType<Caps>, &Caps_new);
+    QGlib::Private::registerWrapperConstructor("GstEvent", &QGlib::GetType<Event>, &Event_new);
+    QGlib::Private::registerWrapperConstructor("GstMemory", &QGlib::GetType<Memory>, &Memory_new);
+    QGlib::Private::registerWrapperConstructor("GstElement", &QGlib::GetType<Element>, &Element_new);
+    QGlib::Private::registerWrapperConstructor("GstAllocator", &QGlib::GetType<Allocator>, &Allocator_new);
+    QGlib::Private::registerWrapperConstructor("GstPluginFeature", &QGlib::GetType<PluginFeature>, &PluginFeature_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererStreamInfo", &QGlib::GetType<DiscovererStreamInfo>, &DiscovererStreamInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererContainerInfo", &QGlib::GetType<DiscovererContainerInfo>, &DiscovererContainerInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererAudioInfo", &QGlib::GetType<DiscovererAudioInfo>, &DiscovererAudioInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererVideoInfo", &QGlib::GetType<DiscovererVideoInfo>, &DiscovererVideoInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererSubtitleInfo", &QGlib::GetType<DiscovererSubtitleInfo>, &DiscovererSubtitleInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscovererInfo", &QGlib::GetType<DiscovererInfo>, &DiscovererInfo_new);
+    QGlib::Private::registerWrapperConstructor("GstDiscoverer", &QGlib::GetType<Discoverer>, &Discoverer_new);
+    QGlib::Private::registerWrapperConstructor("GstURIHandler", &QGlib::GetType<UriHandler>, &UriHandler_new);
+    QGlib::Private::registerWrapperConstructor("GstColorBalanceChannel", &QGlib::GetType<ColorBalanceChannel>, &ColorBalanceChannel_new);
+    QGlib::Private::registerWrapperConstructor("GstColorBalance", &QGlib::GetType<ColorBalance>, &ColorBalance_new);
+    QGlib::Private::registerWrapperConstructor("GstVideoOverlay", &QGlib::GetType<VideoOverlay>, &VideoOverlay_new);
+    QGlib::Private::registerWrapperConstructor("GstBuffer", &QGlib::GetType<Buffer>, &Buffer_new);
+    QGlib::Private::registerWrapperConstructor("GstGhostPad", &QGlib::GetType<GhostPad>, &GhostPad_new);
+    QGlib::Private::registerWrapperConstructor("GstElementFactory", &QGlib::GetType<ElementFactory>, &ElementFactory_new);
+    QGlib::Private::registerWrapperConstructor("GstSample", &QGlib::GetType<Sample>, &Sample_new);
+    QGlib::Private::registerWrapperConstructor("GstBin", &QGlib::GetType<Bin>, &Bin_new);
+    QGlib::Private::registerWrapperConstructor("GstBufferList", &QGlib::GetType<BufferList>, &BufferList_new);
+    QGlib::Private::registerWrapperConstructor("GstObject", &QGlib::GetType<Object>, &Object_new);
+    QGlib::Private::registerWrapperConstructor("GstBus", &QGlib::GetType<Bus>, &Bus_new);
   }
 } //namespace Private
 } //namespace QGst
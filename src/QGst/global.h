@@ -143,13 +143,17 @@ QGST_WRAPPER_GSTCLASS_DECLARATION(Structure)
 QGST_WRAPPER_GSTCLASS_DECLARATION(TagList)
 QGST_WRAPPER_GSTCLASS_DECLARATION(Segment)
 QGST_WRAPPER_GSTCLASS_DECLARATION(AllocationParams)
+QGST_WRAPPER_GSTCLASS_DECLARATION(Meta)
+QGST_WRAPPER_GSTCLASS_DECLARATION(MetaInfo)
 namespace QGst {
     class Structure;
     class SharedStructure;
+    class StructureView;
     typedef QSharedPointer<SharedStructure> StructurePtr;
     typedef QSharedPointer<const SharedStructure> StructureConstPtr;
     class AllocationParams;
     class MapInfo;
+    class Meta;
     class Segment;
 }
 QGST_WRAPPER_GSTCLASS_DECLARATION(URIHandler)
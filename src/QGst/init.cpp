@@ -17,6 +17,7 @@
 #include "init.h"
 #include "../QGlib/init.h"
 #include "../QGlib/error.h"
+#include <QtCore/QDebug>
 #include <gst/gst.h>
 
 namespace QGst {
@@ -31,15 +32,54 @@ void init()
     init(NULL, NULL);
 }
 
+namespace {
+
+/* Prints the plugin registry statistics and the time spent in each step of init().
+ * The registry is loaded (and updated, if needed) from within gst_init_check(),
+ * so its cost is part of the gst_init figure. */
+void printInitTrace(gint64 glibInit, gint64 gstInit, gint64 vtables, gint64 wrappers)
+{
+    GstRegistry *registry = gst_registry_get();
+    GList *plugins = gst_registry_get_plugin_list(registry);
+    GList *factories = gst_registry_get_feature_list(registry, GST_TYPE_ELEMENT_FACTORY);
+
+    qDebug() << "QGst::init: QGlib::init" << glibInit << "us";
+    qDebug() << "QGst::init: gst_init" << gstInit << "us, registry has"
+             << g_list_length(plugins) << "plugins and"
+             << g_list_length(factories) << "element factories";
+    qDebug() << "QGst::init: value vtable registration" << vtables << "us";
+    qDebug() << "QGst::init: wrapper registration" << wrappers
+             << "us (constructors are resolved per type on first wrap)";
+
+    gst_plugin_feature_list_free(factories);
+    gst_plugin_list_free(plugins);
+}
+
+} //anonymous namespace
+
 void init(int *argc, char **argv[])
 {
+    const bool trace = !qgetenv("QTGSTREAMER_TRACE_INIT").isEmpty();
+    gint64 t0 = trace ? g_get_monotonic_time() : 0;
+
     QGlib::init();
+    gint64 t1 = trace ? g_get_monotonic_time() : 0;
+
     GError *error;
     if (!gst_init_check(argc, argv, &error)) {
         throw QGlib::Error(error);
     }
+    gint64 t2 = trace ? g_get_monotonic_time() : 0;
+
     Private::registerValueVTables();
+    gint64 t3 = trace ? g_get_monotonic_time() : 0;
+
     Private::registerWrapperConstructors();
+
+    if (trace) {
+        gint64 t4 = g_get_monotonic_time();
+        printInitTrace(t1 - t0, t2 - t1, t3 - t2, t4 - t3);
+    }
 }
 
 void cleanup()
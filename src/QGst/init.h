@@ -31,6 +31,10 @@ namespace QGst {
      * \note
      * \li This function also calls QGlib::init(), so there is no need to call it explicitly.
      * \li You need to include <QGst/Init> to use this function.
+     * \li Wrapper constructors are registered lazily; the GType a constructor refers to
+     * is only resolved when an object of that type or of a subtype is first wrapped.
+     * \li If the QTGSTREAMER_TRACE_INIT environment variable is set, the time spent
+     * in each initialization step is printed with qDebug().
      *
      * \param argc pointer to the application's argc
      * \param argv pointer to the application's argv
@@ -49,6 +49,11 @@ StructureConstPtr Message::internalStructure()
     return SharedStructure::fromMiniObject(const_cast<GstStructure *>(structure), MiniObjectPtr(this));
 }
 
+StructureView Message::structureView() const
+{
+    return gst_message_get_structure(object<GstMessage>());
+}
+
 quint32 Message::sequenceNumber() const
 {
     return gst_message_get_seqnum(object<GstMessage>());
@@ -55,6 +55,7 @@ public:
     MessageType type() const;
 
     StructureConstPtr internalStructure();
+    StructureView structureView() const;
 
     quint32 sequenceNumber() const;
     void setSequenceNumber(quint32 num);
@@ -0,0 +1,237 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "meta.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <gst/gst.h>
+
+namespace QGst {
+
+Meta::Meta()
+    : m_meta(NULL)
+{
+}
+
+Meta::Meta(GstMeta *meta)
+    : m_meta(meta)
+{
+}
+
+bool Meta::isValid() const
+{
+    return m_meta != NULL;
+}
+
+QGlib::Type Meta::api() const
+{
+    if (!m_meta) {
+        return QGlib::Type::Invalid;
+    }
+    return m_meta->info->api;
+}
+
+bool Meta::hasTag(const char *tag) const
+{
+    return m_meta && gst_meta_api_type_has_tag(m_meta->info->api, g_quark_from_string(tag));
+}
+
+const GstMetaInfo *Meta::info() const
+{
+    return m_meta ? m_meta->info : NULL;
+}
+
+Meta::operator GstMeta*() const
+{
+    return m_meta;
+}
+
+#ifndef DOXYGEN_RUN
+
+namespace Private {
+
+struct QTGSTREAMER_NO_EXPORT CustomMetaInfo
+{
+    const GstMetaInfo *info;
+    CustomMetaVTable vtable;
+    Meta::TransformRules rules;
+    size_t dataOffset;
+};
+
+} //namespace Private
+
+namespace {
+
+/* The layout of a custom meta: the GstMeta header, a pointer back to our
+ * registration, and the C++ value at CustomMetaInfo::dataOffset. Keeping the
+ * registration in the meta itself lets the callbacks below work without a lookup. */
+struct CustomMetaStorage
+{
+    GstMeta meta;
+    const Private::CustomMetaInfo *custom;
+};
+
+/* The params passed to gst_buffer_add_meta() for custom metas. */
+struct CustomMetaParams
+{
+    const Private::CustomMetaInfo *custom;
+    const void *copyFrom;
+};
+
+inline void *dataOf(GstMeta *meta, const Private::CustomMetaInfo *custom)
+{
+    return reinterpret_cast<char*>(meta) + custom->dataOffset;
+}
+
+gboolean customMetaInit(GstMeta *meta, gpointer params, GstBuffer *buffer)
+{
+    Q_UNUSED(buffer);
+
+    //custom metas can only be added through Private::addCustomMeta() and the transform
+    if (!params) {
+        return FALSE;
+    }
+
+    CustomMetaParams *p = static_cast<CustomMetaParams*>(params);
+    CustomMetaStorage *storage = reinterpret_cast<CustomMetaStorage*>(meta);
+    storage->custom = p->custom;
+
+    void *data = dataOf(meta, p->custom);
+    if (p->copyFrom) {
+        p->custom->vtable.copyConstruct(data, p->copyFrom);
+    } else {
+        p->custom->vtable.construct(data);
+    }
+    return TRUE;
+}
+
+void customMetaFree(GstMeta *meta, GstBuffer *buffer)
+{
+    Q_UNUSED(buffer);
+    const Private::CustomMetaInfo *custom = reinterpret_cast<CustomMetaStorage*>(meta)->custom;
+    custom->vtable.destruct(dataOf(meta, custom));
+}
+
+gboolean customMetaTransform(GstBuffer *dest, GstMeta *meta, GstBuffer *buffer,
+                             GQuark type, gpointer data)
+{
+    Q_UNUSED(buffer);
+    const Private::CustomMetaInfo *custom = reinterpret_cast<CustomMetaStorage*>(meta)->custom;
+
+    bool copy;
+    if (GST_META_TRANSFORM_IS_COPY(type)) {
+        GstMetaTransformCopy *copyData = static_cast<GstMetaTransformCopy*>(data);
+        copy = copyData->region ? custom->rules.testFlag(Meta::CopyOnRegionCopy)
+                                : custom->rules.testFlag(Meta::CopyOnCopy);
+    } else {
+        copy = custom->rules.testFlag(Meta::CopyOnTransform);
+    }
+
+    if (!copy) {
+        //not copying the meta is not a failure of the transformation
+        return TRUE;
+    }
+
+    CustomMetaParams params = { custom, dataOf(meta, custom) };
+    return gst_buffer_add_meta(dest, meta->info, &params) != NULL;
+}
+
+struct CustomMetaRegistry
+{
+    QMutex mutex;
+    QHash<QByteArray, Private::CustomMetaInfo*> metas;
+};
+
+} //anonymous namespace
+
+Q_GLOBAL_STATIC(CustomMetaRegistry, s_customMetaRegistry)
+
+namespace Private {
+
+const CustomMetaInfo *registerCustomMeta(const char *name, const CustomMetaVTable & vtable,
+                                         Meta::TransformRules rules, const char * const *tags)
+{
+    CustomMetaRegistry *registry = s_customMetaRegistry();
+    QMutexLocker locker(&registry->mutex);
+
+    CustomMetaInfo *custom = registry->metas.value(name);
+    if (custom) {
+        Q_ASSERT_X(custom->vtable.size == vtable.size, "QGst::CustomMeta",
+                   "A meta with this name has already been registered for a different type");
+        return custom;
+    }
+
+    static const gchar *noTags[] = { NULL };
+    QByteArray apiName = QByteArray(name) + "API";
+    GType api = gst_meta_api_type_register(apiName.constData(),
+                    tags ? const_cast<const gchar**>(tags) : noTags);
+
+    const size_t alignment = qMax(vtable.alignment, size_t(1));
+    const size_t offset = (sizeof(CustomMetaStorage) + alignment - 1) / alignment * alignment;
+
+    custom = new CustomMetaInfo;
+    custom->vtable = vtable;
+    custom->rules = rules;
+    custom->dataOffset = offset;
+    custom->info = gst_meta_register(api, name, offset + vtable.size,
+                                     &customMetaInit, &customMetaFree, &customMetaTransform);
+
+    //like the GstMetaInfo, the registration lives until the end of the process
+    registry->metas.insert(name, custom);
+    return custom;
+}
+
+QGlib::Type customMetaApi(const CustomMetaInfo *info)
+{
+    return info->info->api;
+}
+
+void *addCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info)
+{
+    CustomMetaParams params = { info, NULL };
+    GstMeta *meta = gst_buffer_add_meta(buffer, info->info, &params);
+    return meta ? dataOf(meta, info) : NULL;
+}
+
+void *getCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info)
+{
+    //each custom meta has an API of its own, so the first match is ours
+    GstMeta *meta = gst_buffer_get_meta(buffer, info->info->api);
+    return meta ? dataOf(meta, info) : NULL;
+}
+
+bool removeCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info)
+{
+    gpointer state = NULL;
+    while (GstMeta *meta = gst_buffer_iterate_meta(buffer, &state)) {
+        if (meta->info == info->info) {
+            return gst_buffer_remove_meta(buffer, meta);
+        }
+    }
+    return false;
+}
+
+void *customMetaData(GstMeta *meta, const CustomMetaInfo *info)
+{
+    return (meta && meta->info == info->info) ? dataOf(meta, info) : NULL;
+}
+
+} //namespace Private
+
+#endif //DOXYGEN_RUN
+
+} //namespace QGst
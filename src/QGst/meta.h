@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QGST_META_H
+#define QGST_META_H
+
+#include "global.h"
+#include <new>
+#include <boost/type_traits/alignment_of.hpp>
+
+namespace QGst {
+
+/*! \headerfile meta.h <QGst/Meta>
+ * \brief Wrapper for GstMeta
+ *
+ * GstMeta is a structure that carries additional data alongside a buffer,
+ * allocated together with the buffer's meta list. A Meta is a non-owning handle;
+ * it is valid for as long as the buffer it was obtained from is alive and the
+ * meta has not been removed from it.
+ *
+ * \sa Buffer::addMeta(), Buffer::getMeta(), Buffer::iterateMeta(), CustomMeta
+ */
+class QTGSTREAMER_EXPORT Meta
+{
+public:
+    /*! Specifies what happens to a CustomMeta when the buffer
+     * that carries it is copied or transformed. */
+    enum TransformRule {
+        /*! The meta is dropped on every copy and transformation. */
+        DropOnTransform = 0,
+        /*! The meta is copied when the whole buffer is copied, e.g. by Buffer::copy()
+         * or by an element that makes the buffer writable. */
+        CopyOnCopy = 0x1,
+        /*! The meta is copied when only a region of the buffer is copied. */
+        CopyOnRegionCopy = 0x2,
+        /*! The meta is copied by any other transformation, for example scaling. Use
+         * the meta's tags to let elements know what properties the data depends on. */
+        CopyOnTransform = 0x4
+    };
+    Q_DECLARE_FLAGS(TransformRules, TransformRule)
+
+    Meta();
+    explicit Meta(GstMeta *meta);
+
+    bool isValid() const;
+
+    /*! Returns the API type, which identifies the kind of data this meta carries. */
+    QGlib::Type api() const;
+    /*! Returns true if the API of this meta was registered with the given \a tag. */
+    bool hasTag(const char *tag) const;
+
+    const GstMetaInfo *info() const;
+
+    operator GstMeta*() const;
+
+private:
+    GstMeta *m_meta;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Meta::TransformRules)
+
+namespace Private {
+
+struct CustomMetaInfo;
+
+struct CustomMetaVTable
+{
+    void (*construct)(void *data);
+    void (*copyConstruct)(void *data, const void *other);
+    void (*destruct)(void *data);
+    size_t size;
+    size_t alignment;
+};
+
+QTGSTREAMER_EXPORT const CustomMetaInfo *registerCustomMeta(const char *name,
+        const CustomMetaVTable & vtable, Meta::TransformRules rules, const char * const *tags);
+QTGSTREAMER_EXPORT QGlib::Type customMetaApi(const CustomMetaInfo *info);
+QTGSTREAMER_EXPORT void *addCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info);
+QTGSTREAMER_EXPORT void *getCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info);
+QTGSTREAMER_EXPORT bool removeCustomMeta(GstBuffer *buffer, const CustomMetaInfo *info);
+QTGSTREAMER_EXPORT void *customMetaData(GstMeta *meta, const CustomMetaInfo *info);
+
+} //namespace Private
+
+/*! \headerfile meta.h <QGst/Meta>
+ * \brief Registers a C++ type as a GstMeta
+ *
+ * CustomMeta allows any copy-constructible C++ type to be attached to buffers.
+ * The value is constructed inline in the meta allocation, so attaching it costs
+ * no extra allocation, and reading it back takes no lock.
+ *
+ * \code
+ * struct Detections { QList<QRect> faces; quint64 sequence; };
+ *
+ * QGst::CustomMeta<Detections>::registerMeta("AppDetectionsMeta", QGst::Meta::CopyOnCopy);
+ * ...
+ * buffer->addMeta<Detections>()->sequence = n;
+ * ...
+ * if (const Detections *d = buffer->getMeta<Detections>()) { ... }
+ * \endcode
+ *
+ * registerMeta() must be called once before the type is used. Calling it again,
+ * from the same or from another module, returns the registration made first.
+ * The copy constructor of \a T is used when the transform rules cause
+ * the meta to be copied to a new buffer.
+ *
+ * \note Types that need a stricter alignment than a pointer, such as SIMD vectors,
+ * are not supported.
+ */
+template <typename T>
+class CustomMeta
+{
+public:
+    /*! Registers the meta under \a name. The API type is registered as "<name>API"
+     * with the given NULL-terminated list of \a tags, which may be NULL. */
+    static void registerMeta(const char *name, Meta::TransformRules rules = Meta::CopyOnCopy,
+                             const char * const *tags = NULL);
+    static inline bool isRegistered();
+
+    /*! Returns the API type of this meta, which can be passed to Buffer::getMeta(). */
+    static inline QGlib::Type api();
+
+    /*! Returns the value carried by \a meta, or NULL if \a meta is not of this type. */
+    static inline T *fromMeta(const Meta & meta);
+
+    static inline const Private::CustomMetaInfo *info();
+
+private:
+    static void construct(void *data) { new (data) T(); }
+    static void copyConstruct(void *data, const void *other) { new (data) T(*static_cast<const T*>(other)); }
+    static void destruct(void *data) { static_cast<T*>(data)->~T(); }
+
+    static const Private::CustomMetaInfo *s_info;
+};
+
+template <typename T>
+const Private::CustomMetaInfo *CustomMeta<T>::s_info = NULL;
+
+template <typename T>
+void CustomMeta<T>::registerMeta(const char *name, Meta::TransformRules rules,
+                                 const char * const *tags)
+{
+    Private::CustomMetaVTable vtable;
+    vtable.construct = &CustomMeta<T>::construct;
+    vtable.copyConstruct = &CustomMeta<T>::copyConstruct;
+    vtable.destruct = &CustomMeta<T>::destruct;
+    vtable.size = sizeof(T);
+    vtable.alignment = boost::alignment_of<T>::value;
+    s_info = Private::registerCustomMeta(name, vtable, rules, tags);
+}
+
+template <typename T>
+bool CustomMeta<T>::isRegistered()
+{
+    return s_info != NULL;
+}
+
+template <typename T>
+QGlib::Type CustomMeta<T>::api()
+{
+    return Private::customMetaApi(info());
+}
+
+template <typename T>
+T *CustomMeta<T>::fromMeta(const Meta & meta)
+{
+    return static_cast<T*>(Private::customMetaData(meta, info()));
+}
+
+template <typename T>
+const Private::CustomMetaInfo *CustomMeta<T>::info()
+{
+    Q_ASSERT_X(s_info, "QGst::CustomMeta", "registerMeta() has not been called for this type");
+    return s_info;
+}
+
+} //namespace QGst
+
+#endif
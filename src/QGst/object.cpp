@@ -17,6 +17,7 @@
 #include "object.h"
 #include "../QGlib/string_p.h"
 #include <gst/gst.h>
+#include <cstring>
 
 namespace QGst {
 
@@ -25,6 +26,16 @@ QString Object::name() const
     return QGlib::Private::stringFromGCharPtr(gst_object_get_name(object<GstObject>()));
 }
 
+bool Object::hasName(const char *name) const
+{
+    GstObject *obj = object<GstObject>();
+    GST_OBJECT_LOCK(obj);
+    const gchar *objName = GST_OBJECT_NAME(obj);
+    bool result = objName && name ? std::strcmp(objName, name) == 0 : objName == name;
+    GST_OBJECT_UNLOCK(obj);
+    return result;
+}
+
 bool Object::setName(const char *name)
 {
     return gst_object_set_name(object<GstObject>(), name);
@@ -30,6 +30,7 @@ class QTGSTREAMER_EXPORT Object : public QGlib::Object
     QGST_WRAPPER(Object)
 public:
     QString name() const;
+    bool hasName(const char *name) const;
     bool setName(const char *name);
 
     ObjectPtr parent() const;
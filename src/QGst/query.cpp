@@ -41,6 +41,11 @@ StructureConstPtr Query::internalStructure()
     return SharedStructure::fromMiniObject(const_cast<GstStructure *>(structure), MiniObjectPtr(this));
 }
 
+StructureView Query::structureView() const
+{
+    return gst_query_get_structure(object<GstQuery>());
+}
+
 //********************************************************
 
 PositionQueryPtr PositionQuery::create(Format format)
@@ -67,6 +72,14 @@ void PositionQuery::setValues(Format format, qint64 position)
     gst_query_set_position(object<GstQuery>(), static_cast<GstFormat>(format), position);
 }
 
+void PositionQuery::reset()
+{
+    Q_ASSERT(isWritable());
+    GstFormat f;
+    gst_query_parse_position(object<GstQuery>(), &f, NULL);
+    gst_query_set_position(object<GstQuery>(), f, -1);
+}
+
 //********************************************************
 
 DurationQueryPtr DurationQuery::create(Format format)
@@ -93,6 +106,14 @@ void DurationQuery::setValues(Format format, qint64 duration)
     gst_query_set_duration(object<GstQuery>(), static_cast<GstFormat>(format), duration);
 }
 
+void DurationQuery::reset()
+{
+    Q_ASSERT(isWritable());
+    GstFormat f;
+    gst_query_parse_duration(object<GstQuery>(), &f, NULL);
+    gst_query_set_duration(object<GstQuery>(), f, -1);
+}
+
 //********************************************************
 
 LatencyQueryPtr LatencyQuery::create()
@@ -380,6 +401,18 @@ void BufferingQuery::setBufferingRange(Format rangeFormat, qint64 rangeStart,
                                   rangeStart, rangeStop, estimatedTotal);
 }
 
+void BufferingQuery::reset()
+{
+    Q_ASSERT(isWritable());
+    //these are the values that gst_query_new_buffering() initializes the query with
+    gst_query_set_buffering_percent(object<GstQuery>(), FALSE, 100);
+    gst_query_set_buffering_stats(object<GstQuery>(), GST_BUFFERING_STREAM, -1, -1, 0);
+
+    GstFormat f;
+    gst_query_parse_buffering_range(object<GstQuery>(), &f, NULL, NULL, NULL);
+    gst_query_set_buffering_range(object<GstQuery>(), f, -1, -1, -1);
+}
+
 //********************************************************
 
 UriQueryPtr UriQuery::create()
@@ -44,6 +44,11 @@ namespace QGst {
      * the native C API, where there is only one Query class with tens of 'new_foo' and 'parse_foo'
      * methods.
      *
+     * A query that is not shared (see MiniObject::isWritable()) can be issued again after it
+     * has been answered. The position, duration and buffering queries provide a reset() method
+     * that clears the previous answer, so that code that polls the pipeline periodically
+     * can create these queries once and reuse them, instead of allocating new ones every time.
+     *
      * Note that the Query subclasses \em cannot be used with Value::get(), since a GValue
      * will actually contain a GstQuery (the subclasses do not exist in C) and Value::get()
      * is not able to do dynamic casts. As a result of that, Query subclasses also \em cannot be
@@ -58,6 +63,7 @@ public:
     QueryType type() const;
 
     StructureConstPtr internalStructure();
+    StructureView structureView() const;
 };
 
 /*! \headerfile query.h <QGst/Query>
@@ -72,6 +78,10 @@ public:
     Format format() const;
     qint64 position() const;
     void setValues(Format format, qint64 position);
+
+    /*! Clears the answer of a previous query, keeping the format, so that
+     * this query can be issued again. The query must be writable. */
+    void reset();
 };
 
 /*! \headerfile query.h <QGst/Query>
@@ -86,6 +96,10 @@ public:
     Format format() const;
     qint64 duration() const;
     void setValues(Format format, qint64 duration);
+
+    /*! Clears the answer of a previous query, keeping the format, so that
+     * this query can be issued again. The query must be writable. */
+    void reset();
 };
 
 /*! \headerfile query.h <QGst/Query>
@@ -198,6 +212,11 @@ public:
 
     void setBufferingRange(Format rangeFormat, qint64 rangeStart,
                            qint64 rangeStop, qint64 estimatedTotal);
+
+    /*! Resets the percent, stats and range of a previous answer to their initial
+     * values, keeping the range format, so that this query can be issued again.
+     * The query must be writable. */
+    void reset();
 };
 
 /*! \headerfile query.h <QGst/Query>
@@ -23,6 +23,8 @@
 #include "caps.h"
 #include "../QGlib/string_p.h"
 #include <gst/gst.h>
+#include <gst/audio/audio.h>
+#include <gst/video/video.h>
 #include <QtCore/QDebug>
 
 namespace QGst {
@@ -106,6 +108,16 @@ QString Structure::name() const
     }
 }
 
+QGlib::Quark Structure::nameQuark() const
+{
+    return d->structure ? gst_structure_get_name_id(d->structure) : 0;
+}
+
+bool Structure::hasName(const char *name) const
+{
+    return d->structure ? gst_structure_has_name(d->structure, name) : false;
+}
+
 void Structure::setName(const char *name)
 {
     if (!d->structure) {
@@ -125,12 +137,27 @@ QGlib::Value Structure::value(const char *fieldName) const
     }
 }
 
+QGlib::Value Structure::value(QGlib::Quark fieldId) const
+{
+    if (d->structure) {
+        return QGlib::Value(gst_structure_id_get_value(d->structure, fieldId));
+    } else {
+        return QGlib::Value();
+    }
+}
+
 void Structure::setValue(const char *fieldName, const QGlib::Value & value)
 {
     Q_ASSERT(isValid());
     gst_structure_set_value(d->structure, fieldName, value);
 }
 
+void Structure::setValue(QGlib::Quark fieldId, const QGlib::Value & value)
+{
+    Q_ASSERT(isValid());
+    gst_structure_id_set_value(d->structure, fieldId, value);
+}
+
 unsigned int Structure::numberOfFields() const
 {
     return d->structure ? gst_structure_n_fields(d->structure) : 0;
@@ -145,6 +172,16 @@ QString Structure::fieldName(unsigned int fieldNumber) const
     }
 }
 
+QGlib::Quark Structure::fieldNameQuark(unsigned int fieldNumber) const
+{
+    if (fieldNumber < numberOfFields()) {
+        //field names are always stored as quarks, so this lookup never fails
+        return g_quark_try_string(gst_structure_nth_field_name(d->structure, fieldNumber));
+    } else {
+        return 0;
+    }
+}
+
 QGlib::Type Structure::fieldType(const char *fieldName) const
 {
     if (d->structure) {
@@ -154,16 +191,36 @@ QGlib::Type Structure::fieldType(const char *fieldName) const
     }
 }
 
+QGlib::Type Structure::fieldType(QGlib::Quark fieldId) const
+{
+    if (d->structure) {
+        const GValue *value = gst_structure_id_get_value(d->structure, fieldId);
+        return value ? G_VALUE_TYPE(value) : G_TYPE_INVALID;
+    } else {
+        return QGlib::Type::Invalid;
+    }
+}
+
 bool Structure::hasField(const char *fieldName) const
 {
     return d->structure ? gst_structure_has_field(d->structure, fieldName) : false;
 }
 
+bool Structure::hasField(QGlib::Quark fieldId) const
+{
+    return d->structure ? gst_structure_id_has_field(d->structure, fieldId) : false;
+}
+
 bool Structure::hasFieldTyped(const char *fieldName, QGlib::Type type) const
 {
     return d->structure ? gst_structure_has_field_typed(d->structure, fieldName, type) : false;
 }
 
+bool Structure::hasFieldTyped(QGlib::Quark fieldId, QGlib::Type type) const
+{
+    return d->structure ? gst_structure_id_has_field_typed(d->structure, fieldId, type) : false;
+}
+
 void Structure::removeField(const char *fieldName)
 {
     if (d->structure) {
@@ -171,6 +228,13 @@ void Structure::removeField(const char *fieldName)
     }
 }
 
+void Structure::removeField(QGlib::Quark fieldId)
+{
+    if (d->structure) {
+        gst_structure_remove_field(d->structure, g_quark_to_string(fieldId));
+    }
+}
+
 void Structure::removeAllFields()
 {
     if (d->structure) {
@@ -255,6 +319,257 @@ SharedStructure::~SharedStructure()
 
 //END SharedStructure
 
+//BEGIN StructureView
+
+#ifndef DOXYGEN_RUN
+
+namespace {
+
+struct ForEachData
+{
+    bool (*func)(QGlib::Quark, const QGlib::ValueView &, void *);
+    void *userData;
+};
+
+} //anonymous namespace
+
+static gboolean structureViewForEach(GQuark fieldId, const GValue *value, gpointer userData)
+{
+    ForEachData *data = static_cast<ForEachData*>(userData);
+    return data->func(fieldId, QGlib::ValueView(value), data->userData);
+}
+
+#endif //DOXYGEN_RUN
+
+bool StructureView::isValid() const
+{
+    return m_structure != NULL;
+}
+
+const char *StructureView::name() const
+{
+    return m_structure ? gst_structure_get_name(m_structure) : NULL;
+}
+
+QGlib::Quark StructureView::nameQuark() const
+{
+    return m_structure ? gst_structure_get_name_id(m_structure) : 0;
+}
+
+bool StructureView::hasName(const char *name) const
+{
+    return m_structure ? gst_structure_has_name(m_structure, name) : false;
+}
+
+QGlib::ValueView StructureView::value(const char *fieldName) const
+{
+    return m_structure ? gst_structure_get_value(m_structure, fieldName) : NULL;
+}
+
+QGlib::ValueView StructureView::value(QGlib::Quark fieldId) const
+{
+    return m_structure ? gst_structure_id_get_value(m_structure, fieldId) : NULL;
+}
+
+unsigned int StructureView::numberOfFields() const
+{
+    return m_structure ? gst_structure_n_fields(m_structure) : 0;
+}
+
+const char *StructureView::fieldName(unsigned int fieldNumber) const
+{
+    if (fieldNumber < numberOfFields()) {
+        return gst_structure_nth_field_name(m_structure, fieldNumber);
+    } else {
+        return NULL;
+    }
+}
+
+bool StructureView::hasField(const char *fieldName) const
+{
+    return m_structure ? gst_structure_has_field(m_structure, fieldName) : false;
+}
+
+bool StructureView::hasField(QGlib::Quark fieldId) const
+{
+    return m_structure ? gst_structure_id_has_field(m_structure, fieldId) : false;
+}
+
+bool StructureView::hasFieldTyped(const char *fieldName, QGlib::Type type) const
+{
+    return m_structure ? gst_structure_has_field_typed(m_structure, fieldName, type) : false;
+}
+
+bool StructureView::hasFieldTyped(QGlib::Quark fieldId, QGlib::Type type) const
+{
+    return m_structure ? gst_structure_id_has_field_typed(m_structure, fieldId, type) : false;
+}
+
+Structure StructureView::copy() const
+{
+    return m_structure ? Structure(m_structure) : Structure();
+}
+
+QString StructureView::toString() const
+{
+    if (m_structure) {
+        return QGlib::Private::stringFromGCharPtr(gst_structure_to_string(m_structure));
+    } else {
+        return QString();
+    }
+}
+
+bool StructureView::forEachImpl(ForEachFunction func, void *userData) const
+{
+    if (!m_structure) {
+        return true;
+    }
+
+    ForEachData data = { func, userData };
+    return gst_structure_foreach(m_structure, &structureViewForEach, &data);
+}
+
+//END StructureView
+
+StructureBuilder::StructureBuilder(const char *name)
+    : m_structure(gst_structure_new_empty(name))
+{
+}
+
+StructureBuilder::StructureBuilder(QGlib::Quark name)
+    : m_structure(gst_structure_new_id_empty(name))
+{
+}
+
+StructureBuilder::StructureBuilder(const StructureBuilder & other)
+    : m_structure(gst_structure_copy(other.m_structure))
+{
+}
+
+StructureBuilder::~StructureBuilder()
+{
+    gst_structure_free(m_structure);
+}
+
+StructureBuilder & StructureBuilder::operator=(const StructureBuilder & other)
+{
+    if (this != &other) {
+        gst_structure_free(m_structure);
+        m_structure = gst_structure_copy(other.m_structure);
+    }
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, int value)
+{
+    gst_structure_id_set(m_structure, field, G_TYPE_INT, value, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, bool value)
+{
+    gst_structure_id_set(m_structure, field, G_TYPE_BOOLEAN, gboolean(value), NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, double value)
+{
+    gst_structure_id_set(m_structure, field, G_TYPE_DOUBLE, value, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const char *value)
+{
+    gst_structure_id_set(m_structure, field, G_TYPE_STRING, value, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const Fraction & value)
+{
+    gst_structure_id_set(m_structure, field, GST_TYPE_FRACTION,
+                         value.numerator, value.denominator, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const IntRange & value)
+{
+    gst_structure_id_set(m_structure, field, GST_TYPE_INT_RANGE,
+                         value.start, value.end, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const DoubleRange & value)
+{
+    gst_structure_id_set(m_structure, field, GST_TYPE_DOUBLE_RANGE,
+                         value.start, value.end, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const FractionRange & value)
+{
+    gst_structure_id_set(m_structure, field, GST_TYPE_FRACTION_RANGE,
+                         value.start.numerator, value.start.denominator,
+                         value.end.numerator, value.end.denominator, NULL);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, VideoFormat format)
+{
+    //the names are static strings, nothing is allocated here
+    return set(field, gst_video_format_to_string(static_cast<GstVideoFormat>(format)));
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, AudioFormat format)
+{
+    return set(field, gst_audio_format_to_string(static_cast<GstAudioFormat>(format)));
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const QList<int> & values)
+{
+    GValue list = G_VALUE_INIT;
+    g_value_init(&list, GST_TYPE_LIST);
+    Q_FOREACH(int v, values) {
+        GValue item = G_VALUE_INIT;
+        g_value_init(&item, G_TYPE_INT);
+        g_value_set_int(&item, v);
+        gst_value_list_append_value(&list, &item);
+        g_value_unset(&item);
+    }
+    gst_structure_id_take_value(m_structure, field, &list);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const QList<const char*> & values)
+{
+    GValue list = G_VALUE_INIT;
+    g_value_init(&list, GST_TYPE_LIST);
+    Q_FOREACH(const char *v, values) {
+        GValue item = G_VALUE_INIT;
+        g_value_init(&item, G_TYPE_STRING);
+        g_value_set_string(&item, v);
+        gst_value_list_append_value(&list, &item);
+        g_value_unset(&item);
+    }
+    gst_structure_id_take_value(m_structure, field, &list);
+    return *this;
+}
+
+StructureBuilder & StructureBuilder::set(QGlib::Quark field, const QGlib::Value & value)
+{
+    gst_structure_id_set_value(m_structure, field, value);
+    return *this;
+}
+
+Structure StructureBuilder::structure() const
+{
+    return Structure(m_structure);
+}
+
+CapsPtr StructureBuilder::caps() const
+{
+    return CapsPtr::wrap(gst_caps_new_full(gst_structure_copy(m_structure), NULL), false);
+}
+
 QDebug operator<<(QDebug debug, const Structure & structure)
 {
     debug.nospace() << "QGst::Structure";
@@ -22,8 +22,12 @@
 #define QGST_STRUCTURE_H
 
 #include "global.h"
+#include "enums.h"
+#include "structs.h"
 #include "../QGlib/type.h"
 #include "../QGlib/value.h"
+#include "../QGlib/quark.h"
+#include <QtCore/QList>
 #include <QtCore/QString>
 
 namespace QGst {
@@ -43,8 +47,13 @@ namespace QGst {
  * Structure is also serializable. You can use toString() to serialize it into a string
  * and fromString() to deserialize it.
  *
+ * Field and structure names are stored internally as QGlib::Quark. For code that inspects
+ * many structures (for example, in a bus handler), the Quark overloads and the nameQuark(),
+ * hasName() and fieldNameQuark() accessors avoid converting names to QString. Quarks for
+ * names that are known in advance can be created once with QGlib::Quark::fromStaticString().
+ *
  * \note This class is implicitly shared.
- * \sa SharedStructure
+ * \sa SharedStructure, StructureView
  */
 class QTGSTREAMER_EXPORT Structure
 {
@@ -60,20 +69,31 @@ public:
     bool isValid() const;
 
     QString name() const;
+    QGlib::Quark nameQuark() const;
+    bool hasName(const char *name) const;
     void setName(const char *name);
 
     QGlib::Value value(const char *fieldName) const;
+    QGlib::Value value(QGlib::Quark fieldId) const;
     template <typename T>
     inline void setValue(const char *fieldName, const T & value);
     void setValue(const char *fieldName, const QGlib::Value & value);
+    template <typename T>
+    inline void setValue(QGlib::Quark fieldId, const T & value);
+    void setValue(QGlib::Quark fieldId, const QGlib::Value & value);
 
     unsigned int numberOfFields() const;
     QString fieldName(unsigned int fieldNumber) const;
+    QGlib::Quark fieldNameQuark(unsigned int fieldNumber) const;
     QGlib::Type fieldType(const char *fieldName) const;
+    QGlib::Type fieldType(QGlib::Quark fieldId) const;
     bool hasField(const char *fieldName) const;
+    bool hasField(QGlib::Quark fieldId) const;
     bool hasFieldTyped(const char *fieldName, QGlib::Type type) const;
+    bool hasFieldTyped(QGlib::Quark fieldId, QGlib::Type type) const;
 
     void removeField(const char *fieldName);
+    void removeField(QGlib::Quark fieldId);
     void removeAllFields();
 
     QString toString() const;
@@ -100,6 +120,12 @@ inline void Structure::setValue(const char *fieldName, const T & value)
     setValue(fieldName, QGlib::Value::create(value));
 }
 
+template <typename T>
+inline void Structure::setValue(QGlib::Quark fieldId, const T & value)
+{
+    setValue(fieldId, QGlib::Value::create(value));
+}
+
 //static
 inline Structure Structure::fromString(const QString & str)
 {
@@ -153,6 +179,159 @@ private:
     Q_DISABLE_COPY(SharedStructure);
 };
 
+
+/*! \headerfile structure.h <QGst/Structure>
+ * \brief Non-owning, read-only view of a GstStructure
+ *
+ * A StructureView points to a GstStructure that is owned by someone else, usually a
+ * Message, Event, Query or Caps, and never copies it. It is meant for parsing structures
+ * on hot paths (for example, "level" or "spectrum" element messages), where the cost of
+ * copying them into a Structure or wrapping them in a SharedStructure is significant.
+ *
+ * A StructureView does \em not hold a reference to the owner of the structure.
+ * It is only valid for as long as the owner is alive and the structure is not modified,
+ * so it should normally only be kept on the stack:
+ * \code
+ * void MyHandler::onBusMessage(const QGst::MessagePtr & msg)
+ * {
+ *     static const QGlib::Quark rms = QGlib::Quark::fromStaticString("rms");
+ *     QGst::StructureView s = msg->structureView();
+ *     if (s.hasName("level")) {
+ *         QGlib::ValueView v = s.value(rms);
+ *         ...
+ *     }
+ * }
+ * \endcode
+ *
+ * All fields can be visited in order, without copying, with forEach().
+ *
+ * \sa Structure
+ */
+class QTGSTREAMER_EXPORT StructureView
+{
+public:
+    inline StructureView(const GstStructure *structure = NULL) : m_structure(structure) {}
+    inline StructureView(const Structure & structure) : m_structure(structure) {}
+
+    bool isValid() const;
+
+    const char *name() const;
+    QGlib::Quark nameQuark() const;
+    bool hasName(const char *name) const;
+
+    QGlib::ValueView value(const char *fieldName) const;
+    QGlib::ValueView value(QGlib::Quark fieldId) const;
+
+    unsigned int numberOfFields() const;
+    const char *fieldName(unsigned int fieldNumber) const;
+    bool hasField(const char *fieldName) const;
+    bool hasField(QGlib::Quark fieldId) const;
+    bool hasFieldTyped(const char *fieldName, QGlib::Type type) const;
+    bool hasFieldTyped(QGlib::Quark fieldId, QGlib::Type type) const;
+
+    /*! Calls \a func for each field of the structure, in order, as
+     * \code
+     * bool func(QGlib::Quark fieldId, const QGlib::ValueView & value);
+     * \endcode
+     * Iteration stops early if \a func returns false.
+     * \returns false if the iteration was stopped early, true otherwise
+     */
+    template <typename F>
+    inline bool forEach(F func) const;
+
+    /*! \returns a deep copy of the structure */
+    Structure copy() const;
+    QString toString() const;
+
+    inline operator const GstStructure*() const { return m_structure; }
+
+private:
+    typedef bool (*ForEachFunction)(QGlib::Quark, const QGlib::ValueView &, void *);
+
+    template <typename F>
+    static bool forEachTrampoline(QGlib::Quark fieldId, const QGlib::ValueView & value,
+                                  void *func);
+    bool forEachImpl(ForEachFunction func, void *userData) const;
+
+    const GstStructure *m_structure;
+};
+
+template <typename F>
+inline bool StructureView::forEach(F func) const
+{
+    return forEachImpl(&StructureView::forEachTrampoline<F>, &func);
+}
+
+//static
+template <typename F>
+bool StructureView::forEachTrampoline(QGlib::Quark fieldId, const QGlib::ValueView & value,
+                                      void *func)
+{
+    return (*static_cast<F*>(func))(fieldId, value);
+}
+
+
+/*! \headerfile structure.h <QGst/StructureBuilder>
+ * \brief Helper for building a Structure or Caps from typed fields
+ *
+ * StructureBuilder stores each field with gst_structure_id_set(), so building caps does
+ * not go through the caps string parser and no names or values are converted to strings.
+ * Field names are QGlib::Quark; create the quarks of names that are used repeatedly once,
+ * with QGlib::Quark::fromStaticString().
+ *
+ * \code
+ * static const QGlib::Quark rateField = QGlib::Quark::fromStaticString("rate");
+ * static const QGlib::Quark channelsField = QGlib::Quark::fromStaticString("channels");
+ *
+ * QGst::CapsPtr caps = QGst::StructureBuilder("audio/x-raw")
+ *         .set(rateField, 48000)
+ *         .set(channelsField, QGst::IntRange(1, 2))
+ *         .caps();
+ * \endcode
+ *
+ * Caps::rawVideo() and Caps::rawAudio() build the common raw media caps from typed
+ * arguments, which is shorter and lets the compiler check the format.
+ *
+ * \sa Structure, Caps
+ */
+class QTGSTREAMER_EXPORT StructureBuilder
+{
+public:
+    explicit StructureBuilder(const char *name);
+    explicit StructureBuilder(QGlib::Quark name);
+    StructureBuilder(const StructureBuilder & other);
+    ~StructureBuilder();
+
+    StructureBuilder & operator=(const StructureBuilder & other);
+
+    StructureBuilder & set(QGlib::Quark field, int value);
+    StructureBuilder & set(QGlib::Quark field, bool value);
+    StructureBuilder & set(QGlib::Quark field, double value);
+    StructureBuilder & set(QGlib::Quark field, const char *value);
+    StructureBuilder & set(QGlib::Quark field, const Fraction & value);
+    StructureBuilder & set(QGlib::Quark field, const IntRange & value);
+    StructureBuilder & set(QGlib::Quark field, const DoubleRange & value);
+    StructureBuilder & set(QGlib::Quark field, const FractionRange & value);
+    /*! Sets the field to the name of \a format, for example "I420" */
+    StructureBuilder & set(QGlib::Quark field, VideoFormat format);
+    /*! Sets the field to the name of \a format, for example "S16LE" */
+    StructureBuilder & set(QGlib::Quark field, AudioFormat format);
+    /*! Sets the field to a list of alternatives, like { 1, 2 } */
+    StructureBuilder & set(QGlib::Quark field, const QList<int> & values);
+    /*! Sets the field to a list of alternatives, like { I420, YV12 } */
+    StructureBuilder & set(QGlib::Quark field, const QList<const char*> & values);
+    StructureBuilder & set(QGlib::Quark field, const QGlib::Value & value);
+
+    /*! \returns a copy of the structure that has been built so far */
+    Structure structure() const;
+
+    /*! \returns caps that contain a copy of the structure that has been built so far */
+    CapsPtr caps() const;
+
+private:
+    GstStructure *m_structure;
+};
+
 /*! \relates QGst::Structure */
 QTGSTREAMER_EXPORT QDebug operator<<(QDebug debug, const Structure & structure);
 
@@ -161,6 +161,13 @@ int TagList::tagValueCount(const char *tag) const
     return gst_tag_list_get_tag_size(d->taglist, tag);
 }
 
+const char *TagList::peekString(const char *tag, int index) const
+{
+    const gchar *value = NULL;
+    gst_tag_list_peek_string_index(d->taglist, tag, index, &value);
+    return value;
+}
+
 void TagList::clear()
 {
     gst_tag_list_unref(d->taglist);
@@ -88,6 +88,11 @@ public:
                      TagMergeMode mode = TagMergeReplaceAll);
     int tagValueCount(const char *tag) const;
 
+    /*! Returns the string value of \a tag at \a index without copying it, or NULL
+     * if there is no such value. The returned pointer is owned by the TagList and
+     * is only valid for as long as the TagList is not modified or destroyed. */
+    const char *peekString(const char *tag, int index = 0) const;
+
     void clear();
     void removeTag(const char *tag);
 
@@ -28,7 +28,7 @@ namespace QGst {
  */
 class QTGSTREAMER_EXPORT UriHandler : public QGlib::Interface
 {
-    QGST_WRAPPER_DIFFERENT_C_CLASS(UriHandler, URIHandler)
+    QGST_WRAPPER_DIFFERENT_C_CLASS(UriHandler, URIHandler) //codegen: GTypeName=GstURIHandler
 public:
     static bool protocolIsSupported(UriType type, const char *protocol);
     static ElementPtr makeFromUri(UriType type, const QUrl & uri, const char *elementName = NULL);
@@ -0,0 +1,214 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/AsyncStateChange>
+
+namespace {
+
+class RecordingStateChange : public QGst::Utils::AsyncStateChange
+{
+public:
+    RecordingStateChange() : elementFinishedCount(0), finishedCount(0), statusInFinished(-1) {}
+    virtual ~RecordingStateChange() { cancel(); }
+
+    QAtomicInt elementFinishedCount;
+    QAtomicInt finishedCount;
+    QAtomicInt statusInFinished;
+
+protected:
+    virtual void elementFinished(const Report &) { elementFinishedCount.ref(); }
+    virtual void finished()
+    {
+        statusInFinished.fetchAndStoreRelease(status());
+        finishedCount.ref();
+    }
+};
+
+int value(const QAtomicInt & atomic)
+{
+#if QT_VERSION >= 0x050000
+    return atomic.loadAcquire();
+#else
+    return const_cast<QAtomicInt&>(atomic).fetchAndAddAcquire(0);
+#endif
+}
+
+} //anonymous namespace
+
+class AsyncStateChangeTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(const char *description);
+
+private Q_SLOTS:
+    void successTest();
+    void batchTest();
+    void failureTest();
+    void timeoutTest();
+    void cancelTest();
+    void invalidTest();
+    void statusInFinishedTest();
+};
+
+//static
+QGst::PipelinePtr AsyncStateChangeTest::createPipeline(const char *description)
+{
+    return QGst::Parse::launch(description).dynamicCast<QGst::Pipeline>();
+}
+
+void AsyncStateChangeTest::successTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline("fakesrc ! fakesink");
+    RecordingStateChange change;
+
+    QVERIFY(change.start(pipeline, QGst::StatePaused));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QVERIFY(!change.isBusy());
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Succeeded);
+    QCOMPARE(value(change.elementFinishedCount), 1);
+    QCOMPARE(value(change.finishedCount), 1);
+
+    QList<QGst::Utils::AsyncStateChange::Report> reports = change.reports();
+    QCOMPARE(reports.size(), 1);
+    QCOMPARE(static_cast<GstElement*>(reports.at(0).element), static_cast<GstElement*>(pipeline));
+    QCOMPARE(reports.at(0).state, QGst::StatePaused);
+    QVERIFY(reports.at(0).elapsed.isValid());
+
+    QGst::State state;
+    QCOMPARE(pipeline->getState(&state, NULL, 0), QGst::StateChangeSuccess);
+    QCOMPARE(state, QGst::StatePaused);
+
+    //a synchronous state change completes too
+    QVERIFY(change.start(pipeline, QGst::StateNull));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Succeeded);
+    QCOMPARE(value(change.finishedCount), 2);
+}
+
+void AsyncStateChangeTest::batchTest()
+{
+    QList<QGst::ElementPtr> pipelines;
+    for (int i = 0; i < 4; ++i) {
+        pipelines.append(createPipeline("fakesrc ! queue ! fakesink sync=true"));
+    }
+
+    RecordingStateChange change;
+    QVERIFY(change.start(pipelines, QGst::StatePlaying));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Succeeded);
+    QCOMPARE(value(change.elementFinishedCount), 4);
+    QCOMPARE(value(change.finishedCount), 1);
+
+    QList<QGst::Utils::AsyncStateChange::Report> reports = change.reports();
+    QCOMPARE(reports.size(), 4);
+    for (int i = 0; i < reports.size(); ++i) {
+        QCOMPARE(static_cast<GstElement*>(reports.at(i).element),
+                 static_cast<GstElement*>(pipelines.at(i)));
+        QCOMPARE(reports.at(i).status, QGst::Utils::AsyncStateChange::Succeeded);
+    }
+
+    QVERIFY(change.start(pipelines, QGst::StateNull));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Succeeded);
+}
+
+void AsyncStateChangeTest::failureTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "filesrc location=/this/file/does/not/exist ! fakesink");
+    RecordingStateChange change;
+
+    QVERIFY(change.start(pipeline, QGst::StatePaused));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Failed);
+    QCOMPARE(change.reports().at(0).status, QGst::Utils::AsyncStateChange::Failed);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void AsyncStateChangeTest::timeoutTest()
+{
+    //identity holds the first buffer for 2 seconds, so the pipeline cannot preroll in time
+    QGst::PipelinePtr pipeline = createPipeline(
+            "fakesrc ! identity sleep-time=2000000 ! fakesink");
+    RecordingStateChange change;
+    change.setTimeout(QGst::ClockTime::fromMSecs(100));
+    QCOMPARE(change.timeout(), QGst::ClockTime::fromMSecs(100));
+
+    QVERIFY(change.start(pipeline, QGst::StatePaused));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(1)));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::TimedOut);
+    QVERIFY(change.reports().at(0).elapsed >= QGst::ClockTime::fromMSecs(100));
+    QCOMPARE(value(change.finishedCount), 1);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void AsyncStateChangeTest::cancelTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "fakesrc ! identity sleep-time=2000000 ! fakesink");
+    RecordingStateChange change;
+
+    QVERIFY(change.start(pipeline, QGst::StatePaused));
+    QVERIFY(change.isBusy());
+    QVERIFY(!change.start(pipeline, QGst::StatePlaying));
+
+    change.cancel();
+    QVERIFY(change.waitForFinished(0));
+    QCOMPARE(change.status(), QGst::Utils::AsyncStateChange::Cancelled);
+    QCOMPARE(value(change.elementFinishedCount), 1);
+    QCOMPARE(value(change.finishedCount), 1);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void AsyncStateChangeTest::invalidTest()
+{
+    RecordingStateChange change;
+    QVERIFY(!change.start(QGst::ElementPtr(), QGst::StatePlaying));
+    QVERIFY(!change.start(QList<QGst::ElementPtr>(), QGst::StatePlaying));
+    QVERIFY(!change.isBusy());
+    QVERIFY(change.reports().isEmpty());
+}
+
+void AsyncStateChangeTest::statusInFinishedTest()
+{
+    //finished() sees the final result, as in the example of the documentation
+    QGst::PipelinePtr pipeline = createPipeline("fakesrc ! fakesink");
+    RecordingStateChange change;
+    QVERIFY(change.start(pipeline, QGst::StatePaused));
+    QVERIFY(change.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(value(change.statusInFinished), int(QGst::Utils::AsyncStateChange::Succeeded));
+    pipeline->setState(QGst::StateNull);
+
+    QGst::PipelinePtr failing = createPipeline(
+            "filesrc location=/this/file/does/not/exist ! fakesink");
+    RecordingStateChange failed;
+    QVERIFY(failed.start(failing, QGst::StatePaused));
+    QVERIFY(failed.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(value(failed.statusInFinished), int(QGst::Utils::AsyncStateChange::Failed));
+    failing->setState(QGst::StateNull);
+}
+
+QTEST_APPLESS_MAIN(AsyncStateChangeTest)
+
+#include "moc_qgsttest.cpp"
+#include "asyncstatechangetest.moc"
@@ -0,0 +1,274 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bus>
+#include <QGst/Caps>
+#include <QGst/Pipeline>
+#include <QGst/Utils/ApplicationSource>
+#include <QGst/Utils/AudioSink>
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+# define NATIVE_FORMAT(f) f "LE"
+#else
+# define NATIVE_FORMAT(f) f "BE"
+#endif
+
+class TestAudioSink : public QGst::Utils::AudioSink
+{
+public:
+    TestAudioSink() : keepData(true), lastSamples(0), samplesReceived(0), processingTime(0) {}
+
+    bool keepData;
+    QList< QVector<float> > left;
+    QList< QVector<float> > right;
+    QList<QGst::ClockTime> timestamps;
+    int lastSamples;
+    qint64 samplesReceived;
+    qint64 processingTime; //nanoseconds
+
+protected:
+    virtual QGst::FlowReturn newSample()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QGst::FlowReturn ret = QGst::Utils::AudioSink::newSample();
+        processingTime += timer.nsecsElapsed();
+        return ret;
+    }
+
+    virtual QGst::FlowReturn newBlock(const float * const *data, int channels, int samples,
+                                      QGst::ClockTime timestamp)
+    {
+        if (keepData) {
+            QVector<float> l(blockSize()), r(blockSize());
+            qCopy(data[0], data[0] + blockSize(), l.begin());
+            qCopy(data[channels - 1], data[channels - 1] + blockSize(), r.begin());
+            left.append(l);
+            right.append(r);
+            timestamps.append(timestamp);
+        }
+        lastSamples = samples;
+        samplesReceived += samples * channels;
+        return QGst::FlowOk;
+    }
+};
+
+class AudioSinkTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    /* Pushes buffers of the given sizes (in frames) through appsrc ! appsink,
+     * filled with the values that sampleValue() returns, and waits for EOS. */
+    static bool run(TestAudioSink *sink, const char *format, int sampleBytes,
+                    const QList<int> & bufferFrames, bool timestamps = true,
+                    int discontBuffer = -1);
+    static qint32 sampleValue(int frame, int channel);
+
+private Q_SLOTS:
+    void blocksTest();
+    void formatsTest_data();
+    void formatsTest();
+    void discontTest();
+    void untimestampedTest();
+    void conversionBenchmark();
+};
+
+//static
+qint32 AudioSinkTest::sampleValue(int frame, int channel)
+{
+    //a ramp on the left channel and its inverse on the right one
+    qint32 v = (frame % 256) * 64;
+    return channel == 0 ? v : -v;
+}
+
+//static
+bool AudioSinkTest::run(TestAudioSink *sink, const char *format, int sampleBytes,
+                        const QList<int> & bufferFrames, bool timestamps,
+                        int discontBuffer)
+{
+    const int rate = 1000;
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    QGst::Utils::ApplicationSource src;
+    src.setCaps(QGst::Caps::fromString(QString("audio/x-raw, format=%1, layout=interleaved, "
+                                               "channels=2, rate=%2").arg(format).arg(rate)));
+    src.setFormat(QGst::FormatTime);
+    sink->element()->setProperty("sync", false);
+    pipeline->add(src.element(), sink->element());
+    src.element()->link(sink->element());
+    pipeline->setState(QGst::StatePlaying);
+
+    int frame = 0;
+    for (int b = 0; b < bufferFrames.size(); b++) {
+        const int frames = bufferFrames.at(b);
+        GstBuffer *buffer = gst_buffer_new_allocate(NULL, frames * 2 * sampleBytes, NULL);
+        GstMapInfo info;
+        gst_buffer_map(buffer, &info, GST_MAP_WRITE);
+        for (int i = 0; i < frames; i++) {
+            for (int c = 0; c < 2; c++) {
+                qint32 v = sampleValue(frame + i, c);
+                guint8 *dst = info.data + (i * 2 + c) * sampleBytes;
+                if (sampleBytes == 2) {
+                    qint16 s = v;
+                    memcpy(dst, &s, 2);
+                } else if (qstrcmp(format, NATIVE_FORMAT("F32")) == 0) {
+                    float f = v / 32768.0f;
+                    memcpy(dst, &f, 4);
+                } else {
+                    qint32 s = v << 16;
+                    memcpy(dst, &s, 4);
+                }
+            }
+        }
+        gst_buffer_unmap(buffer, &info);
+        if (timestamps) {
+            GST_BUFFER_PTS(buffer) = gst_util_uint64_scale_int(frame, GST_SECOND, rate);
+        }
+        if (b == discontBuffer) {
+            GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+        }
+        frame += frames;
+        src.pushBuffer(QGst::BufferPtr::wrap(buffer, false));
+    }
+    src.endOfStream();
+
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 30 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    pipeline->setState(QGst::StateNull);
+    return ok;
+}
+
+void AudioSinkTest::blocksTest()
+{
+    TestAudioSink sink;
+    sink.setBlockSize(100);
+    QCOMPARE(sink.blockSize(), 100);
+
+    //buffer sizes that do not line up with the block size
+    QList<int> buffers;
+    buffers << 37 << 37 << 250 << 1 << 99 << 606;
+    QVERIFY(run(&sink, NATIVE_FORMAT("S16"), 2, buffers));
+
+    QCOMPARE(sink.channels(), 2);
+    QCOMPARE(sink.rate(), 1000);
+
+    //1030 frames: ten full blocks and a zero-padded one at EOS
+    QCOMPARE(sink.left.size(), 11);
+    QCOMPARE(sink.lastSamples, 30);
+    for (int b = 0; b < sink.left.size(); b++) {
+        QCOMPARE(sink.timestamps[b], QGst::ClockTime::fromMSecs(b * 100));
+        for (int i = 0; i < 100; i++) {
+            const int frame = b * 100 + i;
+            const float expected = frame < 1030 ? sampleValue(frame, 0) / 32768.0f : 0.0f;
+            QCOMPARE(sink.left[b][i], expected);
+            QCOMPARE(sink.right[b][i], -expected);
+        }
+    }
+}
+
+void AudioSinkTest::formatsTest_data()
+{
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<int>("sampleBytes");
+
+    QTest::newRow("S16") << QString(NATIVE_FORMAT("S16")) << 2;
+    QTest::newRow("S32") << QString(NATIVE_FORMAT("S32")) << 4;
+    QTest::newRow("F32") << QString(NATIVE_FORMAT("F32")) << 4;
+}
+
+void AudioSinkTest::formatsTest()
+{
+    QFETCH(QString, format);
+    QFETCH(int, sampleBytes);
+
+    TestAudioSink sink;
+    sink.setBlockSize(64);
+    QList<int> buffers;
+    buffers << 50 << 78;
+    QVERIFY(run(&sink, format.toLatin1().constData(), sampleBytes, buffers));
+
+    QCOMPARE(sink.left.size(), 2);
+    for (int b = 0; b < 2; b++) {
+        for (int i = 0; i < 64; i++) {
+            const float expected = sampleValue(b * 64 + i, 0) / 32768.0f;
+            QCOMPARE(sink.left[b][i], expected);
+            QCOMPARE(sink.right[b][i], -expected);
+        }
+    }
+}
+
+void AudioSinkTest::discontTest()
+{
+    TestAudioSink sink;
+    sink.setBlockSize(100);
+
+    //the discontinuity drops the 50 frames carried over from the first buffer
+    QList<int> buffers;
+    buffers << 150 << 60;
+    QVERIFY(run(&sink, NATIVE_FORMAT("S16"), 2, buffers, true, 1));
+    QCOMPARE(sink.left.size(), 2);
+    QCOMPARE(sink.timestamps[0], QGst::ClockTime::fromMSecs(0));
+    QCOMPARE(sink.timestamps[1], QGst::ClockTime::fromMSecs(150));
+    QCOMPARE(sink.lastSamples, 60);
+    for (int i = 0; i < 100; i++) {
+        const float expected = i < 60 ? sampleValue(150 + i, 0) / 32768.0f : 0.0f;
+        QCOMPARE(sink.left[1][i], expected);
+    }
+}
+
+void AudioSinkTest::untimestampedTest()
+{
+    TestAudioSink sink;
+    sink.setBlockSize(100);
+
+    //buffers without timestamps produce blocks without timestamps
+    QList<int> buffers;
+    buffers << 150 << 50;
+    QVERIFY(run(&sink, NATIVE_FORMAT("S16"), 2, buffers, false));
+    QCOMPARE(sink.left.size(), 2);
+    QVERIFY(!sink.timestamps[0].isValid());
+    QVERIFY(!sink.timestamps[1].isValid());
+}
+
+void AudioSinkTest::conversionBenchmark()
+{
+    TestAudioSink sink;
+    sink.keepData = false;
+
+    //200 buffers of 48000 stereo frames
+    QList<int> buffers;
+    for (int i = 0; i < 200; i++) {
+        buffers << 48000;
+    }
+    QVERIFY(run(&sink, NATIVE_FORMAT("S16"), 2, buffers));
+    QCOMPARE(sink.samplesReceived, qint64(200 * 48000 * 2));
+
+    //only the time spent in the sink counts, not the time to generate the data
+    qint64 msecs = qMax<qint64>(sink.processingTime / 1000000, 1);
+    qDebug() << "Converted" << sink.samplesReceived << "samples in" << msecs << "ms,"
+             << sink.samplesReceived * 1000 / msecs << "samples/s";
+}
+
+QTEST_APPLESS_MAIN(AudioSinkTest)
+
+#include "moc_qgsttest.cpp"
+#include "audiosinktest.moc"
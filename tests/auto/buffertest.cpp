@@ -19,6 +19,31 @@
 #include <QGst/Buffer>
 #include <QGst/Memory>
 #include <QGst/Caps>
+#include <QGst/Meta>
+
+namespace {
+
+struct FrameInfo
+{
+    FrameInfo() : sequence(0) { ++instances; }
+    FrameInfo(const FrameInfo & other)
+        : sequence(other.sequence), labels(other.labels) { ++instances; }
+    ~FrameInfo() { --instances; }
+
+    quint64 sequence;
+    QList<QByteArray> labels;
+
+    static int instances;
+};
+
+int FrameInfo::instances = 0;
+
+struct TransientInfo
+{
+    int value;
+};
+
+} //anonymous namespace
 
 class BufferTest : public QGstTest
 {
@@ -28,6 +53,9 @@ private Q_SLOTS:
     void flagsTest();
     void copyTest();
     void memoryPeekTest();
+    void customMetaTest();
+    void metaIterateTest();
+    void metaTransformTest();
 };
 
 void BufferTest::simpleTest()
@@ -88,6 +116,99 @@ void BufferTest::memoryPeekTest()
     QVERIFY(m->isWritable());
 
 }
+
+void BufferTest::customMetaTest()
+{
+    QGst::CustomMeta<FrameInfo>::registerMeta("QGstTestFrameInfoMeta");
+    QVERIFY(QGst::CustomMeta<FrameInfo>::isRegistered());
+    QVERIFY(QGst::CustomMeta<FrameInfo>::api().isValid());
+
+    {
+        QGst::BufferPtr buffer = QGst::Buffer::create(10);
+        QVERIFY(!buffer->getMeta<FrameInfo>());
+
+        FrameInfo *info = buffer->addMeta<FrameInfo>();
+        QVERIFY(info);
+        QCOMPARE(FrameInfo::instances, 1);
+        QCOMPARE(info->sequence, Q_UINT64_C(0));
+        info->sequence = 42;
+        info->labels.append("face");
+
+        FrameInfo *info2 = buffer->getMeta<FrameInfo>();
+        QCOMPARE(info2, info);
+        QCOMPARE(info2->sequence, Q_UINT64_C(42));
+        QCOMPARE(info2->labels.size(), 1);
+
+        QVERIFY(buffer->removeMeta<FrameInfo>());
+        QVERIFY(!buffer->getMeta<FrameInfo>());
+        QCOMPARE(FrameInfo::instances, 0);
+
+        buffer->addMeta<FrameInfo>();
+        QCOMPARE(FrameInfo::instances, 1);
+    }
+
+    //destroying the buffer destroys the meta
+    QCOMPARE(FrameInfo::instances, 0);
+}
+
+void BufferTest::metaIterateTest()
+{
+    QGst::CustomMeta<FrameInfo>::registerMeta("QGstTestFrameInfoMeta");
+    QGst::CustomMeta<TransientInfo>::registerMeta("QGstTestTransientInfoMeta",
+                                                  QGst::Meta::DropOnTransform);
+
+    QGst::BufferPtr buffer = QGst::Buffer::create(10);
+    QCOMPARE(buffer->iterateMeta().size(), 0);
+
+    buffer->addMeta<FrameInfo>()->sequence = 7;
+    buffer->addMeta<TransientInfo>()->value = 3;
+
+    QList<QGst::Meta> metas = buffer->iterateMeta();
+    QCOMPARE(metas.size(), 2);
+
+    QGst::Meta meta = buffer->getMeta(QGst::CustomMeta<FrameInfo>::api());
+    QVERIFY(meta.isValid());
+    QCOMPARE(meta.api(), QGst::CustomMeta<FrameInfo>::api());
+    QCOMPARE(QGst::CustomMeta<FrameInfo>::fromMeta(meta)->sequence, Q_UINT64_C(7));
+    QVERIFY(!QGst::CustomMeta<TransientInfo>::fromMeta(meta));
+
+    metas = buffer->iterateMeta(QGst::CustomMeta<TransientInfo>::api());
+    QCOMPARE(metas.size(), 1);
+    QCOMPARE(QGst::CustomMeta<TransientInfo>::fromMeta(metas.at(0))->value, 3);
+
+    QVERIFY(buffer->removeMeta(metas.at(0)));
+    QCOMPARE(buffer->iterateMeta().size(), 1);
+    QVERIFY(!buffer->getMeta(QGst::CustomMeta<TransientInfo>::api()).isValid());
+}
+
+void BufferTest::metaTransformTest()
+{
+    QGst::CustomMeta<FrameInfo>::registerMeta("QGstTestFrameInfoMeta");
+    QGst::CustomMeta<TransientInfo>::registerMeta("QGstTestTransientInfoMeta",
+                                                  QGst::Meta::DropOnTransform);
+
+    QGst::BufferPtr buffer = QGst::Buffer::create(10);
+    FrameInfo *info = buffer->addMeta<FrameInfo>();
+    info->sequence = 99;
+    info->labels.append("person");
+    buffer->addMeta<TransientInfo>()->value = 1;
+
+    //FrameInfo is copied on full copies only, TransientInfo is always dropped
+    QGst::BufferPtr copy = buffer->copy();
+    FrameInfo *copiedInfo = copy->getMeta<FrameInfo>();
+    QVERIFY(copiedInfo);
+    QVERIFY(copiedInfo != info);
+    QCOMPARE(copiedInfo->sequence, Q_UINT64_C(99));
+    QCOMPARE(copiedInfo->labels, info->labels);
+    QVERIFY(!copy->getMeta<TransientInfo>());
+    QCOMPARE(FrameInfo::instances, 2);
+
+    QGst::BufferPtr region = QGst::BufferPtr::wrap(
+            gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, 2, 4), false);
+    QVERIFY(!region->getMeta<FrameInfo>());
+    QVERIFY(!region->getMeta<TransientInfo>());
+}
+
 QTEST_APPLESS_MAIN(BufferTest)
 
 #include "moc_qgsttest.cpp"
@@ -29,6 +29,8 @@ private:
 private Q_SLOTS:
     void watchTest();
     void watchTestWithWatchRemoval();
+    void syncHandlerTest();
+    void syncHandlerFunctionTest();
 
 private:
     QEventLoop m_eventLoop;
@@ -120,6 +122,95 @@ void BusTest::watchTestWithWatchRemoval()
     thread.bus->removeSignalWatch();
 }
 
+namespace {
+
+/* Drops the application messages with an odd sequence number and counts the calls */
+struct OddDropper
+{
+    OddDropper(int *calls, int *destroyed) : calls(calls), destroyed(destroyed) {}
+    OddDropper(const OddDropper & other) : calls(other.calls), destroyed(other.destroyed) {}
+    ~OddDropper() { ++*destroyed; }
+
+    QGst::BusSyncReply operator()(QGst::MessageType type, GstMessage *message)
+    {
+        ++*calls;
+        if (type != QGst::MessageApplication) {
+            return QGst::BusPass;
+        }
+        int sequence = 0;
+        gst_structure_get_int(gst_message_get_structure(message), "sequence", &sequence);
+        return (sequence % 2) ? QGst::BusDrop : QGst::BusPass;
+    }
+
+    int *calls;
+    int *destroyed;
+};
+
+QGst::BusSyncReply dropAll(QGst::MessageType type, GstMessage *message)
+{
+    Q_UNUSED(type);
+    Q_UNUSED(message);
+    return QGst::BusDrop;
+}
+
+void postSequence(const QGst::BusPtr & bus, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        QGst::Structure s("test");
+        s.setValue("sequence", i);
+        bus->post(QGst::ApplicationMessage::create(bus, s));
+    }
+}
+
+} //anonymous namespace
+
+void BusTest::syncHandlerTest()
+{
+    QGst::BusPtr bus = QGst::Bus::create();
+    int calls = 0;
+    int destroyed = 0;
+
+    bus->setSyncHandler(OddDropper(&calls, &destroyed));
+    int destroyedBefore = destroyed; //the temporaries passed by value
+
+    postSequence(bus, 10);
+    QCOMPARE(calls, 10);
+
+    for (int i = 0; i < 10; i += 2) {
+        QGst::MessagePtr msg = bus->pop();
+        QVERIFY(!msg.isNull());
+        QCOMPARE(msg->internalStructure()->value("sequence").get<int>(), i);
+    }
+    QVERIFY(bus->pop().isNull());
+
+    //the installed copy goes away with the handler
+    bus->unsetSyncHandler();
+    QCOMPARE(destroyed, destroyedBefore + 1);
+
+    postSequence(bus, 2);
+    QCOMPARE(calls, 10);
+    QVERIFY(!bus->pop().isNull());
+    QVERIFY(!bus->pop().isNull());
+}
+
+void BusTest::syncHandlerFunctionTest()
+{
+    QGst::BusPtr bus = QGst::Bus::create();
+    int calls = 0;
+    int destroyed = 0;
+
+    bus->setSyncHandler(OddDropper(&calls, &destroyed));
+    int destroyedBefore = destroyed;
+
+    //replacing the handler destroys the previous one
+    bus->setSyncHandler(&dropAll);
+    QCOMPARE(destroyed, destroyedBefore + 1);
+
+    postSequence(bus, 4);
+    QCOMPARE(calls, 0);
+    QVERIFY(!bus->hasPendingMessages());
+}
+
 QTEST_MAIN(BusTest)
 
 #include "moc_qgsttest.cpp"
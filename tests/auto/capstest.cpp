@@ -30,6 +30,10 @@ private Q_SLOTS:
     void fullTest();
     void writabilityTest();
     void setValueTest();
+    void builderTest();
+    void rawMediaTest();
+    void buildBenchmark_data();
+    void buildBenchmark();
 };
 
 void CapsTest::simpleTest()
@@ -138,6 +142,98 @@ void CapsTest::setValueTest()
     }
 }
 
+void CapsTest::builderTest()
+{
+    QGlib::Quark width = QGlib::Quark::fromStaticString("width");
+    QGlib::Quark framerate = QGlib::Quark::fromStaticString("framerate");
+
+    QGst::CapsPtr caps = QGst::StructureBuilder("video/x-raw")
+            .set(QGlib::Quark::fromStaticString("format"), QGst::VideoFormatI420)
+            .set(width, QGst::IntRange(16, 4096))
+            .set(QGlib::Quark::fromStaticString("height"), QList<int>() << 240 << 480)
+            .set(framerate, QGst::Fraction(30, 1))
+            .set(QGlib::Quark::fromStaticString("interlaced"), false)
+            .set(QGlib::Quark::fromStaticString("colorimetry"),
+                 QList<const char*>() << "bt601" << "bt709")
+            .caps();
+
+    QGst::CapsPtr parsed = QGst::Caps::fromString("video/x-raw, format=(string)I420, "
+            "width=(int)[ 16, 4096 ], height=(int){ 240, 480 }, framerate=(fraction)30/1, "
+            "interlaced=(boolean)false, colorimetry=(string){ bt601, bt709 }");
+    QVERIFY(caps->equals(parsed));
+
+    QGst::StructureBuilder builder("audio/x-raw");
+    builder.set(QGlib::Quark::fromStaticString("rate"), 44100);
+    QGst::StructureBuilder copy(builder);
+    builder.set(QGlib::Quark::fromStaticString("rate"), 48000);
+    QCOMPARE(copy.structure().value("rate").get<int>(), 44100);
+    QCOMPARE(builder.structure().value("rate").get<int>(), 48000);
+}
+
+void CapsTest::rawMediaTest()
+{
+    QGst::CapsPtr video = QGst::Caps::rawVideo(QGst::VideoFormatBGRx, 320, 240,
+                                               QGst::Fraction(25, 1));
+    QVERIFY(video->isFixed());
+    QVERIFY(video->equals(QGst::Caps::fromString("video/x-raw, format=BGRx, width=320, "
+            "height=240, framerate=25/1, pixel-aspect-ratio=1/1")));
+
+    QGst::CapsPtr audio = QGst::Caps::rawAudio(QGst::AudioFormatS16LE, 48000, 2);
+    QVERIFY(audio->isFixed());
+    QVERIFY(audio->equals(QGst::Caps::fromString("audio/x-raw, format=S16LE, rate=48000, "
+            "channels=2, layout=interleaved")));
+}
+
+void CapsTest::buildBenchmark_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("fromString(QString)") << 0;
+    QTest::newRow("fromString(const char*)") << 1;
+    QTest::newRow("StructureBuilder") << 2;
+    QTest::newRow("rawVideo") << 3;
+}
+
+void CapsTest::buildBenchmark()
+{
+    QFETCH(int, method);
+
+    const QGlib::Quark format = QGlib::Quark::fromStaticString("format");
+    const QGlib::Quark width = QGlib::Quark::fromStaticString("width");
+    const QGlib::Quark height = QGlib::Quark::fromStaticString("height");
+    const QGlib::Quark framerate = QGlib::Quark::fromStaticString("framerate");
+    const QGlib::Quark par = QGlib::Quark::fromStaticString("pixel-aspect-ratio");
+    int w = 640, h = 480;
+    QGst::CapsPtr caps;
+
+    QBENCHMARK {
+        switch (method) {
+        case 0:
+            caps = QGst::Caps::fromString(QString("video/x-raw, format=I420, width=%1, "
+                    "height=%2, framerate=30/1, pixel-aspect-ratio=1/1").arg(w).arg(h));
+            break;
+        case 1:
+            caps = QGst::Caps::fromString("video/x-raw, format=I420, width=640, "
+                    "height=480, framerate=30/1, pixel-aspect-ratio=1/1");
+            break;
+        case 2:
+            caps = QGst::StructureBuilder("video/x-raw")
+                    .set(format, QGst::VideoFormatI420)
+                    .set(width, w)
+                    .set(height, h)
+                    .set(framerate, QGst::Fraction(30, 1))
+                    .set(par, QGst::Fraction(1, 1))
+                    .caps();
+            break;
+        default:
+            caps = QGst::Caps::rawVideo(QGst::VideoFormatI420, w, h, QGst::Fraction(30, 1));
+            break;
+        }
+    }
+
+    QVERIFY(caps->equals(QGst::Caps::rawVideo(QGst::VideoFormatI420, 640, 480,
+                                              QGst::Fraction(30, 1))));
+}
+
 QTEST_APPLESS_MAIN(CapsTest)
 
 #include "moc_qgsttest.cpp"
@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Caps>
+#include <QGst/Structure>
+#include <QGst/Utils/FrameGrabber>
+
+class FrameGrabberTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QString numbersUri();
+    static int frameWidth(const QGst::SamplePtr & sample);
+
+private Q_SLOTS:
+    void grabTest();
+    void positionsTest();
+    void reuseTest();
+    void invalidUriTest();
+    void grabAllBenchmark();
+};
+
+//static
+QString FrameGrabberTest::numbersUri()
+{
+    return QUrl::fromLocalFile(QString::fromLocal8Bit(SRCDIR) + "/data/numbers.ogv").toString();
+}
+
+//static
+int FrameGrabberTest::frameWidth(const QGst::SamplePtr & sample)
+{
+    return sample->caps()->structureView(0).value("width").get<int>();
+}
+
+void FrameGrabberTest::grabTest()
+{
+    QGst::Utils::FrameGrabber grabber;
+    grabber.setWidth(80);
+
+    QList<QGst::SamplePtr> frames = grabber.grab(numbersUri(), 3);
+    if (frames.isEmpty()) {
+        QSKIP_PORT("The theora decoder or playbin is not available", SkipAll);
+    }
+
+    QCOMPARE(frames.size(), 3);
+    Q_FOREACH(const QGst::SamplePtr & frame, frames) {
+        QVERIFY(frame->buffer());
+        QCOMPARE(frameWidth(frame), 80);
+        //numbers.ogv is 160x120 with square pixels
+        QCOMPARE(frame->caps()->structureView(0).value("height").get<int>(), 60);
+    }
+}
+
+void FrameGrabberTest::positionsTest()
+{
+    QGst::Utils::FrameGrabber grabber;
+    QList<QGst::ClockTime> positions;
+    positions << QGst::ClockTime::fromMSecs(0)
+              << QGst::ClockTime::fromMSecs(1000)
+              << QGst::ClockTime::fromMSecs(1800);
+
+    QList<QGst::SamplePtr> frames = grabber.grab(numbersUri(), positions);
+    if (frames.isEmpty()) {
+        QSKIP_PORT("The theora decoder or playbin is not available", SkipAll);
+    }
+    QCOMPARE(frames.size(), positions.size());
+    QCOMPARE(frameWidth(frames.first()), grabber.width());
+}
+
+void FrameGrabberTest::reuseTest()
+{
+    QGst::Utils::FrameGrabber grabber;
+    grabber.setMaximumPipelines(1);
+
+    for (int i = 0; i < 3; ++i) {
+        if (grabber.grab(numbersUri(), 1).isEmpty()) {
+            QSKIP_PORT("The theora decoder or playbin is not available", SkipAll);
+        }
+    }
+    QCOMPARE(grabber.pipelinesCreated(), 1);
+
+    //a different width is applied to the existing pipeline
+    grabber.setWidth(40);
+    QList<QGst::SamplePtr> frames = grabber.grab(numbersUri(), 1);
+    QCOMPARE(frames.size(), 1);
+    QCOMPARE(frameWidth(frames.first()), 40);
+    QCOMPARE(grabber.pipelinesCreated(), 1);
+}
+
+void FrameGrabberTest::invalidUriTest()
+{
+    QGst::Utils::FrameGrabber grabber;
+    grabber.setTimeout(1000);
+    QVERIFY(grabber.grab(QUrl::fromLocalFile("/does/not/exist.ogv").toString(), 2).isEmpty());
+
+    //the pipeline must still be usable afterwards
+    grabber.setMaximumPipelines(1);
+    if (grabber.grab(numbersUri(), 1).isEmpty()) {
+        QSKIP_PORT("The theora decoder or playbin is not available", SkipAll);
+    }
+    QCOMPARE(grabber.pipelinesCreated(), 1);
+}
+
+void FrameGrabberTest::grabAllBenchmark()
+{
+    const int FilesCount = 16;
+    const int FramesPerFile = 4;
+
+    QStringList uris;
+    for (int i = 0; i < FilesCount; ++i) {
+        uris << numbersUri();
+    }
+
+    QGst::Utils::FrameGrabber grabber;
+    if (grabber.grab(numbersUri(), 1).isEmpty()) { //also warms up the first pipeline
+        QSKIP_PORT("The theora decoder or playbin is not available", SkipAll);
+    }
+
+    int frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        frames += grabber.grabAll(uris, FramesPerFile);
+    }
+    qint64 elapsed = timer.elapsed();
+
+    QVERIFY(frames > 0);
+    qDebug("%d frames in %lld ms using up to %d pipelines: %.1f frames/s",
+           frames, elapsed, grabber.maximumPipelines(),
+           elapsed > 0 ? frames * 1000.0 / elapsed : 0.0);
+}
+
+QTEST_APPLESS_MAIN(FrameGrabberTest)
+
+#include "moc_qgsttest.cpp"
+#include "framegrabbertest.moc"
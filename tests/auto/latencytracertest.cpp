@@ -0,0 +1,205 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bin>
+#include <QGst/Buffer>
+#include <QGst/ElementFactory>
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/ApplicationSource>
+#include <QGst/Utils/LatencyTracer>
+
+class LatencyTracerTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(const char *description);
+    static bool runToEos(const QGst::PipelinePtr & pipeline);
+    static QGst::PadPtr pad(const QGst::PipelinePtr & pipeline, const char *element,
+                            const char *padName);
+
+private Q_SLOTS:
+    void pathTest();
+    void multipleSourcesTest();
+    void transformTest();
+    void unstampedTest();
+    void applicationSourceTest();
+};
+
+//static
+QGst::PipelinePtr LatencyTracerTest::createPipeline(const char *description)
+{
+    try {
+        return QGst::Parse::launch(description).dynamicCast<QGst::Pipeline>();
+    } catch (const QGlib::Error &) {
+        return QGst::PipelinePtr();
+    }
+}
+
+//static
+bool LatencyTracerTest::runToEos(const QGst::PipelinePtr & pipeline)
+{
+    pipeline->setState(QGst::StatePlaying);
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 60 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    pipeline->setState(QGst::StateNull);
+    return ok;
+}
+
+//static
+QGst::PadPtr LatencyTracerTest::pad(const QGst::PipelinePtr & pipeline, const char *element,
+                                    const char *padName)
+{
+    return pipeline->getElementByName(element)->getStaticPad(padName);
+}
+
+void LatencyTracerTest::pathTest()
+{
+    //identity sleeps 2ms on every buffer
+    QGst::PipelinePtr pipeline = createPipeline(
+            "fakesrc name=src num-buffers=50 ! identity sleep-time=2000 ! "
+            "queue ! fakesink name=sink sync=false");
+    QVERIFY(pipeline);
+
+    QGst::Utils::LatencyTracer tracer;
+    int source = tracer.addSource(pad(pipeline, "src", "src"));
+    int sink = tracer.addSink(pad(pipeline, "sink", "sink"));
+    QCOMPARE(source, 0);
+    QCOMPARE(sink, 0);
+    QCOMPARE(tracer.sourceCount(), 1);
+    QCOMPARE(tracer.sinkCount(), 1);
+
+    QVERIFY(runToEos(pipeline));
+
+    QGst::Utils::LatencyTracer::Statistics s = tracer.statistics(source, sink);
+    QCOMPARE(s.count, Q_UINT64_C(50));
+    QVERIFY(s.p50 >= QGst::ClockTime::fromMSecs(2));
+    QVERIFY(s.p95 >= s.p50);
+    QVERIFY(s.p99 >= s.p95);
+    QVERIFY(s.max >= s.p99);
+    QCOMPARE(tracer.unstampedCount(sink), Q_UINT64_C(0));
+    QVERIFY(tracer.report().contains(QLatin1String("src:src -> sink:sink")));
+
+    tracer.reset();
+    QCOMPARE(tracer.statistics(source, sink).count, Q_UINT64_C(0));
+    QCOMPARE(tracer.statistics(source, 1).count, Q_UINT64_C(0));
+}
+
+void LatencyTracerTest::multipleSourcesTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "fakesrc name=src num-buffers=20 ! identity name=id sleep-time=1000 ! "
+            "tee name=t ! queue ! fakesink name=sink1 sync=false "
+            "t. ! queue ! fakesink name=sink2 sync=false");
+    QVERIFY(pipeline);
+
+    QGst::Utils::LatencyTracer tracer;
+    int src = tracer.addSource(pad(pipeline, "src", "src"));
+    int id = tracer.addSource(pad(pipeline, "id", "src"));
+    int sink1 = tracer.addSink(pad(pipeline, "sink1", "sink"));
+    int sink2 = tracer.addSink(pad(pipeline, "sink2", "sink"));
+
+    QVERIFY(runToEos(pipeline));
+
+    for (int sink = sink1; sink <= sink2; ++sink) {
+        QGst::Utils::LatencyTracer::Statistics whole = tracer.statistics(src, sink);
+        QGst::Utils::LatencyTracer::Statistics tail = tracer.statistics(id, sink);
+        QCOMPARE(whole.count, Q_UINT64_C(20));
+        QCOMPARE(tail.count, Q_UINT64_C(20));
+        //the identity's sleep is only part of the path that starts at the fakesrc
+        QVERIFY(whole.p50 >= QGst::ClockTime::fromMSecs(1));
+        QVERIFY(whole.max >= tail.max);
+    }
+
+    for (int i = 2; i < QGst::Utils::LatencyTracer::MaxSources; ++i) {
+        QCOMPARE(tracer.addSource(pad(pipeline, "src", "src")), i);
+    }
+    QCOMPARE(tracer.addSource(pad(pipeline, "src", "src")), -1);
+}
+
+void LatencyTracerTest::transformTest()
+{
+    //videoconvert writes every frame to a new buffer and copies the metas to it
+    QGst::PipelinePtr pipeline = createPipeline(
+            "videotestsrc name=src num-buffers=20 ! video/x-raw,format=I420,width=64,height=48 ! "
+            "videoconvert ! video/x-raw,format=RGB ! fakesink name=sink sync=false");
+    if (!pipeline) {
+        QSKIP_PORT("videotestsrc or videoconvert is not available", SkipAll);
+    }
+
+    QGst::Utils::LatencyTracer tracer;
+    int source = tracer.addSource(pad(pipeline, "src", "src"));
+    int sink = tracer.addSink(pad(pipeline, "sink", "sink"));
+
+    QVERIFY(runToEos(pipeline));
+
+    QCOMPARE(tracer.statistics(source, sink).count, Q_UINT64_C(20));
+    QCOMPARE(tracer.unstampedCount(sink), Q_UINT64_C(0));
+}
+
+void LatencyTracerTest::unstampedTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "fakesrc num-buffers=10 ! fakesink name=sink sync=false");
+    QVERIFY(pipeline);
+
+    QGst::Utils::LatencyTracer tracer;
+    int sink = tracer.addSink(pad(pipeline, "sink", "sink"));
+
+    QVERIFY(runToEos(pipeline));
+
+    QCOMPARE(tracer.unstampedCount(sink), Q_UINT64_C(10));
+    QVERIFY(tracer.report().isEmpty());
+}
+
+void LatencyTracerTest::applicationSourceTest()
+{
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    QGst::Utils::ApplicationSource src;
+    QGst::ElementPtr sink = QGst::ElementFactory::make("fakesink");
+    sink->setProperty("sync", false);
+    pipeline->add(src.element(), sink);
+    src.element()->link(sink);
+
+    QGst::Utils::LatencyTracer tracer;
+    int source = tracer.addSource(src.element()->getStaticPad("src"));
+    int sinkId = tracer.addSink(sink->getStaticPad("sink"));
+
+    //the application keeps its buffers, so they are shared when they leave appsrc
+    QList<QGst::BufferPtr> buffers;
+    for (int i = 0; i < 20; ++i) {
+        buffers.append(QGst::Buffer::create(16));
+        QCOMPARE(src.pushBuffer(buffers.last()), QGst::FlowOk);
+    }
+    QCOMPARE(src.endOfStream(), QGst::FlowOk);
+
+    QVERIFY(runToEos(pipeline));
+
+    QCOMPARE(tracer.statistics(source, sinkId).count, Q_UINT64_C(20));
+    QCOMPARE(tracer.unstampedCount(sinkId), Q_UINT64_C(0));
+}
+
+QTEST_APPLESS_MAIN(LatencyTracerTest)
+
+#include "moc_qgsttest.cpp"
+#include "latencytracertest.moc"
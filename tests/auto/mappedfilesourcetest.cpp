@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bin>
+#include <QGst/Buffer>
+#include <QGst/ElementFactory>
+#include <QGst/Pipeline>
+#include <QGst/Utils/ApplicationSink>
+#include <QGst/Utils/MappedFileSource>
+#include <QtCore/QTemporaryFile>
+
+class MappedFileSourceTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static bool createFile(QTemporaryFile *file, int size);
+    static bool runToEos(const QGst::PipelinePtr & pipeline);
+    static double throughput(const QGst::ElementPtr & source, qint64 size);
+
+private Q_SLOTS:
+    void openTest();
+    void dataTest();
+    void pullModeTest();
+    void throughputBenchmark();
+};
+
+//static
+bool MappedFileSourceTest::createFile(QTemporaryFile *file, int size)
+{
+    if (!file->open()) {
+        return false;
+    }
+    QByteArray chunk(64 * 1024, '\0');
+    for (int i = 0; i < chunk.size(); i++) {
+        chunk[i] = char(i * 7);
+    }
+    for (int written = 0; written < size; written += chunk.size()) {
+        file->write(chunk.constData(), qMin(chunk.size(), size - written));
+    }
+    file->flush();
+    return file->size() == size;
+}
+
+//static
+bool MappedFileSourceTest::runToEos(const QGst::PipelinePtr & pipeline)
+{
+    pipeline->setState(QGst::StatePlaying);
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 60 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    pipeline->setState(QGst::StateNull);
+    return ok;
+}
+
+//static
+double MappedFileSourceTest::throughput(const QGst::ElementPtr & source, qint64 size)
+{
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    QGst::ElementPtr sink = QGst::ElementFactory::make("fakesink");
+    sink->setProperty("sync", false);
+    source->setProperty("blocksize", 64 * 1024);
+    pipeline->add(source, sink);
+    source->link(sink);
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!runToEos(pipeline)) {
+        return 0;
+    }
+    //MiB/s
+    return size / 1048576.0 / (qMax<qint64>(timer.nsecsElapsed(), 1) / 1e9);
+}
+
+void MappedFileSourceTest::openTest()
+{
+    QGst::Utils::MappedFileSource src;
+    QVERIFY(!src.isOpen());
+    QVERIFY(!src.open(QString::fromLocal8Bit(SRCDIR) + "/data/does-not-exist"));
+    QVERIFY(!src.isOpen());
+
+    QString fileName = QString::fromLocal8Bit(SRCDIR) + "/data/numbers.ogv";
+    QVERIFY(src.open(fileName));
+    QVERIFY(src.isOpen());
+    QCOMPARE(src.fileName(), fileName);
+    QCOMPARE(src.size(), QFileInfo(fileName).size());
+    QCOMPARE(src.streamType(), QGst::AppStreamTypeRandomAccess);
+
+    src.close();
+    QVERIFY(!src.isOpen());
+}
+
+void MappedFileSourceTest::dataTest()
+{
+    QTemporaryFile file;
+    QVERIFY(createFile(&file, 1000 * 1000));
+
+    QGst::Utils::MappedFileSource src;
+    QGst::Utils::ApplicationSink sink;
+    QVERIFY(src.open(file.fileName()));
+    sink.element()->setProperty("sync", false);
+
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    pipeline->add(src.element(), sink.element());
+    src.element()->link(sink.element());
+    pipeline->setState(QGst::StatePlaying);
+
+    QByteArray data;
+    while (QGst::SamplePtr sample = sink.pullSample()) {
+        QGst::BufferPtr buffer = sample->buffer();
+        QByteArray chunk(buffer->size(), '\0');
+        buffer->extract(0, chunk.data(), chunk.size());
+        data += chunk;
+    }
+    pipeline->setState(QGst::StateNull);
+
+    file.seek(0);
+    QCOMPARE(data, file.readAll());
+    QCOMPARE(src.bytesPushed(), quint64(1000 * 1000));
+
+    //the buffers keep the mapping alive, not the source
+    src.close();
+}
+
+void MappedFileSourceTest::pullModeTest()
+{
+    QGst::Utils::MappedFileSource src;
+    QVERIFY(src.open(QString::fromLocal8Bit(SRCDIR) + "/data/numbers.ogv"));
+
+    QGst::ElementPtr demux = QGst::ElementFactory::make("oggdemux");
+    if (!demux) {
+        QSKIP_PORT("oggdemux is not available", SkipAll);
+    }
+
+    QGst::BinPtr bin = QGst::Bin::fromDescription("oggdemux name=demux ! fakesink sync=false",
+                                                  QGst::Bin::NoGhost);
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    pipeline->add(src.element(), bin);
+    QVERIFY(src.element()->link(bin->getElementByName("demux")));
+    QVERIFY(runToEos(pipeline));
+
+    //oggdemux pulls from the end of the file to find the duration
+    QVERIFY(src.seekCount() > 0);
+}
+
+void MappedFileSourceTest::throughputBenchmark()
+{
+    const int size = 64 * 1024 * 1024;
+    QTemporaryFile file;
+    QVERIFY(createFile(&file, size));
+
+    QGst::ElementPtr filesrc = QGst::ElementFactory::make("filesrc");
+    filesrc->setProperty("location", file.fileName());
+    //warm up the page cache, so that both measure the same thing
+    throughput(filesrc, size);
+
+    filesrc = QGst::ElementFactory::make("filesrc");
+    filesrc->setProperty("location", file.fileName());
+    double filesrcRate = throughput(filesrc, size);
+
+    QGst::Utils::MappedFileSource src;
+    QVERIFY(src.open(file.fileName()));
+    double mappedRate = throughput(src.element(), size);
+    QCOMPARE(src.bytesPushed(), quint64(size));
+
+    qDebug() << "filesrc:" << filesrcRate << "MiB/s, MappedFileSource:" << mappedRate << "MiB/s";
+    QVERIFY(filesrcRate > 0);
+    QVERIFY(mappedRate > 0);
+}
+
+QTEST_APPLESS_MAIN(MappedFileSourceTest)
+
+#include "moc_qgsttest.cpp"
+#include "mappedfilesourcetest.moc"
@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Clock>
+#include <QGst/Pipeline>
+#include <QGst/Utils/NetClientClock>
+#include <QGst/Utils/NetTimeProvider>
+
+class NetClockTest : public QGstTest
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void providerTest();
+    void syncTest();
+    void slavePipelineTest();
+};
+
+void NetClockTest::providerTest()
+{
+    QGst::ClockPtr clock = QGst::Clock::systemClock();
+    QGst::Utils::NetTimeProvider provider(clock, "127.0.0.1");
+    QVERIFY(provider.isValid());
+    QCOMPARE(provider.clock(), clock);
+    QCOMPARE(provider.address(), QString("127.0.0.1"));
+    QVERIFY(provider.port() != 0);
+
+    QVERIFY(provider.isActive());
+    provider.setActive(false);
+    QVERIFY(!provider.isActive());
+    provider.setActive(true);
+    QVERIFY(provider.isActive());
+}
+
+void NetClockTest::syncTest()
+{
+    QGst::ClockPtr masterClock = QGst::Clock::systemClock();
+    QGst::Utils::NetTimeProvider provider(masterClock, "127.0.0.1");
+    QVERIFY(provider.isValid());
+
+    //several clients following the same provider over loopback
+    QList<QGst::Utils::NetClientClock*> clients;
+    for (int i = 0; i < 3; ++i) {
+        clients.append(new QGst::Utils::NetClientClock("127.0.0.1", provider.port()));
+    }
+
+    Q_FOREACH(QGst::Utils::NetClientClock *client, clients) {
+        QVERIFY(client->clock());
+        QCOMPARE(client->port(), provider.port());
+        QVERIFY(client->waitForSync(QGst::ClockTime::fromSeconds(10)));
+
+        QGst::Utils::NetClientClock::Statistics stats = client->statistics();
+        QVERIFY(stats.synchronized);
+        QVERIFY(stats.updates >= 1);
+        QVERIFY(stats.jitter >= 0);
+
+        //over loopback, the clocks must agree within a few milliseconds
+        qint64 difference = qint64(client->clock()->clockTime()) - qint64(masterClock->clockTime());
+        QVERIFY2(qAbs(difference) < qint64(QGst::ClockTime::fromMSecs(10)),
+                 QByteArray::number(difference).constData());
+    }
+
+    qDeleteAll(clients);
+}
+
+void NetClockTest::slavePipelineTest()
+{
+    QGst::Utils::NetTimeProvider provider(QGst::Clock::systemClock(), "127.0.0.1");
+    QVERIFY(provider.isValid());
+
+    QGst::PipelinePtr master = QGst::Pipeline::create();
+    QGst::ClockTime baseTime = provider.publish(master);
+    QVERIFY(baseTime.isValid());
+    QCOMPARE(QGst::ClockTime(gst_element_get_base_time(GST_ELEMENT(static_cast<GstPipeline*>(master)))),
+             baseTime);
+    QCOMPARE(QGst::ClockTime(gst_element_get_start_time(GST_ELEMENT(static_cast<GstPipeline*>(master)))),
+             QGst::ClockTime(QGst::ClockTime::None));
+
+    QGst::Utils::NetClientClock client("127.0.0.1", provider.port());
+    QGst::PipelinePtr slave = QGst::Pipeline::create();
+    client.slavePipeline(slave, baseTime);
+
+    GstElement *element = GST_ELEMENT(static_cast<GstPipeline*>(slave));
+    QCOMPARE(QGst::ClockTime(gst_element_get_base_time(element)), baseTime);
+    QCOMPARE(QGst::ClockTime(gst_element_get_start_time(element)),
+             QGst::ClockTime(QGst::ClockTime::None));
+
+    //the clock is only selected when the pipeline starts running
+    slave->setState(QGst::StatePlaying);
+    slave->getState(NULL, NULL, QGst::ClockTime::fromSeconds(5));
+    QCOMPARE(slave->clock(), client.clock());
+    slave->setState(QGst::StateNull);
+}
+
+QTEST_APPLESS_MAIN(NetClockTest)
+
+#include "moc_qgsttest.cpp"
+#include "netclocktest.moc"
@@ -0,0 +1,260 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/PipelinePool>
+#include <QGst/Utils/PipelineTemplate>
+
+class PipelinePoolTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static bool waitForEos(const QGst::PipelinePtr & pipeline);
+
+private Q_SLOTS:
+    void precompiledTemplateTest();
+    void fallbackTemplateTest();
+    void singleElementTemplateTest();
+    void invalidTemplateTest();
+    void templateCacheTest();
+    void acquireReleaseTest();
+    void propertiesTest();
+    void timeToFirstFrameTest();
+    void createBenchmark_data();
+    void createBenchmark();
+};
+
+//static
+bool PipelinePoolTest::waitForEos(const QGst::PipelinePtr & pipeline)
+{
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 30 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    return ok;
+}
+
+void PipelinePoolTest::precompiledTemplateTest()
+{
+    QGst::Utils::PipelineTemplate tmpl = QGst::Utils::PipelineTemplate::fromDescription(
+            "fakesrc name=src num-buffers=10 ! identity name=a silent=false ! fakesink name=sink");
+    QVERIFY(tmpl.isValid());
+    QVERIFY(tmpl.isPrecompiled());
+
+    QGst::PipelinePtr pipeline = tmpl.create();
+    QVERIFY(!pipeline.isNull());
+
+    QGst::ElementPtr src = pipeline->getElementByName("src");
+    QGst::ElementPtr identity = pipeline->getElementByName("a");
+    QGst::ElementPtr sink = pipeline->getElementByName("sink");
+    QVERIFY(!src.isNull());
+    QVERIFY(!identity.isNull());
+    QVERIFY(!sink.isNull());
+    QCOMPARE(src->property("num-buffers").get<int>(), 10);
+    QCOMPARE(identity->property("silent").get<bool>(), false);
+
+    //two instances do not share elements
+    QGst::PipelinePtr other = tmpl.create();
+    QVERIFY(static_cast<GstElement*>(other->getElementByName("a"))
+            != static_cast<GstElement*>(identity));
+
+    QVERIFY(pipeline->setState(QGst::StatePlaying) != QGst::StateChangeFailure);
+    QVERIFY(waitForEos(pipeline));
+    pipeline->setState(QGst::StateNull);
+}
+
+void PipelinePoolTest::fallbackTemplateTest()
+{
+    //links to request pads are made by the parser
+    QGst::Utils::PipelineTemplate tmpl = QGst::Utils::PipelineTemplate::fromDescription(
+            "fakesrc num-buffers=5 ! tee name=t t. ! queue ! fakesink t. ! queue ! fakesink");
+    QVERIFY(tmpl.isValid());
+    QVERIFY(!tmpl.isPrecompiled());
+
+    QGst::PipelinePtr pipeline = tmpl.create();
+    QVERIFY(!pipeline.isNull());
+    QVERIFY(!pipeline->getElementByName("t").isNull());
+
+    QVERIFY(pipeline->setState(QGst::StatePlaying) != QGst::StateChangeFailure);
+    QVERIFY(waitForEos(pipeline));
+    pipeline->setState(QGst::StateNull);
+}
+
+void PipelinePoolTest::singleElementTemplateTest()
+{
+    QGst::Utils::PipelineTemplate tmpl =
+            QGst::Utils::PipelineTemplate::fromDescription("fakesink name=sink");
+    QVERIFY(tmpl.isPrecompiled());
+
+    QGst::PipelinePtr pipeline = tmpl.create();
+    QVERIFY(!pipeline.isNull());
+    QVERIFY(!pipeline->getElementByName("sink").isNull());
+}
+
+void PipelinePoolTest::invalidTemplateTest()
+{
+    QVERIFY(!QGst::Utils::PipelineTemplate().isValid());
+    QVERIFY(QGst::Utils::PipelineTemplate().create().isNull());
+
+    try {
+        QGst::Utils::PipelineTemplate::fromDescription("fakesrc ! nonexistingelement");
+        QFAIL("Parsing an invalid description did not throw");
+    } catch (const QGlib::Error &) {
+    }
+}
+
+void PipelinePoolTest::templateCacheTest()
+{
+    const QString description = QLatin1String("fakesrc ! fakesink name=cached");
+    QGst::Utils::PipelineTemplate first = QGst::Utils::PipelineTemplate::fromDescription(description);
+    QGst::Utils::PipelineTemplate second = QGst::Utils::PipelineTemplate::fromDescription(description);
+    QCOMPARE(second.description(), description);
+
+    QGst::Utils::PipelineTemplate::clearCache();
+    QGst::Utils::PipelineTemplate third = QGst::Utils::PipelineTemplate::fromDescription(description);
+
+    //templates stay valid after they are removed from the cache
+    QVERIFY(first.isValid());
+    QVERIFY(!first.create().isNull());
+    QVERIFY(!third.create().isNull());
+}
+
+void PipelinePoolTest::acquireReleaseTest()
+{
+    QGst::Utils::PipelinePool pool(QGst::Utils::PipelineTemplate::fromDescription(
+            "fakesrc num-buffers=5 ! fakesink"), 2);
+    QVERIFY(pool.waitForReady(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(pool.availableCount(), 2);
+
+    QGst::PipelinePtr first = pool.acquire();
+    QVERIFY(!first.isNull());
+    QGst::State state;
+    first->getState(&state, NULL, QGst::ClockTime::None);
+    QCOMPARE(state, QGst::StateReady);
+
+    //the pool is refilled in the background
+    QGst::PipelinePtr second = pool.acquire();
+    QVERIFY(!second.isNull());
+    QVERIFY(pool.waitForReady(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(pool.availableCount(), 2);
+
+    QGst::Utils::PipelinePool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.acquired, Q_UINT64_C(2));
+    QCOMPARE(stats.misses, Q_UINT64_C(0));
+    QCOMPARE(stats.created, Q_UINT64_C(4));
+
+    //a full pool drops the released pipelines
+    pool.release(first);
+    pool.release(second);
+    QCOMPARE(pool.availableCount(), 2);
+    first->getState(&state, NULL, QGst::ClockTime::None);
+    QCOMPARE(state, QGst::StateNull);
+    QCOMPARE(pool.statistics().recycled, Q_UINT64_C(0));
+
+    //an empty pool builds the pipeline on the spot
+    pool.setSize(0);
+    QCOMPARE(pool.availableCount(), 0);
+    QGst::PipelinePtr third = pool.acquire();
+    QVERIFY(!third.isNull());
+    QCOMPARE(pool.statistics().misses, Q_UINT64_C(1));
+    pool.release(third);
+    QCOMPARE(pool.availableCount(), 0);
+}
+
+void PipelinePoolTest::propertiesTest()
+{
+    QGst::Utils::PipelinePool pool(QGst::Utils::PipelineTemplate::fromDescription(
+            "fakesrc name=src num-buffers=5 ! fakesink name=sink"), 1);
+    QVERIFY(pool.waitForReady(QGst::ClockTime::fromSeconds(10)));
+
+    QGst::Utils::PipelinePool::PropertyHash properties;
+    properties.insert(QLatin1String("src.num-buffers"), 3);
+    properties.insert(QLatin1String("sink.sync"), true);
+
+    QGst::PipelinePtr pipeline = pool.acquire(QString(), properties);
+    QCOMPARE(pipeline->getElementByName("src")->property("num-buffers").get<int>(), 3);
+    QCOMPARE(pipeline->getElementByName("sink")->property("sync").get<bool>(), true);
+
+    //the properties are restored whether the pipeline is recycled or dropped
+    pool.release(pipeline);
+    QCOMPARE(pipeline->getElementByName("src")->property("num-buffers").get<int>(), 5);
+    QCOMPARE(pipeline->getElementByName("sink")->property("sync").get<bool>(), false);
+
+    //it races with the pipeline that replaces it; either one ends up in the pool
+    QVERIFY(pool.waitForReady(QGst::ClockTime::fromSeconds(10)));
+    QCOMPARE(pool.availableCount(), 1);
+    QGst::State state;
+    pipeline->getState(&state, NULL, QGst::ClockTime::None);
+    QCOMPARE(state, pool.statistics().recycled ? QGst::StateReady : QGst::StateNull);
+}
+
+void PipelinePoolTest::timeToFirstFrameTest()
+{
+    QGst::Utils::PipelinePool pool(QGst::Utils::PipelineTemplate::fromDescription(
+            "fakesrc num-buffers=5 ! fakesink"), 1);
+    QVERIFY(pool.waitForReady(QGst::ClockTime::fromSeconds(10)));
+
+    for (int i = 0; i < 2; ++i) {
+        QGst::PipelinePtr pipeline = pool.acquire();
+        QCOMPARE(pool.statistics().firstFrames, quint64(i));
+        QVERIFY(pipeline->setState(QGst::StatePlaying) != QGst::StateChangeFailure);
+        QVERIFY(waitForEos(pipeline));
+        pool.release(pipeline);
+    }
+
+    QGst::Utils::PipelinePool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.firstFrames, Q_UINT64_C(2));
+    QVERIFY(stats.lastTimeToFirstFrame.isValid());
+    QVERIFY(stats.averageTimeToFirstFrame <= stats.maxTimeToFirstFrame);
+
+    pool.resetStatistics();
+    QCOMPARE(pool.statistics().firstFrames, Q_UINT64_C(0));
+    QVERIFY(!pool.statistics().maxTimeToFirstFrame.isValid());
+}
+
+void PipelinePoolTest::createBenchmark_data()
+{
+    QTest::addColumn<bool>("precompiled");
+    QTest::newRow("parse") << false;
+    QTest::newRow("template") << true;
+}
+
+void PipelinePoolTest::createBenchmark()
+{
+    QFETCH(bool, precompiled);
+    const QString description = QLatin1String(
+            "fakesrc name=src num-buffers=1 sizetype=fixed ! queue max-size-buffers=2 "
+            "! identity silent=true ! capsfilter ! fakesink sync=false");
+    QGst::Utils::PipelineTemplate tmpl = QGst::Utils::PipelineTemplate::fromDescription(description);
+    QVERIFY(tmpl.isPrecompiled());
+
+    QBENCHMARK {
+        QGst::PipelinePtr pipeline = precompiled ? tmpl.create()
+                : QGst::Parse::launch(description).dynamicCast<QGst::Pipeline>();
+        QVERIFY(!pipeline.isNull());
+    }
+}
+
+QTEST_APPLESS_MAIN(PipelinePoolTest)
+
+#include "moc_qgsttest.cpp"
+#include "pipelinepooltest.moc"
@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/PositionTracker>
+#include <QtCore/QElapsedTimer>
+
+class PositionTrackerTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(QGst::State state);
+    static void setState(const QGst::PipelinePtr & pipeline, QGst::State state);
+    static bool seek(const QGst::PipelinePtr & pipeline, double rate, GstClockTime position);
+    static qint64 queryPosition(const QGst::PipelinePtr & pipeline);
+    /* Runs the default main context, which dispatches the bus messages
+     * to the tracker, for \a msecs milliseconds */
+    static void iterate(int msecs);
+
+private Q_SLOTS:
+    void seekTest();
+    void rateTest();
+    void pauseResumeTest();
+    void bufferingTest();
+};
+
+//static
+QGst::PipelinePtr PositionTrackerTest::createPipeline(QGst::State state)
+{
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(
+            "videotestsrc ! video/x-raw,framerate=25/1 ! fakesink sync=true")
+        .dynamicCast<QGst::Pipeline>();
+    setState(pipeline, state);
+    return pipeline;
+}
+
+//static
+void PositionTrackerTest::setState(const QGst::PipelinePtr & pipeline, QGst::State state)
+{
+    pipeline->setState(state);
+    pipeline->getState(NULL, NULL, QGst::ClockTime::fromSeconds(10));
+    iterate(50);
+}
+
+//static
+bool PositionTrackerTest::seek(const QGst::PipelinePtr & pipeline, double rate, GstClockTime position)
+{
+    bool ok = gst_element_seek(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)), rate,
+                               GST_FORMAT_TIME, GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                               GST_SEEK_TYPE_SET, position, GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+    pipeline->getState(NULL, NULL, QGst::ClockTime::fromSeconds(10));
+    iterate(50);
+    return ok;
+}
+
+//static
+qint64 PositionTrackerTest::queryPosition(const QGst::PipelinePtr & pipeline)
+{
+    gint64 position = -1;
+    gst_element_query_position(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)),
+                               GST_FORMAT_TIME, &position);
+    return position;
+}
+
+//static
+void PositionTrackerTest::iterate(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < msecs) {
+        if (!g_main_context_iteration(NULL, FALSE)) {
+            g_usleep(1000);
+        }
+    }
+}
+
+void PositionTrackerTest::seekTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(QGst::StatePaused);
+    QGst::Utils::PositionTracker tracker;
+    tracker.setPipeline(pipeline);
+    iterate(50);
+
+    QVERIFY(tracker.isValid());
+    QVERIFY(!tracker.sink().isNull());
+    QCOMPARE(tracker.position(), QGst::ClockTime(0));
+
+    //the new segment and the preroll that follows the flush resynchronize the tracker
+    uint resyncs = tracker.resyncCount();
+    QVERIFY(seek(pipeline, 1.0, 3 * GST_SECOND));
+    QVERIFY(tracker.resyncCount() > resyncs);
+    QCOMPARE(tracker.position(), QGst::ClockTime::fromSeconds(3));
+    QCOMPARE(qint64(tracker.position()), queryPosition(pipeline));
+
+    //playback continues from the seek position
+    setState(pipeline, QGst::StatePlaying);
+    iterate(200);
+    QVERIFY(tracker.position() > QGst::ClockTime::fromSeconds(3));
+    QVERIFY(qAbs(qint64(tracker.position()) - queryPosition(pipeline)) < 100 * GST_MSECOND);
+
+    pipeline->setState(QGst::StateNull);
+    iterate(50);
+    QVERIFY(!tracker.isValid());
+}
+
+void PositionTrackerTest::rateTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(QGst::StatePaused);
+    QGst::Utils::PositionTracker tracker;
+    tracker.setPipeline(pipeline);
+    QCOMPARE(tracker.rate(), 1.0);
+
+    //the rate change arrives with the new segment
+    QVERIFY(seek(pipeline, 2.0, 0));
+    QCOMPARE(tracker.rate(), 2.0);
+
+    QElapsedTimer timer;
+    timer.start();
+    setState(pipeline, QGst::StatePlaying);
+    iterate(300);
+    qint64 elapsed = timer.elapsed();
+
+    //the position advances twice as fast as the clock
+    QVERIFY(qint64(tracker.position()) > qint64(elapsed * GST_MSECOND));
+    QVERIFY(qAbs(qint64(tracker.position()) - queryPosition(pipeline)) < 100 * GST_MSECOND);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void PositionTrackerTest::pauseResumeTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(QGst::StatePlaying);
+    QGst::Utils::PositionTracker tracker;
+    tracker.setPipeline(pipeline);
+    iterate(200);
+
+    //the position stops while paused, where the sink stopped
+    setState(pipeline, QGst::StatePaused);
+    QGst::ClockTime paused = tracker.position();
+    QVERIFY(paused > QGst::ClockTime(0));
+    iterate(100);
+    QCOMPARE(tracker.position(), paused);
+    QVERIFY(qAbs(qint64(paused) - queryPosition(pipeline)) < 100 * GST_MSECOND);
+
+    //and continues from there when resumed
+    uint resyncs = tracker.resyncCount();
+    setState(pipeline, QGst::StatePlaying);
+    QVERIFY(tracker.resyncCount() > resyncs);
+    iterate(100);
+    QVERIFY(tracker.position() > paused);
+    QVERIFY(qAbs(qint64(tracker.position()) - queryPosition(pipeline)) < 100 * GST_MSECOND);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void PositionTrackerTest::bufferingTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(QGst::StatePaused);
+    QGst::Utils::PositionTracker tracker;
+    tracker.setPipeline(pipeline);
+    iterate(50);
+
+    GstElement *element = GST_ELEMENT(static_cast<GstPipeline*>(pipeline));
+    uint resyncs = tracker.resyncCount();
+
+    //buffering in progress does not interrupt the timeline
+    gst_element_post_message(element, gst_message_new_buffering(GST_OBJECT(element), 50));
+    iterate(50);
+    QCOMPARE(tracker.resyncCount(), resyncs);
+
+    //the end of buffering does
+    gst_element_post_message(element, gst_message_new_buffering(GST_OBJECT(element), 100));
+    iterate(50);
+    QCOMPARE(tracker.resyncCount(), resyncs + 1);
+    QCOMPARE(tracker.position(), QGst::ClockTime(0));
+
+    pipeline->setState(QGst::StateNull);
+}
+
+QTEST_APPLESS_MAIN(PositionTrackerTest)
+
+#include "moc_qgsttest.cpp"
+#include "positiontrackertest.moc"
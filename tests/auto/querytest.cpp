@@ -17,10 +17,95 @@
 */
 #include "qgsttest.h"
 #include <QGst/Query>
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/PlaybackStatusQuery>
+#include <QtCore/QAtomicInt>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+/* Allocation counters for reuseBenchmark. C++ allocations, which include the
+ * construction of wrappers, are counted by replacing the global operator new,
+ * and GstQuery allocations through the query debug category. */
+QAtomicInt s_counting;
+QAtomicInt s_cppAllocations;
+QAtomicInt s_queryAllocations;
+
+inline bool counting()
+{
+#if QT_VERSION >= 0x050000
+    return s_counting.loadAcquire() != 0;
+#else
+    return s_counting.fetchAndAddAcquire(0) != 0;
+#endif
+}
+
+inline int load(QAtomicInt & value)
+{
+#if QT_VERSION >= 0x050000
+    return value.loadAcquire();
+#else
+    return value.fetchAndAddAcquire(0);
+#endif
+}
+
+void countQueryAllocations(GstDebugCategory *category, GstDebugLevel level,
+                           const gchar *file, const gchar *function, gint line,
+                           GObject *object, GstDebugMessage *message, gpointer data)
+{
+    Q_UNUSED(level); Q_UNUSED(file); Q_UNUSED(function); Q_UNUSED(line);
+    Q_UNUSED(object); Q_UNUSED(data);
+    if (counting() && std::strcmp(gst_debug_category_get_name(category), "query") == 0
+        && g_str_has_prefix(gst_debug_message_get(message), "creating new query"))
+    {
+        s_queryAllocations.ref();
+    }
+}
+
+enum ReuseMode { CreatePerTick, Reuse, PlaybackStatus };
+
+} //anonymous namespace
+
+#if __cplusplus >= 201103L
+# define QUERYTEST_THROW_BAD_ALLOC
+# define QUERYTEST_NOTHROW noexcept
+#else
+# define QUERYTEST_THROW_BAD_ALLOC throw(std::bad_alloc)
+# define QUERYTEST_NOTHROW throw()
+#endif
+
+void *operator new(std::size_t size) QUERYTEST_THROW_BAD_ALLOC
+{
+    if (counting()) {
+        s_cppAllocations.ref();
+    }
+    void *p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) QUERYTEST_NOTHROW
+{
+    std::free(p);
+}
 
 class QueryTest : public QGstTest
 {
     Q_OBJECT
+private:
+    struct Poller
+    {
+        QGst::PositionQueryPtr position;
+        QGst::DurationQueryPtr duration;
+        QGst::Utils::PlaybackStatusQuery status;
+    };
+    static void poll(int mode, const QGst::PipelinePtr & pipeline, Poller *poller);
+
 private Q_SLOTS:
     void baseTest();
     void positionTest();
@@ -32,6 +117,11 @@ private Q_SLOTS:
     void formatsTest();
     void bufferingTest();
     void uriTest();
+    void resetTest();
+    void reuseTest();
+    void playbackStatusTest();
+    void reuseBenchmark_data();
+    void reuseBenchmark();
 };
 
 void QueryTest::baseTest()
@@ -179,6 +269,188 @@ void QueryTest::uriTest()
     QCOMPARE(query->uri(), QUrl::fromLocalFile("/bin/sh"));
 }
 
+void QueryTest::resetTest()
+{
+    QGst::PositionQueryPtr position = QGst::PositionQuery::create(QGst::FormatTime);
+    position->setValues(QGst::FormatTime, 1234567);
+    position->reset();
+    QVERIFY(position->format()==QGst::FormatTime);
+    QCOMPARE(position->position(), static_cast<qint64>(-1));
+
+    QGst::DurationQueryPtr duration = QGst::DurationQuery::create(QGst::FormatBytes);
+    duration->setValues(QGst::FormatBytes, 1234567);
+    duration->reset();
+    QVERIFY(duration->format()==QGst::FormatBytes);
+    QCOMPARE(duration->duration(), static_cast<qint64>(-1));
+
+    QGst::BufferingQueryPtr buffering = QGst::BufferingQuery::create(QGst::FormatPercent);
+    buffering->setBufferingPercent(true, 42);
+    buffering->setBufferingStats(QGst::BufferingLive, 1, 2, 3);
+    buffering->setBufferingRange(QGst::FormatPercent, 10, 20, 30);
+    buffering->reset();
+    QVERIFY(!buffering->isBusy());
+    QCOMPARE(buffering->percent(), 100);
+    QVERIFY(buffering->mode()==QGst::BufferingStream);
+    QCOMPARE(buffering->bufferingLeft(), static_cast<qint64>(0));
+    QVERIFY(buffering->rangeFormat()==QGst::FormatPercent);
+    QCOMPARE(buffering->rangeStart(), static_cast<qint64>(-1));
+    QCOMPARE(buffering->estimatedTotal(), static_cast<qint64>(-1));
+}
+
+void QueryTest::reuseTest()
+{
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(
+            "audiotestsrc num-buffers=100 ! fakesink sync=false").dynamicCast<QGst::Pipeline>();
+    QVERIFY(pipeline);
+    pipeline->setState(QGst::StatePaused);
+    QCOMPARE(pipeline->getState(NULL, NULL, QGst::ClockTime::None), QGst::StateChangeSuccess);
+
+    QGst::PositionQueryPtr query = QGst::PositionQuery::create(QGst::FormatTime);
+    GstQuery *gstQuery = query;
+
+    for (int i = 0; i < 10; ++i) {
+        query->reset();
+        QVERIFY(pipeline->query(query));
+        QVERIFY(query->position() >= 0);
+
+        //the same GstQuery is reused and stays writable
+        QCOMPARE(static_cast<GstQuery*>(query), gstQuery);
+        QVERIFY(query->isWritable());
+    }
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void QueryTest::playbackStatusTest()
+{
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(QString::fromLatin1(
+            "filesrc location=\"%1/data/sine.ogg\" ! decodebin ! fakesink sync=false")
+            .arg(QString::fromLocal8Bit(SRCDIR))).dynamicCast<QGst::Pipeline>();
+    QVERIFY(pipeline);
+    pipeline->setState(QGst::StatePaused);
+    QCOMPARE(pipeline->getState(NULL, NULL, QGst::ClockTime::None), QGst::StateChangeSuccess);
+
+    QVERIFY(pipeline->seek(QGst::FormatTime, QGst::SeekFlagFlush | QGst::SeekFlagAccurate,
+                           QGst::ClockTime::fromSeconds(1)));
+    QCOMPARE(pipeline->getState(NULL, NULL, QGst::ClockTime::None), QGst::StateChangeSuccess);
+
+    QGst::Utils::PlaybackStatusQuery status;
+    QVERIFY(status.format()==QGst::FormatTime);
+    GstQuery *position = status.positionQuery();
+    GstQuery *duration = status.durationQuery();
+    GstQuery *buffering = status.bufferingQuery();
+
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(status.run(pipeline), QGst::Utils::PlaybackStatusQuery::QueryTypes(
+                    QGst::Utils::PlaybackStatusQuery::All));
+        QCOMPARE(status.position(), static_cast<qint64>(GST_SECOND));
+        QCOMPARE(status.duration(), static_cast<qint64>(2 * GST_SECOND));
+        QVERIFY(!status.isBuffering());
+        QCOMPARE(status.bufferingPercent(), 100);
+
+        //the queries are reset and reused on every run
+        QCOMPARE(static_cast<GstQuery*>(status.positionQuery()), position);
+        QCOMPARE(static_cast<GstQuery*>(status.durationQuery()), duration);
+        QCOMPARE(static_cast<GstQuery*>(status.bufferingQuery()), buffering);
+    }
+
+    //only the requested queries are issued
+    status.positionQuery()->setValues(QGst::FormatTime, 1234567);
+    QCOMPARE(status.run(pipeline, QGst::Utils::PlaybackStatusQuery::Duration),
+             QGst::Utils::PlaybackStatusQuery::QueryTypes(QGst::Utils::PlaybackStatusQuery::Duration));
+    QCOMPARE(status.position(), static_cast<qint64>(1234567));
+    QCOMPARE(status.duration(), static_cast<qint64>(2 * GST_SECOND));
+
+    QCOMPARE(status.run(QGst::ElementPtr()), QGst::Utils::PlaybackStatusQuery::QueryTypes());
+
+    pipeline->setState(QGst::StateNull);
+}
+
+//static
+void QueryTest::poll(int mode, const QGst::PipelinePtr & pipeline, Poller *poller)
+{
+    switch (mode) {
+    case PlaybackStatus:
+        poller->status.run(pipeline, QGst::Utils::PlaybackStatusQuery::Position
+                                     | QGst::Utils::PlaybackStatusQuery::Duration);
+        break;
+    case Reuse:
+        poller->position->reset();
+        poller->duration->reset();
+        pipeline->query(poller->position);
+        pipeline->query(poller->duration);
+        break;
+    default:
+        poller->position = QGst::PositionQuery::create(QGst::FormatTime);
+        poller->duration = QGst::DurationQuery::create(QGst::FormatTime);
+        pipeline->query(poller->position);
+        pipeline->query(poller->duration);
+        break;
+    }
+}
+
+void QueryTest::reuseBenchmark_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("create per tick") << int(CreatePerTick);
+    QTest::newRow("reuse") << int(Reuse);
+    QTest::newRow("PlaybackStatusQuery") << int(PlaybackStatus);
+}
+
+void QueryTest::reuseBenchmark()
+{
+    QFETCH(int, mode);
+
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(
+            "audiotestsrc ! fakesink sync=false").dynamicCast<QGst::Pipeline>();
+    pipeline->setState(QGst::StatePaused);
+    pipeline->getState(NULL, NULL, QGst::ClockTime::None);
+
+    Poller poller;
+    poller.position = QGst::PositionQuery::create(QGst::FormatTime);
+    poller.duration = QGst::DurationQuery::create(QGst::FormatTime);
+
+#ifndef GST_DISABLE_GST_DEBUG
+    //allocations per tick, after a first tick that may allocate once
+    const int ticks = 100;
+    poll(mode, pipeline, &poller);
+    gst_debug_remove_log_function(gst_debug_log_default);
+    gst_debug_add_log_function(&countQueryAllocations, NULL, NULL);
+    gst_debug_set_threshold_for_name("query", GST_LEVEL_LOG);
+    s_cppAllocations.fetchAndStoreRelease(0);
+    s_queryAllocations.fetchAndStoreRelease(0);
+    s_counting.fetchAndStoreRelease(1);
+    for (int i = 0; i < ticks; ++i) {
+        poll(mode, pipeline, &poller);
+    }
+    s_counting.fetchAndStoreRelease(0);
+    gst_debug_unset_threshold_for_name("query");
+    gst_debug_remove_log_function(&countQueryAllocations);
+    gst_debug_add_log_function(gst_debug_log_default, NULL, NULL);
+
+    const int queries = load(s_queryAllocations);
+    const int cppAllocations = load(s_cppAllocations);
+    qDebug() << "per tick:" << double(queries) / ticks << "GstQuery allocations,"
+             << double(cppAllocations) / ticks << "C++ allocations";
+    if (mode == CreatePerTick) {
+        //makes sure that the allocations are actually seen
+        QCOMPARE(queries, 2 * ticks);
+        QVERIFY(cppAllocations >= 2 * ticks);
+    } else {
+        QCOMPARE(queries, 0);
+    }
+    if (mode == PlaybackStatus) {
+        QCOMPARE(cppAllocations, 0);
+    }
+#endif
+
+    QBENCHMARK {
+        poll(mode, pipeline, &poller);
+    }
+
+    pipeline->setState(QGst::StateNull);
+}
+
 QTEST_APPLESS_MAIN(QueryTest)
 
 #include "moc_qgsttest.cpp"
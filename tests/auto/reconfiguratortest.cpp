@@ -0,0 +1,215 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bin>
+#include <QGst/ElementFactory>
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/Reconfigurator>
+
+namespace {
+
+const int BufferCount = 300;
+
+/* Counts the buffers that reach a pad */
+struct BufferCounter
+{
+    BufferCounter() : count(0) {}
+
+    QAtomicInt count;
+
+    static GstPadProbeReturn probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+    {
+        Q_UNUSED(pad);
+        Q_UNUSED(info);
+        static_cast<BufferCounter*>(user_data)->count.ref();
+        return GST_PAD_PROBE_OK;
+    }
+
+    int value() const
+    {
+#if QT_VERSION >= 0x050000
+        return count.loadAcquire();
+#else
+        return const_cast<QAtomicInt&>(count).fetchAndAddAcquire(0);
+#endif
+    }
+};
+
+class RecordingReconfigurator : public QGst::Utils::Reconfigurator
+{
+public:
+    RecordingReconfigurator() : blockedCount(0), finishedCount(0) {}
+
+    int blockedCount;
+    int finishedCount;
+
+protected:
+    virtual void blocked() { ++blockedCount; }
+    virtual void finished(const Report &) { ++finishedCount; }
+};
+
+} //anonymous namespace
+
+class ReconfiguratorTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(BufferCounter *counter);
+    static bool waitForEos(const QGst::PipelinePtr & pipeline);
+
+private Q_SLOTS:
+    void replaceTest();
+    void insertTest();
+    void removeTest();
+    void invalidTest();
+};
+
+//static
+QGst::PipelinePtr ReconfiguratorTest::createPipeline(BufferCounter *counter)
+{
+    //identity sleeps 2ms per buffer, so the pipeline is still running when it is changed
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(QString(
+            "fakesrc name=src num-buffers=%1 sizetype=fixed sizemax=64 "
+            "! identity name=a sleep-time=2000 ! fakesink name=sink sync=false")
+            .arg(BufferCount)).dynamicCast<QGst::Pipeline>();
+    QGst::PadPtr pad = pipeline->getElementByName("sink")->getStaticPad("sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &BufferCounter::probe, counter, NULL);
+    return pipeline;
+}
+
+//static
+bool ReconfiguratorTest::waitForEos(const QGst::PipelinePtr & pipeline)
+{
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 30 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    return ok;
+}
+
+void ReconfiguratorTest::replaceTest()
+{
+    BufferCounter counter;
+    QGst::PipelinePtr pipeline = createPipeline(&counter);
+    pipeline->setState(QGst::StatePlaying);
+    g_usleep(100000);
+
+    QGst::ElementPtr oldElement = pipeline->getElementByName("a");
+    QGst::ElementPtr newElement = QGst::ElementFactory::make("identity", "b");
+    newElement->setProperty("sleep-time", 2000);
+
+    RecordingReconfigurator reconfigurator;
+    QVERIFY(reconfigurator.replace(oldElement, newElement));
+    QVERIFY(reconfigurator.isBusy());
+    QVERIFY(!reconfigurator.replace(oldElement, newElement));
+    QVERIFY(reconfigurator.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+
+    QGst::Utils::Reconfigurator::Report report = reconfigurator.lastReport();
+    QVERIFY(report.success);
+    QVERIFY(report.drained);
+    QVERIFY(report.blockedTime.isValid());
+    QVERIFY(report.gap.isValid());
+    QCOMPARE(reconfigurator.blockedCount, 1);
+    QCOMPARE(reconfigurator.finishedCount, 1);
+
+    QVERIFY(!pipeline->getElementByName("a"));
+    QCOMPARE(static_cast<GstElement*>(pipeline->getElementByName("b")),
+             static_cast<GstElement*>(newElement));
+    QVERIFY(!oldElement->parent());
+    QCOMPARE(oldElement->currentState(), QGst::StateNull);
+
+    //identity holds no data, so nothing may be lost or duplicated
+    QVERIFY(waitForEos(pipeline));
+    QCOMPARE(counter.value(), BufferCount);
+    pipeline->setState(QGst::StateNull);
+}
+
+void ReconfiguratorTest::insertTest()
+{
+    BufferCounter counter;
+    QGst::PipelinePtr pipeline = createPipeline(&counter);
+    pipeline->setState(QGst::StatePlaying);
+    g_usleep(100000);
+
+    QGst::PadPtr srcPad = pipeline->getElementByName("a")->getStaticPad("src");
+    QGst::ElementPtr queue = QGst::ElementFactory::make("queue", "q");
+
+    RecordingReconfigurator reconfigurator;
+    QVERIFY(reconfigurator.insert(srcPad, queue));
+    QVERIFY(reconfigurator.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+
+    QGst::Utils::Reconfigurator::Report report = reconfigurator.lastReport();
+    QVERIFY(report.success);
+    QCOMPARE(reconfigurator.finishedCount, 1);
+    QCOMPARE(static_cast<GstElement*>(srcPad->peer()->parentElement()),
+             static_cast<GstElement*>(queue));
+    QCOMPARE(queue->currentState(), QGst::StatePlaying);
+
+    QVERIFY(waitForEos(pipeline));
+    QCOMPARE(counter.value(), BufferCount);
+    pipeline->setState(QGst::StateNull);
+}
+
+void ReconfiguratorTest::removeTest()
+{
+    BufferCounter counter;
+    QGst::PipelinePtr pipeline = createPipeline(&counter);
+    pipeline->setState(QGst::StatePlaying);
+    g_usleep(100000);
+
+    QGst::ElementPtr element = pipeline->getElementByName("a");
+
+    RecordingReconfigurator reconfigurator;
+    QVERIFY(reconfigurator.remove(element));
+    QVERIFY(reconfigurator.waitForFinished(QGst::ClockTime::fromSeconds(10)));
+
+    QGst::Utils::Reconfigurator::Report report = reconfigurator.lastReport();
+    QVERIFY(report.success);
+    QVERIFY(report.drained);
+    QVERIFY(!pipeline->getElementByName("a"));
+    QCOMPARE(static_cast<GstElement*>(
+                 pipeline->getElementByName("src")->getStaticPad("src")->peer()->parentElement()),
+             static_cast<GstElement*>(pipeline->getElementByName("sink")));
+
+    QVERIFY(waitForEos(pipeline));
+    QCOMPARE(counter.value(), BufferCount);
+    pipeline->setState(QGst::StateNull);
+}
+
+void ReconfiguratorTest::invalidTest()
+{
+    QGst::ElementPtr unlinked = QGst::ElementFactory::make("identity");
+    QGst::ElementPtr other = QGst::ElementFactory::make("identity");
+
+    QGst::Utils::Reconfigurator reconfigurator;
+    QVERIFY(!reconfigurator.replace(unlinked, other));
+    QVERIFY(!reconfigurator.remove(unlinked));
+    QVERIFY(!reconfigurator.insert(unlinked->getStaticPad("src"), other));
+    QVERIFY(!reconfigurator.isBusy());
+    QVERIFY(reconfigurator.waitForFinished(0));
+    QVERIFY(!reconfigurator.lastReport().success);
+}
+
+QTEST_APPLESS_MAIN(ReconfiguratorTest)
+
+#include "moc_qgsttest.cpp"
+#include "reconfiguratortest.moc"
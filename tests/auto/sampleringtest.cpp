@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bus>
+#include <QGst/Caps>
+#include <QGst/Buffer>
+#include <QGst/Pipeline>
+#include <QGst/Utils/ApplicationSource>
+#include <QGst/Utils/SampleRing>
+
+class SampleRingTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    /* Runs appsrc ! ring with \a count buffers, whose offsets are their index. */
+    static QGst::PipelinePtr start(QGst::Utils::ApplicationSource *src,
+                                   QGst::Utils::SampleRing *ring);
+    static void push(QGst::Utils::ApplicationSource *src, int count);
+    static quint64 offset(const QGst::SamplePtr & sample);
+
+private Q_SLOTS:
+    void capacityTest();
+    void dropNewestTest();
+    void dropOldestTest();
+    void blockTest();
+    void timeoutTest();
+};
+
+//static
+QGst::PipelinePtr SampleRingTest::start(QGst::Utils::ApplicationSource *src,
+                                        QGst::Utils::SampleRing *ring)
+{
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    src->setCaps(QGst::Caps::fromString("application/x-test"));
+    ring->element()->setProperty("sync", false);
+    pipeline->add(src->element(), ring->element());
+    src->element()->link(ring->element());
+    pipeline->setState(QGst::StatePlaying);
+    return pipeline;
+}
+
+//static
+void SampleRingTest::push(QGst::Utils::ApplicationSource *src, int count)
+{
+    for (int i = 0; i < count; i++) {
+        QGst::BufferPtr buffer = QGst::Buffer::create(4);
+        GST_BUFFER_OFFSET(static_cast<GstBuffer*>(buffer)) = i;
+        src->pushBuffer(buffer);
+    }
+    src->endOfStream();
+}
+
+//static
+quint64 SampleRingTest::offset(const QGst::SamplePtr & sample)
+{
+    return GST_BUFFER_OFFSET(static_cast<GstBuffer*>(sample->buffer()));
+}
+
+void SampleRingTest::capacityTest()
+{
+    QGst::Utils::SampleRing ring(5);
+    QCOMPARE(ring.capacity(), 8);
+    QCOMPARE(ring.overflowPolicy(), QGst::Utils::SampleRing::DropOldest);
+    QCOMPARE(ring.occupancy(), 0);
+    QVERIFY(!ring.pop(0));
+}
+
+void SampleRingTest::dropNewestTest()
+{
+    QGst::Utils::ApplicationSource src;
+    QGst::Utils::SampleRing ring(4, QGst::Utils::SampleRing::DropNewest);
+    QGst::PipelinePtr pipeline = start(&src, &ring);
+    push(&src, 10);
+
+    //let the streaming thread overrun the ring before anything is popped
+    QTest::qSleep(500);
+    QList<quint64> offsets;
+    while (QGst::SamplePtr sample = ring.pop(5000)) {
+        offsets << offset(sample);
+    }
+    pipeline->setState(QGst::StateNull);
+
+    QCOMPARE(offsets, QList<quint64>() << 0 << 1 << 2 << 3);
+    QCOMPARE(ring.pushedCount(), 4u);
+    QCOMPARE(ring.droppedCount(), 6u);
+    QCOMPARE(ring.poppedCount(), 4u);
+    QCOMPARE(ring.maximumOccupancy(), 4);
+}
+
+void SampleRingTest::dropOldestTest()
+{
+    QGst::Utils::ApplicationSource src;
+    QGst::Utils::SampleRing ring(4, QGst::Utils::SampleRing::DropOldest);
+    QGst::PipelinePtr pipeline = start(&src, &ring);
+    push(&src, 10);
+
+    QTest::qSleep(500);
+    QList<quint64> offsets;
+    while (QGst::SamplePtr sample = ring.pop(5000)) {
+        offsets << offset(sample);
+    }
+    pipeline->setState(QGst::StateNull);
+
+    QCOMPARE(offsets, QList<quint64>() << 6 << 7 << 8 << 9);
+    QCOMPARE(ring.pushedCount(), 10u);
+    QCOMPARE(ring.droppedCount(), 6u);
+}
+
+void SampleRingTest::blockTest()
+{
+    QGst::Utils::ApplicationSource src;
+    QGst::Utils::SampleRing ring(2, QGst::Utils::SampleRing::Block);
+    QGst::PipelinePtr pipeline = start(&src, &ring);
+    push(&src, 50);
+
+    QList<quint64> offsets;
+    while (QGst::SamplePtr sample = ring.pop(5000)) {
+        offsets << offset(sample);
+    }
+    pipeline->setState(QGst::StateNull);
+
+    QCOMPARE(offsets.size(), 50);
+    for (int i = 0; i < offsets.size(); i++) {
+        QCOMPARE(offsets[i], quint64(i));
+    }
+    QCOMPARE(ring.droppedCount(), 0u);
+    QVERIFY(ring.maximumOccupancy() <= 2);
+}
+
+void SampleRingTest::timeoutTest()
+{
+    QGst::Utils::SampleRing ring;
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!ring.pop(100));
+    QVERIFY(timer.elapsed() >= 90);
+    QVERIFY(ring.consumerWaitTime() >= 90000);
+}
+
+QTEST_APPLESS_MAIN(SampleRingTest)
+
+#include "moc_qgsttest.cpp"
+#include "sampleringtest.moc"
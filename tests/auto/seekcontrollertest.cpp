@@ -0,0 +1,267 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/ElementFactory>
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/SeekController>
+#include <QtCore/QElapsedTimer>
+
+namespace {
+
+class RecordingSeekController : public QGst::Utils::SeekController
+{
+public:
+    QList<QGst::ClockTime> positions;
+    QList<qint64> latencies;
+
+protected:
+    virtual void seekCompleted(QGst::ClockTime position, qint64 latency)
+    {
+        positions.append(position);
+        latencies.append(latency);
+    }
+};
+
+} //anonymous namespace
+
+class SeekControllerTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(const char *description, QGst::State state);
+    /* Runs the default main context, which dispatches the bus messages to the
+     * controller, until it is idle or for at most \a msecs milliseconds */
+    static void waitForIdle(const QGst::Utils::SeekController & controller, int msecs);
+    static bool querySegment(const QGst::PipelinePtr & pipeline, double *rate, gint64 *stop);
+
+private Q_SLOTS:
+    void coalesceTest();
+    void rateTest();
+    void retryTest();
+    void timeoutTest();
+    void scrubbingBenchmark();
+};
+
+//static
+QGst::PipelinePtr SeekControllerTest::createPipeline(const char *description, QGst::State state)
+{
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(description).dynamicCast<QGst::Pipeline>();
+    pipeline->setState(state);
+    pipeline->getState(NULL, NULL, QGst::ClockTime::fromSeconds(10));
+
+    //the ASYNC_DONE of the preroll must not be taken for the end of a seek
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+    return pipeline;
+}
+
+//static
+void SeekControllerTest::waitForIdle(const QGst::Utils::SeekController & controller, int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < msecs) {
+        if (!g_main_context_iteration(NULL, FALSE)) {
+            if (!controller.isSeeking() && !controller.pendingPosition().isValid()) {
+                break;
+            }
+            g_usleep(1000);
+        }
+    }
+}
+
+//static
+bool SeekControllerTest::querySegment(const QGst::PipelinePtr & pipeline, double *rate, gint64 *stop)
+{
+    GstQuery *query = gst_query_new_segment(GST_FORMAT_TIME);
+    bool ok = gst_element_query(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)), query);
+    if (ok) {
+        gst_query_parse_segment(query, rate, NULL, NULL, stop);
+    }
+    gst_query_unref(query);
+    return ok;
+}
+
+void SeekControllerTest::coalesceTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "videotestsrc ! video/x-raw,framerate=25/1 ! fakesink", QGst::StatePaused);
+    RecordingSeekController controller;
+    controller.setElement(pipeline);
+
+    //the first request is sent, the others are merged into one queued request
+    for (int i = 1; i <= 10; i++) {
+        controller.seek(QGst::ClockTime::fromMSecs(i * 200));
+    }
+    QCOMPARE(controller.requestCount(), 10U);
+    QCOMPARE(controller.seekCount(), 1U);
+    QVERIFY(controller.isSeeking());
+    QCOMPARE(controller.pendingPosition(), QGst::ClockTime::fromMSecs(2000));
+
+    //the queued request goes out as a keyframe seek, then is refined accurately
+    waitForIdle(controller, 10000);
+    QVERIFY(!controller.isSeeking());
+    QCOMPARE(controller.seekCount(), 3U);
+    QCOMPARE(controller.positions.size(), 3);
+    QCOMPARE(controller.positions.last(), QGst::ClockTime::fromMSecs(2000));
+
+    gint64 position = -1;
+    QVERIFY(gst_element_query_position(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)),
+                                       GST_FORMAT_TIME, &position));
+    QCOMPARE(position, gint64(2 * GST_SECOND));
+
+    //request-to-frame latency
+    QVERIFY(controller.lastLatency() >= 0);
+    QVERIFY(controller.maximumLatency() >= controller.averageLatency());
+    QCOMPARE(controller.lastLatency(), controller.latencies.last());
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void SeekControllerTest::rateTest()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "videotestsrc ! video/x-raw,framerate=25/1 ! fakesink", QGst::StatePaused);
+    RecordingSeekController controller;
+    controller.setElement(pipeline);
+    controller.setMode(QGst::Utils::SeekController::Accurate);
+
+    controller.seek(QGst::ClockTime::fromSeconds(5));
+    waitForIdle(controller, 10000);
+
+    double rate = 0;
+    gint64 stop = 0;
+
+    //playing backwards stops at the current position
+    controller.setRate(-1.0);
+    waitForIdle(controller, 10000);
+    QCOMPARE(controller.rate(), -1.0);
+    QVERIFY(querySegment(pipeline, &rate, &stop));
+    QCOMPARE(rate, -1.0);
+    QCOMPARE(stop, gint64(5 * GST_SECOND));
+
+    //playing forwards again must not keep that stop position
+    controller.setRate(4.0);
+    waitForIdle(controller, 10000);
+    QVERIFY(querySegment(pipeline, &rate, &stop));
+    QCOMPARE(rate, 4.0);
+    QCOMPARE(stop, gint64(-1));
+    QCOMPARE(controller.seekCount(), 3U);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void SeekControllerTest::retryTest()
+{
+    //the position of an empty pipeline cannot be queried
+    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
+    RecordingSeekController controller;
+    controller.setElement(pipeline);
+
+    controller.setRate(2.0);
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 200) {
+        g_main_context_iteration(NULL, FALSE);
+    }
+    QCOMPARE(controller.seekCount(), 0U);
+
+    QGst::ElementPtr src = QGst::ElementFactory::make("videotestsrc");
+    QGst::ElementPtr sink = QGst::ElementFactory::make("fakesink");
+    pipeline->add(src, sink);
+    src->link(sink);
+    pipeline->setState(QGst::StatePaused);
+    pipeline->getState(NULL, NULL, QGst::ClockTime::fromSeconds(10));
+
+    //the rate change was kept and is retried
+    timer.start();
+    while (controller.seekCount() == 0 && timer.elapsed() < 5000) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    QCOMPARE(controller.seekCount(), 1U);
+    QCOMPARE(controller.requestCount(), 1U);
+    waitForIdle(controller, 10000);
+
+    double rate = 0;
+    gint64 stop = 0;
+    QVERIFY(querySegment(pipeline, &rate, &stop));
+    QCOMPARE(rate, 2.0);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void SeekControllerTest::timeoutTest()
+{
+    //a sink that does not preroll asynchronously, so no ASYNC_DONE follows the seeks
+    QGst::PipelinePtr pipeline = createPipeline(
+            "videotestsrc ! video/x-raw,framerate=25/1 ! fakesink async=false", QGst::StatePaused);
+    RecordingSeekController controller;
+    controller.setElement(pipeline);
+    controller.setSeekTimeout(QGst::ClockTime::fromMSecs(100));
+    QCOMPARE(controller.seekTimeout(), QGst::ClockTime::fromMSecs(100));
+
+    controller.seek(QGst::ClockTime::fromSeconds(1));
+    controller.seek(QGst::ClockTime::fromSeconds(2));
+    QVERIFY(controller.isSeeking());
+
+    //the queued request is not held back forever
+    waitForIdle(controller, 2000);
+    QVERIFY(!controller.isSeeking());
+    QVERIFY(!controller.pendingPosition().isValid());
+    QVERIFY(controller.seekCount() >= 2U);
+
+    pipeline->setState(QGst::StateNull);
+}
+
+void SeekControllerTest::scrubbingBenchmark()
+{
+    QGst::PipelinePtr pipeline = createPipeline(
+            "videotestsrc pattern=ball ! video/x-raw,width=1280,height=720,framerate=25/1 "
+            "! fakesink", QGst::StatePaused);
+    RecordingSeekController controller;
+    controller.setElement(pipeline);
+
+    //a slider dragged over 10 seconds of video, moving every 5ms for one second
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < 200; i++) {
+        controller.seek(QGst::ClockTime::fromMSecs(i * 50));
+        while (timer.elapsed() < (i + 1) * 5) {
+            g_main_context_iteration(NULL, FALSE);
+        }
+    }
+    waitForIdle(controller, 10000);
+    QVERIFY(!controller.isSeeking());
+
+    QCOMPARE(controller.requestCount(), 200U);
+    QVERIFY(controller.seekCount() < controller.requestCount());
+    QCOMPARE(controller.positions.last(), QGst::ClockTime::fromMSecs(199 * 50));
+
+    qDebug() << controller.requestCount() << "requests," << controller.seekCount() << "seeks;"
+             << "request to frame latency: average" << controller.averageLatency()
+             << "ms, maximum" << controller.maximumLatency() << "ms";
+
+    pipeline->setState(QGst::StateNull);
+}
+
+QTEST_APPLESS_MAIN(SeekControllerTest)
+
+#include "moc_qgsttest.cpp"
+#include "seekcontrollertest.moc"
@@ -36,6 +36,11 @@ private Q_SLOTS:
    void emitTypeTest();
    void disconnectTest();
    void autoDisconnectTest();
+   void queuedConnectTest();
+   void coalescedConnectTest();
+   void queuedDisconnectTest();
+   void connectDisconnectBenchmark_data();
+   void connectDisconnectBenchmark();
 };
 
 static bool closureCalled = false;
@@ -199,7 +204,173 @@ void SignalsTest::autoDisconnectTest()
     QVERIFY(!QGlib::disconnect(binPtr));
 }
 
-QTEST_APPLESS_MAIN(SignalsTest)
+class QueuedTestReceiver : public QObject
+{
+public:
+    QueuedTestReceiver() : calls(0), wrongThread(false) {}
+
+    void elementAdded(const QGst::ElementPtr & element)
+    {
+        ++calls;
+        names.append(element->name());
+        if (QThread::currentThread() != thread()) {
+            wrongThread = true;
+        }
+    }
+
+    int calls;
+    bool wrongThread;
+    QStringList names;
+};
+
+class ElementAddThread : public QThread
+{
+public:
+    QGst::BinPtr bin;
+
+private:
+    virtual void run()
+    {
+        for (int i = 0; i < 5; ++i) {
+            bin->add(QGst::Bin::create(QString("e%1").arg(i).toUtf8().constData()));
+        }
+    }
+};
+
+void SignalsTest::queuedConnectTest()
+{
+    QueuedTestReceiver receiver;
+    ElementAddThread thread;
+    thread.bin = QGst::Bin::create();
+    QVERIFY(QGlib::connect(thread.bin, "element-added", &receiver,
+                           &QueuedTestReceiver::elementAdded, QGlib::QueuedConnection));
+
+    thread.start();
+    thread.wait();
+
+    //nothing is delivered until the receiver's event loop runs
+    QCOMPARE(receiver.calls, 0);
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 5);
+    QCOMPARE(receiver.names, QStringList() << "e0" << "e1" << "e2" << "e3" << "e4");
+    QVERIFY(!receiver.wrongThread);
+}
+
+void SignalsTest::coalescedConnectTest()
+{
+    QueuedTestReceiver receiver;
+    QGst::BinPtr bin = QGst::Bin::create();
+    QVERIFY(QGlib::connect(bin, "element-added", &receiver,
+                           &QueuedTestReceiver::elementAdded, QGlib::CoalescedConnection));
+
+    for (int i = 0; i < 5; ++i) {
+        bin->add(QGst::Bin::create(QString("e%1").arg(i).toUtf8().constData()));
+    }
+    QCOMPARE(receiver.calls, 0);
+
+    //only the latest emission is delivered
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 1);
+    QCOMPARE(receiver.names, QStringList() << "e4");
+
+    bin->add(QGst::Bin::create("e5"));
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 2);
+    QCOMPARE(receiver.names.last(), QString("e5"));
+}
+
+void SignalsTest::queuedDisconnectTest()
+{
+    QueuedTestReceiver receiver;
+    QGst::BinPtr bin = QGst::Bin::create();
+    QVERIFY(QGlib::connect(bin, "element-added", &receiver,
+                           &QueuedTestReceiver::elementAdded, QGlib::QueuedConnection));
+
+    bin->add(QGst::Bin::create());
+    QVERIFY(QGlib::disconnect(bin, "element-added", &receiver));
+
+    //the call that was queued before the disconnection is discarded
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 0);
+
+    //a receiver that is destroyed with calls still queued
+    QueuedTestReceiver *receiver2 = new QueuedTestReceiver;
+    QVERIFY(QGlib::connect(bin, "element-added", receiver2,
+                           &QueuedTestReceiver::elementAdded, QGlib::QueuedConnection));
+    bin->add(QGst::Bin::create());
+    delete receiver2;
+    QCoreApplication::processEvents();
+    QVERIFY(!QGlib::disconnect(bin, "element-added"));
+}
+
+/* Connects and disconnects a handler of its own bin and receiver in a loop */
+class ConnectCycleThread : public QThread
+{
+public:
+    ConnectCycleThread(int cycles) : cycles(cycles), failures(0) {}
+
+    int cycles;
+    int failures;
+
+private:
+    virtual void run()
+    {
+        QGst::BinPtr bin = QGst::Bin::create();
+        QueuedTestReceiver receiver;
+        for (int i = 0; i < cycles; ++i) {
+            if (!QGlib::connect(bin, "element-added", &receiver,
+                                &QueuedTestReceiver::elementAdded)
+                || !QGlib::disconnect(bin, "element-added", &receiver,
+                                      &QueuedTestReceiver::elementAdded)) {
+                ++failures;
+            }
+        }
+    }
+};
+
+void SignalsTest::connectDisconnectBenchmark_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("4 threads") << 4;
+}
+
+void SignalsTest::connectDisconnectBenchmark()
+{
+    QFETCH(int, threads);
+    const int totalCycles = 100000;
+
+    //connections that stay alive during the benchmark,
+    //so that the cost of a cycle does not depend on their number
+    QList<QGst::BinPtr> bins;
+    QueuedTestReceiver receiver;
+    for (int i = 0; i < 1000; ++i) {
+        QGst::BinPtr bin = QGst::Bin::create();
+        for (int j = 0; j < 10; ++j) {
+            QGlib::connect(bin, "element-added", &receiver, &QueuedTestReceiver::elementAdded);
+        }
+        bins.append(bin);
+    }
+
+    QBENCHMARK_ONCE {
+        QList<ConnectCycleThread*> cycleThreads;
+        for (int i = 0; i < threads; ++i) {
+            cycleThreads.append(new ConnectCycleThread(totalCycles / threads));
+            cycleThreads.last()->start();
+        }
+        Q_FOREACH(ConnectCycleThread *thread, cycleThreads) {
+            thread->wait();
+            QCOMPARE(thread->failures, 0);
+        }
+        qDeleteAll(cycleThreads);
+    }
+
+    Q_FOREACH(const QGst::BinPtr & bin, bins) {
+        QVERIFY(QGlib::disconnect(bin, "element-added", &receiver));
+    }
+}
+
+QTEST_MAIN(SignalsTest)
 
 #include "moc_qgsttest.cpp"
 #include "signalstest.moc"
@@ -23,6 +23,7 @@
 #include <QGst/Caps>
 #include <QGst/Pad>
 #include <QGst/Event>
+#include <QGst/Message>
 
 class StructureTest : public QGstTest
 {
@@ -31,6 +32,8 @@ private Q_SLOTS:
     void bindingsTest();
     void copyTest();
     void valueTest();
+    void quarkTest();
+    void structureViewTest();
     void sharedStructureTest();
 };
 
@@ -108,6 +111,93 @@ void StructureTest::valueTest()
     }
 }
 
+void StructureTest::quarkTest()
+{
+    QGst::Structure s("mystructure");
+    QGlib::Quark intField = QGlib::Quark::fromStaticString("intfield");
+
+    QVERIFY(s.hasName("mystructure"));
+    QVERIFY(!s.hasName("otherstructure"));
+    QCOMPARE(s.nameQuark(), QGlib::Quark::fromString("mystructure"));
+    QCOMPARE(s.nameQuark().toCString(), "mystructure");
+
+    s.setValue(intField, 20);
+    QVERIFY(s.hasField(intField));
+    QVERIFY(s.hasField("intfield"));
+    QVERIFY(s.hasFieldTyped(intField, QGlib::Type::Int));
+    QVERIFY(!s.hasFieldTyped(intField, QGlib::Type::String));
+    QCOMPARE(s.fieldType(intField), QGlib::Type(QGlib::Type::Int));
+    QCOMPARE(s.fieldNameQuark(0), intField);
+    QCOMPARE(s.value(intField).get<int>(), 20);
+    QCOMPARE(s.value("intfield").get<int>(), 20);
+
+    QVERIFY(!s.hasField(QGlib::Quark::fromString("nonexistent")));
+    QVERIFY(!s.value(QGlib::Quark::fromString("nonexistent")).isValid());
+
+    s.removeField(intField);
+    QVERIFY(!s.hasField(intField));
+    QCOMPARE(s.numberOfFields(), static_cast<unsigned int>(0));
+}
+
+namespace {
+
+struct FieldCounter
+{
+    FieldCounter(int *count, int *sum) : count(count), sum(sum) {}
+
+    bool operator()(QGlib::Quark fieldId, const QGlib::ValueView & value)
+    {
+        Q_UNUSED(fieldId);
+        ++*count;
+        *sum += value.get<int>();
+        return true;
+    }
+
+    int *count;
+    int *sum;
+};
+
+} //anonymous namespace
+
+void StructureTest::structureViewTest()
+{
+    QGst::StructureView invalid;
+    QVERIFY(!invalid.isValid());
+    QCOMPARE(invalid.numberOfFields(), static_cast<unsigned int>(0));
+    QVERIFY(!invalid.value("foo").isValid());
+
+    QGst::Structure s("mystructure");
+    s.setValue("a", 1);
+    s.setValue("b", 2);
+    s.setValue("c", 3);
+
+    QGst::StructureView view(s);
+    QVERIFY(view.isValid());
+    QCOMPARE(view.name(), "mystructure");
+    QVERIFY(view.hasName("mystructure"));
+    QCOMPARE(view.numberOfFields(), static_cast<unsigned int>(3));
+    QCOMPARE(view.fieldName(1), "b");
+    QVERIFY(view.hasField(QGlib::Quark::fromString("c")));
+    QCOMPARE(view.value("b").get<int>(), 2);
+    QCOMPARE(view.value(QGlib::Quark::fromString("c")).get<int>(), 3);
+
+    //the view points to the same GstStructure, no copy is made
+    QCOMPARE(static_cast<const GstStructure*>(view), static_cast<const GstStructure*>(s));
+
+    int count = 0, sum = 0;
+    QVERIFY(view.forEach(FieldCounter(&count, &sum)));
+    QCOMPARE(count, 3);
+    QCOMPARE(sum, 6);
+
+    QGst::Structure copy = view.copy();
+    QCOMPARE(copy.value("a").get<int>(), 1);
+
+    QGst::ElementMessagePtr msg = QGst::ElementMessage::create(QGst::ObjectPtr(), s);
+    QGst::StructureView msgView = msg->structureView();
+    QVERIFY(msgView.hasName("mystructure"));
+    QCOMPARE(msgView.value("c").get<int>(), 3);
+}
+
 void StructureTest::sharedStructureTest()
 {
     QGst::ElementPtr queue = QGst::ElementFactory::make("queue", NULL);
@@ -52,6 +52,11 @@ void TagListTest::simpleTest()
     //try to access bad tag index
     QVERIFY(tl.title(2).isNull());
 
+    //peek at the strings without copying them
+    QCOMPARE(tl.peekString("title"), "abc");
+    QCOMPARE(tl.peekString("title", 1), "bcd");
+    QVERIFY(!tl.peekString("title", 2));
+
     //now use the generic form to set a tag by name
     QString s3("def");
     tl.setTagValue("title", s3, QGst::TagMergeReplaceAll);
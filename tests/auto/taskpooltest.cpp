@@ -0,0 +1,225 @@
+/*
+    Copyright (C) 2014  Collabora Ltd.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "qgsttest.h"
+#include <QGst/Bin>
+#include <QGst/Parse>
+#include <QGst/Pipeline>
+#include <QGst/Utils/TaskPool>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#ifdef Q_OS_LINUX
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+namespace {
+
+/* Records the threads that buffers are pushed from */
+struct ThreadRecorder
+{
+    ThreadRecorder() : wrongAffinity(0) {}
+
+    QMutex mutex;
+    QSet<Qt::HANDLE> threads;
+    int wrongAffinity;
+    QList<int> expectedCpus;
+
+    static GstPadProbeReturn probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+    {
+        Q_UNUSED(pad);
+        Q_UNUSED(info);
+        ThreadRecorder *self = static_cast<ThreadRecorder*>(user_data);
+        QMutexLocker locker(&self->mutex);
+        self->threads.insert(QThread::currentThreadId());
+
+#ifdef Q_OS_LINUX
+        if (!self->expectedCpus.isEmpty()) {
+            cpu_set_t cpus;
+            pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            if (CPU_COUNT(&cpus) != self->expectedCpus.size()) {
+                ++self->wrongAffinity;
+            }
+            Q_FOREACH(int cpu, self->expectedCpus) {
+                if (!CPU_ISSET(cpu, &cpus)) {
+                    ++self->wrongAffinity;
+                }
+            }
+        }
+#endif
+        return GST_PAD_PROBE_OK;
+    }
+
+    void watch(const QGst::PipelinePtr & pipeline, const char *element, const char *padName)
+    {
+        QGst::PadPtr pad = pipeline->getElementByName(element)->getStaticPad(padName);
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &ThreadRecorder::probe, this, NULL);
+    }
+};
+
+} //anonymous namespace
+
+class TaskPoolTest : public QGstTest
+{
+    Q_OBJECT
+private:
+    static QGst::PipelinePtr createPipeline(ThreadRecorder *recorder);
+    static bool waitForEos(const QGst::PipelinePtr & pipeline);
+
+private Q_SLOTS:
+    void boundedThreadsTest();
+    void concurrentPipelinesTest();
+    void saturationTest();
+    void affinityTest();
+};
+
+//static
+QGst::PipelinePtr TaskPoolTest::createPipeline(ThreadRecorder *recorder)
+{
+    //two streaming tasks: the one of fakesrc and the one of the queue
+    QGst::PipelinePtr pipeline = QGst::Parse::launch(
+            "fakesrc name=src num-buffers=20 ! queue ! fakesink name=sink sync=false")
+            .dynamicCast<QGst::Pipeline>();
+    recorder->watch(pipeline, "src", "src");
+    recorder->watch(pipeline, "sink", "sink");
+    return pipeline;
+}
+
+//static
+bool TaskPoolTest::waitForEos(const QGst::PipelinePtr & pipeline)
+{
+    GstBus *bus = gst_element_get_bus(GST_ELEMENT(static_cast<GstPipeline*>(pipeline)));
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, 30 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg) {
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    return ok;
+}
+
+void TaskPoolTest::boundedThreadsTest()
+{
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(2);
+
+    ThreadRecorder recorder;
+    {
+        QGst::Utils::TaskPool pool(&threadPool);
+        QCOMPARE(pool.threadPool(), &threadPool);
+
+        //each pipeline would otherwise get threads of its own
+        for (int i = 0; i < 10; ++i) {
+            QGst::PipelinePtr pipeline = createPipeline(&recorder);
+            pool.install(pipeline);
+            pipeline->setState(QGst::StatePlaying);
+            QVERIFY(waitForEos(pipeline));
+            pipeline->setState(QGst::StateNull);
+        }
+
+        QVERIFY(pool.startedTaskCount() >= 20);
+        QCOMPARE(pool.activeTaskCount(), 0);
+    }
+
+    QVERIFY(recorder.threads.size() <= 2);
+    QVERIFY(threadPool.activeThreadCount() <= 2);
+}
+
+void TaskPoolTest::concurrentPipelinesTest()
+{
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(6);
+
+    ThreadRecorder recorder;
+    QGst::Utils::TaskPool pool(&threadPool);
+
+    for (int round = 0; round < 5; ++round) {
+        QList<QGst::PipelinePtr> pipelines;
+        for (int i = 0; i < 3; ++i) {
+            QGst::PipelinePtr pipeline = createPipeline(&recorder);
+            pool.install(pipeline);
+            pipeline->setState(QGst::StatePlaying);
+            pipelines.append(pipeline);
+        }
+        Q_FOREACH(const QGst::PipelinePtr & pipeline, pipelines) {
+            QVERIFY(waitForEos(pipeline));
+            pipeline->setState(QGst::StateNull);
+            pool.uninstall(pipeline);
+        }
+    }
+
+    QVERIFY(pool.startedTaskCount() >= 30);
+    QVERIFY(recorder.threads.size() <= 6);
+}
+
+void TaskPoolTest::saturationTest()
+{
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1);
+    QGst::Utils::TaskPool pool(&threadPool);
+
+    //the pipeline needs two streaming threads; it must fail instead of stalling
+    ThreadRecorder recorder;
+    QGst::PipelinePtr pipeline = createPipeline(&recorder);
+    pool.install(pipeline);
+    QGst::StateChangeReturn ret = pipeline->setState(QGst::StatePlaying);
+    if (ret != QGst::StateChangeFailure) {
+        ret = pipeline->getState(NULL, NULL, QGst::ClockTime::fromSeconds(10));
+    }
+    QCOMPARE(ret, QGst::StateChangeFailure);
+
+    pipeline->setState(QGst::StateNull);
+    QCOMPARE(pool.activeTaskCount(), 0);
+    QVERIFY(pool.startedTaskCount() <= 1);
+}
+
+void TaskPoolTest::affinityTest()
+{
+#ifdef Q_OS_LINUX
+    cpu_set_t available;
+    QVERIFY(pthread_getaffinity_np(pthread_self(), sizeof(available), &available) == 0);
+    int cpu = 0;
+    while (cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &available)) {
+        ++cpu;
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(2);
+    QGst::Utils::TaskPool pool(&threadPool);
+    pool.setCpuAffinity(QList<int>() << cpu);
+    QCOMPARE(pool.cpuAffinity(), QList<int>() << cpu);
+
+    ThreadRecorder recorder;
+    recorder.expectedCpus = pool.cpuAffinity();
+    QGst::PipelinePtr pipeline = createPipeline(&recorder);
+    pool.install(pipeline);
+    pipeline->setState(QGst::StatePlaying);
+    QVERIFY(waitForEos(pipeline));
+    pipeline->setState(QGst::StateNull);
+
+    QVERIFY(!recorder.threads.isEmpty());
+    QCOMPARE(recorder.wrongAffinity, 0);
+#else
+    QSKIP_PORT("CPU affinity is only supported on Linux", SkipAll);
+#endif
+}
+
+QTEST_APPLESS_MAIN(TaskPoolTest)
+
+#include "moc_qgsttest.cpp"
+#include "taskpooltest.moc"
@@ -43,6 +43,7 @@ private Q_SLOTS:
     void qdebugTest();
     void datetimeTest();
     void errorTest();
+    void valueViewTest();
 };
 
 void ValueTest::intTest()
@@ -275,6 +276,32 @@ void ValueTest::errorTest()
     QCOMPARE(error.code(), 42);
 }
 
+void ValueTest::valueViewTest()
+{
+    QGlib::ValueView invalid;
+    QVERIFY(!invalid.isValid());
+    QCOMPARE(invalid.type(), QGlib::Type(QGlib::Type::Invalid));
+
+    QGlib::Value v(42);
+    QGlib::ValueView view(v);
+    QVERIFY(view.isValid());
+    QCOMPARE(view.type(), QGlib::Type(QGlib::Type::Int));
+    QCOMPARE(view.get<int>(), 42);
+    QCOMPARE(view.get<qint64>(), Q_INT64_C(42)); //through conversion
+    QCOMPARE(view.get<QString>(), QString("42"));
+    QCOMPARE(view.toValue().toInt(), 42);
+
+    bool ok;
+    QVERIFY(!view.get<const char*>(&ok));
+    QVERIFY(!ok);
+
+    QGlib::Value s("hello");
+    QGlib::ValueView sview(s);
+    QCOMPARE(sview.get<const char*>(&ok), "hello");
+    QVERIFY(ok);
+    QCOMPARE(static_cast<const GValue*>(sview), static_cast<const GValue*>(s));
+}
+
 QTEST_APPLESS_MAIN(ValueTest)
 
 #include "moc_qgsttest.cpp"